@@ -0,0 +1,265 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the rounds analytics.
+ *              A drawdown spans chunks, so every chunk is summed up on its own (its net win, the highest and lowest
+ *              points of its running net, and the largest drop inside it). The summaries of a file are then chained
+ *              in rounds order: a drop across chunks is an earlier peak less a later chunk's lowest point.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<pthread.h>
+#include<unistd.h>//sysconf()
+#include "Analytics.h"
+#include "History.h"
+
+#define MAX_THREADS 1024
+
+//How a chunk is read under the filter (by its min and max)
+enum chunk_match { CHUNK_SKIP, CHUNK_ALL, CHUNK_TEST_ROWS };
+
+//A chunk's running net win, starting from 0
+typedef struct Net_summary {
+	int64_t _sum;
+	int64_t _peak;
+	int64_t _trough;
+	int64_t _drawdown;
+}Net_summary_t;
+
+//A chunk of one of the files
+typedef struct Scan_chunk {
+	const Columns_reader_t* _reader;
+	size_t _index;
+}Scan_chunk_t;
+
+//A scanning thread: a range of the chunks and its own counters
+typedef struct Scan_worker {
+	pthread_t _thread;
+	const Scan_chunk_t* _chunks;
+	Net_summary_t* _summaries;
+	size_t _first;
+	size_t _last;
+	const Analytics_filter_t* _filter;
+	Analytics_t _result;
+}Scan_worker_t;
+
+
+static void* scan_worker_run(void* arg);
+static enum chunk_match chunk_match(const Column_chunk_t* chunk, const Analytics_filter_t* filter);
+static inline void scan_rows(Analytics_t* result, const Column_chunk_t* chunk, const Analytics_filter_t* filter, bool test, Net_summary_t* summary);
+static void analytics_merge(Analytics_t* to, const Analytics_t* from);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+int analytics_scan(const char* const* paths, size_t files, unsigned int threads, const Analytics_filter_t* filter, Analytics_t* result) {
+	assert_condition(paths && result, "Error: function[analytics_scan()]: Null paths or result pointer provided");
+
+	static const Analytics_filter_t no_filter = { 0 };
+	Columns_reader_t* readers = (Columns_reader_t*)calloc(files ? files : 1, sizeof(Columns_reader_t));
+	Scan_chunk_t* chunks = NULL;
+	Net_summary_t* summaries = NULL;
+	Scan_worker_t* workers = NULL;
+	size_t count = 0, next = 0;
+
+	assert_condition(readers, "Error: function[analytics_scan()]: Failed allocating memory for the readers");
+	memset(result, 0, sizeof(Analytics_t));
+	for (size_t f = 0; f < files; ++f) {
+		if (columns_open(&readers[f], paths[f]) != SUCCESS) {
+			for (size_t i = 0; i < f; ++i)
+				columns_close(&readers[i]);
+			free(readers);
+			return FAIL;
+		}
+		count += readers[f]._chunks;
+	}
+
+	chunks = (Scan_chunk_t*)malloc((count ? count : 1) * sizeof(Scan_chunk_t));
+	summaries = (Net_summary_t*)calloc(count ? count : 1, sizeof(Net_summary_t));
+	assert_condition(chunks && summaries, "Error: function[analytics_scan()]: Failed allocating memory for the chunks");
+	for (size_t f = 0; f < files; ++f) {
+		for (size_t i = 0; i < readers[f]._chunks; ++i, ++next) {
+			chunks[next]._reader = &readers[f];
+			chunks[next]._index = i;
+		}
+	}
+
+	if (!threads) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned int)cores : 1;
+	}
+	threads = threads > MAX_THREADS ? MAX_THREADS : threads;
+	threads = threads > count ? (unsigned int)(count ? count : 1) : threads;
+	workers = (Scan_worker_t*)calloc(threads, sizeof(Scan_worker_t));
+	assert_condition(workers, "Error: function[analytics_scan()]: Failed allocating memory for workers");
+
+	//chunks split evenly, the remainder goes to the first workers
+	next = 0;
+	for (unsigned int i = 0; i < threads; ++i) {
+		workers[i]._chunks = chunks;
+		workers[i]._summaries = summaries;
+		workers[i]._filter = filter ? filter : &no_filter;
+		workers[i]._first = next;
+		next += count / threads + (i < count % threads ? 1 : 0);
+		workers[i]._last = next;
+	}
+	for (unsigned int i = 1; i < threads; ++i) {
+		if (pthread_create(&workers[i]._thread, NULL, scan_worker_run, &workers[i]) != 0) {
+			fprintf(stderr, "Warning: function[analytics_scan()]: Failed creating worker %u. Running it inline\n", i);
+			scan_worker_run(&workers[i]);
+			workers[i]._thread = 0;
+		}
+	}
+	scan_worker_run(&workers[0]); //the calling thread is worker 0
+	for (unsigned int i = 0; i < threads; ++i) {
+		if (i && workers[i]._thread) {
+			pthread_join(workers[i]._thread, NULL);
+		}
+		analytics_merge(result, &workers[i]._result);
+	}
+
+	//the drawdowns: every file's chunks summaries chained in order
+	next = 0;
+	for (size_t f = 0; f < files; ++f) {
+		int64_t net = 0, peak = 0;
+		for (size_t i = 0; i < readers[f]._chunks; ++i, ++next) {
+			const Net_summary_t* summary = &summaries[next];
+			int64_t drop = peak - (net + summary->_trough);
+			result->_max_drawdown = drop > result->_max_drawdown ? drop : result->_max_drawdown;
+			result->_max_drawdown = summary->_drawdown > result->_max_drawdown ? summary->_drawdown : result->_max_drawdown;
+			peak = net + summary->_peak > peak ? net + summary->_peak : peak;
+			net += summary->_sum;
+		}
+	}
+	result->_chunks = count;
+
+	for (size_t f = 0; f < files; ++f) {
+		columns_close(&readers[f]);
+	}
+	free(workers);
+	free(summaries);
+	free(chunks);
+	free(readers);
+	return SUCCESS;
+}
+
+double analytics_rate(const Analytics_t* result, uint8_t total, uint8_t up_card, enum round_outcome outcome) {
+	assert_condition(result, "Error: function[analytics_rate()]: Null result pointer provided");
+
+	uint64_t rounds = 0, hits = 0;
+
+	if (total >= ANALYTICS_TOTALS || up_card >= ANALYTICS_UP_CARDS || outcome >= ANALYTICS_OUTCOMES)
+		return 0.0;
+	for (uint8_t up = up_card ? up_card : 0; up < (up_card ? up_card + 1 : ANALYTICS_UP_CARDS); ++up) {
+		for (int o = 0; o < ANALYTICS_OUTCOMES; ++o) {
+			rounds += result->_outcomes[total][up][o];
+		}
+		hits += result->_outcomes[total][up][outcome];
+	}
+	return rounds ? (double)hits / rounds : 0.0;
+}
+
+static void* scan_worker_run(void* arg) {
+	Scan_worker_t* worker = (Scan_worker_t*)arg;
+	Column_chunk_t chunk;
+
+	for (size_t i = worker->_first; i < worker->_last; ++i) {
+		columns_chunk(worker->_chunks[i]._reader, worker->_chunks[i]._index, &chunk);
+		switch (chunk_match(&chunk, worker->_filter)) {
+		case CHUNK_SKIP:
+			worker->_result._chunks_skipped++;
+			break;
+		case CHUNK_ALL:
+			scan_rows(&worker->_result, &chunk, worker->_filter, false, &worker->_summaries[i]);
+			break;
+		default:
+			scan_rows(&worker->_result, &chunk, worker->_filter, true, &worker->_summaries[i]);
+		}
+	}
+	return NULL;
+}
+
+static enum chunk_match chunk_match(const Column_chunk_t* chunk, const Analytics_filter_t* filter) {
+	const int64_t stake_min = filter->_stake_min;
+	const int64_t stake_max = filter->_stake_max ? filter->_stake_max : UINT32_MAX;
+	const int64_t up_card = filter->_up_card;
+
+	if (chunk->_max[COLUMN_STAKE] < stake_min || chunk->_min[COLUMN_STAKE] > stake_max ||
+		(up_card && (chunk->_max[COLUMN_DEALER_UP] < up_card || chunk->_min[COLUMN_DEALER_UP] > up_card)))
+		return CHUNK_SKIP;
+	if (chunk->_min[COLUMN_STAKE] >= stake_min && chunk->_max[COLUMN_STAKE] <= stake_max &&
+		(!up_card || (chunk->_min[COLUMN_DEALER_UP] == up_card && chunk->_max[COLUMN_DEALER_UP] == up_card)))
+		return CHUNK_ALL;
+	return CHUNK_TEST_ROWS;
+}
+
+//Counts the chunk's rounds ('test': rows are tested against the filter). Inlined with 'test' a constant.
+static inline void scan_rows(Analytics_t* result, const Column_chunk_t* chunk, const Analytics_filter_t* filter, bool test, Net_summary_t* summary) {
+	const uint8_t* player = (const uint8_t*)chunk->_data[COLUMN_PLAYER_TOTAL];
+	const uint8_t* up_card = (const uint8_t*)chunk->_data[COLUMN_DEALER_UP];
+	const uint8_t* dealer = (const uint8_t*)chunk->_data[COLUMN_DEALER_TOTAL];
+	const uint8_t* flags = (const uint8_t*)chunk->_data[COLUMN_FLAGS];
+	const uint32_t* stake = (const uint32_t*)chunk->_data[COLUMN_STAKE];
+	const int32_t* net = (const int32_t*)chunk->_data[COLUMN_NET];
+	const uint32_t stake_min = filter->_stake_min;
+	const uint32_t stake_max = filter->_stake_max ? filter->_stake_max : UINT32_MAX;
+	uint64_t rounds = 0, black_jacks = 0, player_busts = 0, dealer_busts = 0, wagered = 0;
+	int64_t run = 0, peak = 0, trough = 0, drawdown = 0;
+
+	for (uint32_t row = 0; row < chunk->_rows; ++row) {
+		if (test && (stake[row] < stake_min || stake[row] > stake_max || (filter->_up_card && up_card[row] != filter->_up_card)))
+			continue;
+		const uint8_t round_flags = flags[row];
+		result->_outcomes[player[row] & (ANALYTICS_TOTALS - 1)][up_card[row] < ANALYTICS_UP_CARDS ? up_card[row] : 0]
+			[round_flags & HISTORY_OUTCOME_MASK]++;
+		result->_dealer_totals[dealer[row] & (ANALYTICS_TOTALS - 1)]++;
+		black_jacks += (round_flags & HISTORY_BLACK_JACK) != 0;
+		player_busts += (round_flags & HISTORY_PLAYER_BUST) != 0;
+		dealer_busts += (round_flags & HISTORY_DEALER_BUST) != 0;
+		wagered += stake[row];
+		run += net[row];
+		peak = run > peak ? run : peak;
+		trough = run < trough ? run : trough;
+		drawdown = peak - run > drawdown ? peak - run : drawdown;
+		++rounds;
+	}
+
+	result->_rounds += rounds;
+	result->_black_jacks += black_jacks;
+	result->_player_busts += player_busts;
+	result->_dealer_busts += dealer_busts;
+	result->_wagered += wagered;
+	result->_net += run;
+	summary->_sum = run;
+	summary->_peak = peak;
+	summary->_trough = trough;
+	summary->_drawdown = drawdown;
+}
+
+//Adds 'from' counters to 'to' (drawdowns are merged by analytics_scan())
+static void analytics_merge(Analytics_t* to, const Analytics_t* from) {
+	const uint64_t* in = &from->_outcomes[0][0][0];
+	uint64_t* out = &to->_outcomes[0][0][0];
+
+	for (size_t i = 0; i < ANALYTICS_TOTALS * ANALYTICS_UP_CARDS * ANALYTICS_OUTCOMES; ++i) {
+		out[i] += in[i];
+	}
+	for (int t = 0; t < ANALYTICS_TOTALS; ++t) {
+		to->_dealer_totals[t] += from->_dealer_totals[t];
+	}
+	to->_rounds += from->_rounds;
+	to->_black_jacks += from->_black_jacks;
+	to->_player_busts += from->_player_busts;
+	to->_dealer_busts += from->_dealer_busts;
+	to->_wagered += from->_wagered;
+	to->_net += from->_net;
+	to->_chunks_skipped += from->_chunks_skipped;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
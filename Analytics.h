@@ -0,0 +1,46 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the rounds analytics: aggregates over columns exports (see Columns.h), scanned in parallel.
+ *              The chunks of all the files are split between threads. Every chunk is scanned once into the thread's
+ *              own counters, and into a summary of its net wins from which the drawdowns are merged in rounds order.
+ *              A filter's chunks are picked by their min and max: chunks out of range are skipped unread, chunks
+ *              wholly in range are scanned without testing their rows.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include "Columns.h"
+
+#define ANALYTICS_TOTALS 32      //hand values 0-31
+#define ANALYTICS_UP_CARDS 11    //up card values 1-10 (0: unknown)
+#define ANALYTICS_OUTCOMES 4     //enum round_outcome
+
+//Rounds to count (0: no limit)
+typedef struct Analytics_filter {
+	uint32_t _stake_min;
+	uint32_t _stake_max;
+	uint8_t _up_card;        //a single dealer up card value (1-10)
+}Analytics_filter_t;
+
+typedef struct Analytics {
+	uint64_t _rounds;
+	uint64_t _outcomes[ANALYTICS_TOTALS][ANALYTICS_UP_CARDS][ANALYTICS_OUTCOMES]; //by player total and dealer up card
+	uint64_t _dealer_totals[ANALYTICS_TOTALS];
+	uint64_t _black_jacks;
+	uint64_t _player_busts;
+	uint64_t _dealer_busts;
+	uint64_t _wagered;
+	int64_t _net;            //player's net win (negative: house wins)
+	int64_t _max_drawdown;   //largest drop of a file's running net win from its peak
+	uint64_t _chunks;        //chunks of all the files
+	uint64_t _chunks_skipped;//ruled out by the filter without reading them
+}Analytics_t;
+
+//Scans the export files 'paths' with 'threads' threads (0: all the online cores). 'filter' is optional.
+//Results are written to 'result' (zeroed first). Every file is a bankroll of its own for the drawdown.
+//Returns: FAIL for a missing or invalid file, otherwise SUCCESS.
+int analytics_scan(const char* const* paths, size_t files, unsigned int threads, const Analytics_filter_t* filter, Analytics_t* result);
+
+//Rate of an outcome for a player total and up card (0: any up card), out of the rounds counted there
+double analytics_rate(const Analytics_t* result, uint8_t total, uint8_t up_card, enum round_outcome outcome);
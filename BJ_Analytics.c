@@ -0,0 +1,94 @@
+/*
+ * Author: Noga Avraham
+ * Description: Aggregates simulation results from columns exports (see BJ_Simulator.c): win, loss and push rates by
+ *              player total and dealer up card, black jack and bust frequencies, net win and the largest drawdown.
+ *              Build: gcc -O2 -pthread BJ_Analytics.c Analytics.c Columns.c Cards.c
+ *              Usage: BJ_Analytics [threads (0: all cores)] [min stake (0: any)] [max stake (0: any)]
+ *                                  [dealer up card 1-10 (0: any)] [columns files (e.g. the simulator's "<file>.<i>")...]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<inttypes.h>
+#include<time.h>
+#include "Analytics.h"
+
+#define FIRST_FILE_ARG 5
+#define MIN_TOTAL 4          //lowest total of two cards
+#define MAX_TOTAL 30         //highest total after a hit on 20
+
+
+static void print_rates(const Analytics_t* result, const char* title, enum round_outcome outcome);
+
+
+int main(int argc, char* argv[]) {
+
+	Analytics_t result;
+	Analytics_filter_t filter = { 0 };
+	struct timespec start, end;
+	unsigned int threads = argc > 1 ? (unsigned int)strtoul(argv[1], NULL, 10) : 0;
+
+	if (argc <= FIRST_FILE_ARG) {
+		fprintf(stderr, "Usage: %s [threads] [min stake] [max stake] [dealer up card] [columns files...]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	filter._stake_min = (uint32_t)strtoul(argv[2], NULL, 10);
+	filter._stake_max = (uint32_t)strtoul(argv[3], NULL, 10);
+	filter._up_card = (uint8_t)strtoul(argv[4], NULL, 10);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (analytics_scan((const char* const*)argv + FIRST_FILE_ARG, argc - FIRST_FILE_ARG, threads, &filter, &result) != SUCCESS) {
+		fprintf(stderr, "Scan failed\n");
+		return EXIT_FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	double rounds = result._rounds ? (double)result._rounds : 1.0;
+
+	printf("rounds:        %" PRIu64 "\n", result._rounds);
+	printf("chunks:        %" PRIu64 " (%" PRIu64 " skipped by the filter)\n", result._chunks, result._chunks_skipped);
+	printf("black jacks:   %.4f%%\n", 100.0 * result._black_jacks / rounds);
+	printf("player busts:  %.4f%%\n", 100.0 * result._player_busts / rounds);
+	printf("dealer busts:  %.4f%%\n", 100.0 * result._dealer_busts / rounds);
+	printf("net:           %" PRId64 "\n", result._net);
+	printf("player edge:   %.6f\n", result._wagered ? (double)result._net / result._wagered : 0.0);
+	printf("max drawdown:  %" PRId64 "\n", result._max_drawdown);
+	printf("rounds/sec:    %.0f\n", seconds > 0 ? result._rounds / seconds : 0.0);
+
+	print_rates(&result, "player wins", OUTCOME_PLAYER_WIN);
+	print_rates(&result, "dealer wins", OUTCOME_DEALER_WIN);
+	print_rates(&result, "pushes", OUTCOME_TIE);
+
+	printf("\ndealer totals:");
+	for (int t = 0; t < ANALYTICS_TOTALS; ++t) {
+		if (result._dealer_totals[t])
+			printf(" %d: %.2f%%", t, 100.0 * result._dealer_totals[t] / rounds);
+	}
+	printf("\n");
+	return 0;
+}
+
+//A table of an outcome's rate (%) by the player's final total (rows) and the dealer's up card (columns)
+static void print_rates(const Analytics_t* result, const char* title, enum round_outcome outcome) {
+	printf("\n%s (%%) by player total / dealer up card\n total", title);
+	for (int up = 1; up < ANALYTICS_UP_CARDS; ++up) {
+		printf(up == 1 ? "      A" : "  %5d", up);
+	}
+	printf("    all\n");
+
+	for (int total = MIN_TOTAL; total <= MAX_TOTAL; ++total) {
+		uint64_t rounds = 0;
+		for (int up = 0; up < ANALYTICS_UP_CARDS; ++up) {
+			for (int o = 0; o < ANALYTICS_OUTCOMES; ++o)
+				rounds += result->_outcomes[total][up][o];
+		}
+		if (!rounds)
+			continue; //a total never reached (e.g. the strategy hits it)
+		printf(" %5d", total);
+		for (int up = 1; up < ANALYTICS_UP_CARDS; ++up) {
+			printf("  %5.1f", 100.0 * analytics_rate(result, (uint8_t)total, (uint8_t)up, outcome));
+		}
+		printf("  %5.1f\n", 100.0 * analytics_rate(result, (uint8_t)total, 0, outcome));
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * Author: Noga Avraham
+ * Description: Prices the table's bankroll risks (see Bankroll.h): measures a round's outcomes distribution (the
+ *              table game, or a rule variant of Rules.h), then evolves many flat betting bankrolls under it and prints
+ *              the risk of ruin, the chance of breaking the house budget, and the final cash, drawdown and ruin
+ *              round quantiles.
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_Bankroll.c Bankroll.c Sketch.c Rules.c Black_Jack.c Render.c History.c Columns.c Snapshot.c Exact_ev.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *              Usage: BJ_Bankroll [paths] [rounds per path] [bankroll] [bet] [house budget (0: no limit)]
+ *                                 [threads (0: all cores)] [seed] [variant (default: the table game)] [scalar]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<inttypes.h>
+#include "Bankroll.h"
+
+#define DEFAULT_PATHS 1000000
+#define DEFAULT_ROUNDS 1000
+#define DEFAULT_BANKROLL 1000        //the table game's starting cash (MIN_CASH)
+#define DEFAULT_BET 10               //the table game's minimum bet
+#define DEFAULT_HOUSE 1000000        //the table game's house budget (MIN_CASH * HOUSE_CASH_LIMIT)
+#define DEFAULT_SEED 2021
+#define MEASURE_ROUNDS 2000000
+#define MEASURE_DECKS 6
+
+
+static void print_quantiles(const char* name, const Sketch_t* sketch, double scale);
+
+
+int main(int argc, char* argv[]) {
+
+	Bankroll_config_t config = {
+		._paths = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_PATHS,
+		._rounds = (uint32_t)(argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_ROUNDS),
+		._bankroll = argc > 3 ? strtod(argv[3], NULL) : DEFAULT_BANKROLL,
+		._bet = argc > 4 ? strtod(argv[4], NULL) : DEFAULT_BET,
+		._house = argc > 5 ? strtod(argv[5], NULL) : DEFAULT_HOUSE,
+		._threads = argc > 6 ? (unsigned int)strtoul(argv[6], NULL, 10) : 0,
+		._seed = argc > 7 ? strtoull(argv[7], NULL, 10) : DEFAULT_SEED,
+		._scalar = argc > 9 && !strcmp(argv[9], "scalar"),
+	};
+	const Rules_t* rules = NULL;
+	Bankroll_outcomes_t outcomes;
+	Bankroll_result_t* result = (Bankroll_result_t*)malloc(sizeof(Bankroll_result_t));
+
+	if (!result) {
+		fprintf(stderr, "Failed allocating memory for the results\n");
+		return EXIT_FAILURE;
+	}
+	if (argc > 8 && strcmp(argv[8], "game") && !(rules = rules_find(argv[8]))) {
+		fprintf(stderr, "Unknown variant '%s'. Variants: game", argv[8]);
+		for (int v = 0; v < RULES_VARIANTS; ++v) {
+			fprintf(stderr, " %s", rules_variants[v]._name);
+		}
+		fprintf(stderr, "\n");
+		free(result);
+		return EXIT_FAILURE;
+	}
+
+	memset(&outcomes, 0, sizeof(outcomes));
+	if ((rules ? bankroll_rules_outcomes(&outcomes, rules, MEASURE_ROUNDS, config._seed, MEASURE_DECKS)
+	           : bankroll_game_outcomes(&outcomes, MEASURE_ROUNDS, config._seed, NULL, NULL)) != SUCCESS) {
+		free(result);
+		return EXIT_FAILURE;
+	}
+	printf("%s outcomes (%d measured rounds), edge %+.3f%%:\n", rules ? rules->_name : "table game", MEASURE_ROUNDS,
+		100.0 * bankroll_outcomes_mean(&outcomes));
+	for (uint32_t k = 0; k < outcomes._count; ++k) {
+		printf("  %+6.2f bets %8.4f%%\n", outcomes._net[k], 100.0 * outcomes._rounds[k] / outcomes._total);
+	}
+
+	if (bankroll_run(&config, &outcomes, result) != SUCCESS) {
+		free(result);
+		return EXIT_FAILURE;
+	}
+	double paths = result->_paths ? (double)result->_paths : 1.0;
+	printf("\n%" PRIu64 " paths of %u rounds, bankroll %.2f, bet %.2f, house budget %.2f, %s kernel\n", result->_paths,
+		config._rounds, config._bankroll, config._bet, config._house, config._scalar ? "scalar" : bankroll_kernel());
+	printf("risk of ruin    %8.4f%%\n", 100.0 * result->_ruined / paths);
+	printf("house broken    %8.4f%%\n", 100.0 * result->_house_broken / paths);
+	printf("mean final cash %10.2f\n\n", result->_mean_cash);
+	printf("%-12s %12s %12s %12s %12s\n", "quantile", "p10", "p50", "p90", "p99");
+	print_quantiles("final cash", &result->_final_cash, BANKROLL_SCALE);
+	print_quantiles("drawdown", &result->_drawdown, BANKROLL_SCALE);
+	print_quantiles("ruin round", &result->_ruin_round, 1);
+	printf("\n%.3f sec, %.0f path rounds/sec (at most)\n", result->_seconds,
+		result->_seconds > 0 ? (double)result->_paths * config._rounds / result->_seconds : 0.0);
+
+	free(result);
+	return 0;
+}
+
+//A sketch's line. 'scale': sketch units per printed unit.
+static void print_quantiles(const char* name, const Sketch_t* sketch, double scale) {
+	printf("%-12s %12.2f %12.2f %12.2f %12.2f\n", name, sketch_quantile(sketch, 0.10) / scale,
+		sketch_quantile(sketch, 0.50) / scale, sketch_quantile(sketch, 0.90) / scale, sketch_quantile(sketch, 0.99) / scale);
+}
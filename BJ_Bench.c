@@ -0,0 +1,593 @@
+/*
+ * Author: Noga Avraham
+ * Description: Benchmarks of the SLL primitives (by list size) and of the game hot paths: shoe building, card
+ *              drawing, hand valuation (one by one and batched, per SIMD kernel), full headless rounds, interleaved interactive games and table snapshots. Reports ns/op, heap allocations/op and ops/sec,
+ *              to catch regressions and to compare lists implementations (build it with each and diff the output).
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_Bench.c Hand_batch.c Black_Jack.c Render.c History.c Columns.c Snapshot.c Exact_ev.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *                     (doubly linked lists: -DLIST_DOUBLY_LINKED and DLL.c instead of SLL.c)
+ *              Usage: BJ_Bench [benchmarks name prefix (default: all)] [seconds per measurement (default: 0.2)]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<inttypes.h>
+#include<time.h>
+#include "Black_Jack.h"
+#include "Cards.h"
+#include "Hand_batch.h"
+#include "SLL.h"
+#include "Snapshot.h"
+
+#define DEFAULT_MIN_SECONDS 0.2
+#define MAX_ITERATIONS (1ULL << 36)
+#define BENCH_SEED 2021
+#define BENCH_BANKROLL 1000000
+#define BENCH_BET 10
+#define BENCH_HIT_BELOW 17
+#define DRAW_HAND_CARDS 8     //random_draw: cards drawn into a hand before it is returned
+#define BATCH_HANDS 4096      //hand_batch: hands of an evaluate_hands() call
+#define GAMES_DEPOSIT "100000"
+
+
+//One measurement: the benchmark runs _iterations operations between bench_start() and bench_stop()
+typedef struct Bench_run {
+	uint64_t _iterations;
+	struct timespec _start;
+	uint64_t _allocs_start;
+	double _seconds;
+	uint64_t _allocs;
+}Bench_run_t;
+
+typedef void (*bench_function)(Bench_run_t* run, size_t size);
+
+typedef struct Bench {
+	const char* _name;
+	const char* _size_unit;
+	bench_function _run;
+	const size_t* _sizes;   //0 terminated
+}Bench_t;
+
+
+//Heap allocations counter: the C library allocation functions are interposed (glibc) and every call is counted
+#ifdef __cplusplus
+extern "C" {
+#endif
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+#ifdef __cplusplus
+}
+#endif
+
+static __thread uint64_t heap_allocs = 0;
+static volatile uintptr_t bench_sink; //results are stored here so the measured calls are not optimized out
+
+void* malloc(size_t size) {
+	heap_allocs++;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+	heap_allocs++;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+	heap_allocs++;
+	return __libc_realloc(ptr, size);
+}
+
+
+static void bench_start(Bench_run_t* run) {
+	run->_allocs_start = heap_allocs;
+	clock_gettime(CLOCK_MONOTONIC, &run->_start);
+}
+
+static void bench_stop(Bench_run_t* run) {
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	run->_seconds = (end.tv_sec - run->_start.tv_sec) + (end.tv_nsec - run->_start.tv_nsec) / 1e9;
+	run->_allocs = heap_allocs - run->_allocs_start;
+}
+
+//A list of 'size' heap nodes
+static List* bench_list(size_t size) {
+	List* list = create_list();
+
+	for (size_t i = 0; i < size; ++i) {
+		add_to_back(list, create_node((void*)&card_codes[i % CARDS_COUNT]));
+	}
+	return list;
+}
+
+static void bench_list_clear(List* list) {
+	clear_list(list);
+	free(list);
+}
+
+//O(1) undo of a measured insert() / remove_at(): links 'n' after 'prev' / unlinks the node after 'prev'.
+//Neither is the list head or tail.
+static void bench_link_after(List* list, Node_t* prev, Node_t* n) {
+	n->_next = prev->_next;
+	prev->_next = n;
+#ifdef LIST_DOUBLY_LINKED
+	n->_prev = prev;
+	n->_next->_prev = n;
+#endif
+	list->_count++;
+}
+
+static Node_t* bench_unlink_after(List* list, Node_t* prev) {
+	Node_t* n = prev->_next;
+
+	prev->_next = n->_next;
+#ifdef LIST_DOUBLY_LINKED
+	n->_next->_prev = prev;
+#endif
+	list->_count--;
+	return n;
+}
+
+static void bench_card_sum(void* data, void* result) {
+	*(uint32_t*)result += card_value[*(uint8_t*)data];
+}
+
+static void bench_card_sink(void* data) {
+	bench_sink += *(uint8_t*)data;
+}
+
+//SLL benchmarks. Positional operations work on the middle of the list.
+static void bench_find(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+	uintptr_t found = 0;
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		found += (uintptr_t)find(list, size / 2);
+	}
+	bench_stop(run);
+	bench_sink = found;
+	bench_list_clear(list);
+}
+
+static void bench_remove_at(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+	Node_t* prev = find(list, size / 2 - 1);
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		bench_link_after(list, prev, remove_at(list, size / 2));
+	}
+	bench_stop(run);
+	bench_list_clear(list);
+}
+
+static void bench_insert(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+	Node_t* prev = find(list, size / 2 - 1);
+	Node_t* n = create_node((void*)&card_codes[0]);
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		insert(list, n, size / 2);
+		bench_unlink_after(list, prev);
+	}
+	bench_stop(run);
+	free(n);
+	bench_list_clear(list);
+}
+
+static void bench_remove_from_back(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		add_to_back(list, remove_from_back(list));
+	}
+	bench_stop(run);
+	bench_list_clear(list);
+}
+
+static void bench_for_each(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+	uint32_t sum = 0;
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		for_each(list, &sum, bench_card_sum);
+	}
+	bench_stop(run);
+	bench_sink = sum;
+	bench_list_clear(list);
+}
+
+//the middle half of the list, to a sink instead of the terminal
+static void bench_print_list_by_range(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		print_list_by_range(list, size / 4 + 1, size - size / 4, bench_card_sink);
+	}
+	bench_stop(run);
+	bench_list_clear(list);
+}
+
+//the back half of the list moved out and back again (the walk to the middle, then an O(1) concat())
+static void bench_extract_range(Bench_run_t* run, size_t size) {
+	List* list = bench_list(size);
+	List half = { 0 };
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		extract_range(list, size / 2 + 1, size, &half);
+		concat(list, &half);
+	}
+	bench_stop(run);
+	bench_list_clear(list);
+}
+
+//'size' nodes of a pool added from an array, and all returned at once (list_free_nodes())
+static void bench_add_array_to_back(Bench_run_t* run, size_t size) {
+	Node_pool_t* nodes = create_node_pool(size);
+	List* list = create_pooled_list(nodes);
+	void** data = (void**)malloc(size * sizeof(void*));
+
+	for (size_t i = 0; i < size; ++i) {
+		data[i] = (void*)&card_codes[i % CARDS_COUNT];
+	}
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		add_array_to_back(list, data, size);
+		list_free_nodes(list);
+	}
+	bench_stop(run);
+	free(data);
+	free(list);
+	clear_node_pool(nodes);
+}
+
+//Game benchmarks. 'size' is the shoe decks, or the hand cards.
+//build_deck: a new shuffled shoe (table_set_shoe())
+static void bench_build_deck(Bench_run_t* run, size_t size) {
+	Table_t table;
+
+	table_init_seeded(&table, true, BENCH_SEED);
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		table_set_shoe(&table, (uint8_t)size, 0.75);
+	}
+	bench_stop(run);
+	table_clear(&table);
+}
+
+//random_draw: a card drawn out of the shoe into a hand (as the game's random_draw()), the hand returned
+//every DRAW_HAND_CARDS cards and the shoe reshuffled once the cut card is out
+static void bench_random_draw(Bench_run_t* run, size_t size) {
+	Table_t table;
+	uint8_t drawn = 0;
+
+	table_init_seeded(&table, true, BENCH_SEED);
+	table_set_shoe(&table, (uint8_t)size, 0.75);
+	Player_t* player = &table._player;
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		shoe_draw(table._deck, &drawn);
+		card_list_add_to_back(&player->_cards, drawn);
+		hand_add_card(&player->_hand, drawn);
+
+		if (player->_cards._count == DRAW_HAND_CARDS) {
+			card_list_reset(&player->_cards);
+			hand_reset(&player->_hand);
+			shoe_discard(table._deck, DRAW_HAND_CARDS);
+			if (shoe_cut_card_out(table._deck))
+				shoe_reshuffle(table._deck);
+		}
+	}
+	bench_stop(run);
+	card_list_reset(&player->_cards);
+	shoe_discard(table._deck, table._deck->_in_play);
+	table_clear(&table);
+}
+
+static void bench_calculate_hand_val(Bench_run_t* run, size_t size) {
+	Card_list_t hand = { 0 };
+	uint32_t value = 0;
+
+	for (size_t i = 0; i < size; ++i) { //Ace, 2, 3, ... : soft hands while they can be
+		card_list_add_to_back(&hand, card_codes[(i % 13) << 2]);
+	}
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		value += calculate_hand_val(&hand);
+	}
+	bench_stop(run);
+	bench_sink = value;
+	card_list_clear(&hand);
+}
+
+//hand_batch: BATCH_HANDS random hands of 1 to 'size' cards (the slots after a hand's cards left empty), evaluated by
+//a kernel. Before timing, every hand's results must agree with calculate_hand_val() and with the scalar kernel:
+//a disagreement ends the benchmarks. An op is a hand. A kernel this CPU does not run is skipped (0 iterations).
+static void bench_hand_batch(Bench_run_t* run, size_t size, const char* kernel) {
+	static uint8_t cards[HAND_BATCH_MAX_CARDS * BATCH_HANDS];
+	static uint8_t arrays[2][4][BATCH_HANDS];
+	Hand_batch_result_t result = { arrays[0][0], arrays[0][1], arrays[0][2], arrays[0][3] };
+	Hand_batch_result_t scalar = { arrays[1][0], arrays[1][1], arrays[1][2], arrays[1][3] };
+	Rng_t rng;
+	uint32_t sum = 0;
+
+	rng_seed(&rng, BENCH_SEED);
+	for (size_t h = 0; h < BATCH_HANDS; ++h) {
+		size_t count = 1 + rng_below(&rng, (uint32_t)size);
+		for (size_t s = 0; s < size; ++s) {
+			cards[s * BATCH_HANDS + h] = s < count ? card_codes[rng_below(&rng, CARDS_COUNT)] : CARD_NONE;
+		}
+	}
+	if (evaluate_hands_kernel(kernel, cards, BATCH_HANDS, size, &result) != SUCCESS) {
+		run->_iterations = 0;
+		return;
+	}
+	evaluate_hands_scalar(cards, BATCH_HANDS, size, &scalar);
+	for (size_t h = 0; h < BATCH_HANDS; ++h) {
+		Card_list_t hand = { 0 };
+		for (size_t s = 0; s < size && cards[s * BATCH_HANDS + h] != CARD_NONE; ++s) {
+			card_list_add_to_back(&hand, cards[s * BATCH_HANDS + h]);
+		}
+		uint32_t value = calculate_hand_val(&hand);
+		card_list_clear(&hand);
+		for (int a = 0; a < 4; ++a) {
+			if (arrays[0][a][h] != arrays[1][a][h] || result._value[h] != value) {
+				fprintf(stderr, "Warning: function[bench_hand_batch()]: %s kernel, hand %zu of %zu cards: value %u, scalar kernel %u, calculate_hand_val() %u\n",
+					kernel, h, size, result._value[h], scalar._value[h], value);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	uint64_t calls = (run->_iterations + BATCH_HANDS - 1) / BATCH_HANDS;
+	run->_iterations = calls * BATCH_HANDS;
+	bench_start(run);
+	for (uint64_t i = 0; i < calls; ++i) {
+		evaluate_hands_kernel(kernel, cards, BATCH_HANDS, size, &result);
+		sum += result._value[i % BATCH_HANDS];
+	}
+	bench_stop(run);
+	bench_sink = sum;
+}
+
+static void bench_hand_batch_avx2(Bench_run_t* run, size_t size) {
+	bench_hand_batch(run, size, "avx2");
+}
+
+static void bench_hand_batch_sse2(Bench_run_t* run, size_t size) {
+	bench_hand_batch(run, size, "sse2");
+}
+
+static void bench_hand_batch_scalar(Bench_run_t* run, size_t size) {
+	bench_hand_batch(run, size, "scalar");
+}
+
+static char bench_hit_below(Player_t* player, Player_t* dealer, void* ctx) {
+	return player->_hand._value < BENCH_HIT_BELOW ? 'H' : 'S';
+}
+
+//A full headless round: bet, deal, hit or stand (hit below 17) and the dealer's draw
+static void bench_round(Bench_run_t* run, size_t size) {
+	Table_t table;
+	Account_t* account = &table._player._account;
+	Account_t* house = &table._dealer._account;
+
+	table_init_seeded(&table, true, BENCH_SEED);
+	table_set_shoe(&table, (uint8_t)size, 0.75);
+	strcpy(table._player._info._name, "Bench");
+	table._player._info._id = 1;
+	account->_cash = BENCH_BANKROLL;
+	table._auto_bet = BENCH_BET;
+	table._decide = bench_hit_below;
+	const int32_t house_cash = house->_cash;
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		if (account->_cash + (int64_t)account->_bet < BENCH_BET) {
+			account->_cash = BENCH_BANKROLL;
+			account->_bet = 0;
+		}
+		if (house->_cash < house_cash / 2) {
+			house->_cash = house_cash;
+		}
+		if (!play_round(&table) && table._outcome == OUTCOME_NONE) {
+			fprintf(stderr, "Warning: function[bench_round()]: round %" PRIu64 " was not played\n", i);
+			break;
+		}
+	}
+	bench_stop(run);
+	table_clear(&table);
+}
+
+//A silent interactive game (see game_start())
+static void bench_game_start(Table_t* table, uint64_t seed) {
+	table_init_seeded(table, false, seed);
+	table_set_render(table, RENDER_SILENT, stdout);
+	game_start(table);
+}
+
+//The bench player's answer to the game's question
+static const char* bench_game_answer(const Table_t* table) {
+	switch (table->_wait) {
+	case GAME_NAME:       return "Bench";
+	case GAME_ID:         return "1";
+	case GAME_DEPOSIT:
+	case GAME_REDEPOSIT:  return GAMES_DEPOSIT;
+	case GAME_BET:        return "10";
+	case GAME_HIT_STAND:  return table->_player._hand._value < BENCH_HIT_BELOW ? "H" : "S";
+	case GAME_HINTS:      return "N";
+	default:              return "Y";
+	}
+}
+
+//games: 'size' interactive games served by a single thread, an answer line to each game in turn (an op is one
+//answer). A game that ends is started again.
+static void bench_games(Bench_run_t* run, size_t size) {
+	Table_t* tables = (Table_t*)calloc(size, sizeof(Table_t));
+
+	if (!tables) {
+		fprintf(stderr, "Warning: function[bench_games()]: Failed allocating memory for %zu games\n", size);
+		return;
+	}
+	for (size_t g = 0; g < size; ++g) {
+		bench_game_start(&tables[g], BENCH_SEED + g);
+	}
+
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		Table_t* table = &tables[i % size];
+		if (game_input(table, bench_game_answer(table)) <= GAME_OVER) {
+			table_clear(table);
+			bench_game_start(table, BENCH_SEED + i);
+		}
+	}
+	bench_stop(run);
+
+	for (size_t g = 0; g < size; ++g) {
+		table_clear(&tables[g]);
+	}
+	free(tables);
+}
+
+//A table in the middle of a round (the player's turn), for the snapshot benchmarks
+static void bench_mid_round_table(Table_t* table, size_t decks) {
+	table_init_seeded(table, true, BENCH_SEED);
+	table_set_shoe(table, (uint8_t)decks, 0.75);
+	table->_player._info._id = 1;
+	table->_player._account._cash = BENCH_BANKROLL;
+	table->_auto_bet = BENCH_BET;
+	table->_decide = bench_hit_below;
+	while (round_begin(table) != ROUND_PLAYER_TURN) {}
+}
+
+//snapshot: the table's state taken and encoded (as the game server saves a session)
+static void bench_snapshot(Bench_run_t* run, size_t size) {
+	Table_t table;
+	Table_snapshot_t snapshot;
+	uint8_t encoded[SNAPSHOT_ENCODED_SIZE];
+	size_t bytes = 0;
+
+	bench_mid_round_table(&table, size);
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		table_snapshot(&table, &snapshot);
+		bytes += snapshot_encode(&snapshot, encoded, sizeof(encoded));
+	}
+	bench_stop(run);
+	bench_sink = bytes;
+	table_clear(&table);
+}
+
+//restore: an encoded state decoded and put back on the table (as a session resume)
+static void bench_restore(Bench_run_t* run, size_t size) {
+	Table_t table;
+	Table_snapshot_t snapshot;
+	uint8_t encoded[SNAPSHOT_ENCODED_SIZE];
+
+	bench_mid_round_table(&table, size);
+	table_snapshot(&table, &snapshot);
+	size_t bytes = snapshot_encode(&snapshot, encoded, sizeof(encoded));
+	bench_start(run);
+	for (uint64_t i = 0; i < run->_iterations; ++i) {
+		if (snapshot_decode(&snapshot, encoded, bytes) != SUCCESS || table_restore(&table, &snapshot) != SUCCESS) {
+			fprintf(stderr, "Warning: function[bench_restore()]: restore failed\n");
+			break;
+		}
+	}
+	bench_stop(run);
+	table_clear(&table);
+}
+
+
+static const size_t list_sizes[] = { 4, 16, 64, 256, 1024, 0 };
+static const size_t deck_sizes[] = { 1, 6, 8, 0 };
+static const size_t hand_sizes[] = { 2, 3, 5, 8, 0 };
+static const size_t batch_sizes[] = { 2, 5, 8, HAND_BATCH_MAX_CARDS, 0 };
+static const size_t games_sizes[] = { 1, 1000, 50000, 0 };
+
+static const Bench_t benchmarks[] = {
+	{ "find",                "nodes", bench_find,                list_sizes },
+	{ "remove_at",           "nodes", bench_remove_at,           list_sizes },
+	{ "insert",              "nodes", bench_insert,              list_sizes },
+	{ "remove_from_back",    "nodes", bench_remove_from_back,    list_sizes },
+	{ "for_each",            "nodes", bench_for_each,            list_sizes },
+	{ "print_list_by_range", "nodes", bench_print_list_by_range, list_sizes },
+	{ "extract_range",       "nodes", bench_extract_range,       list_sizes },
+	{ "add_array_to_back",   "nodes", bench_add_array_to_back,   list_sizes },
+	{ "build_deck",          "decks", bench_build_deck,          deck_sizes },
+	{ "random_draw",         "decks", bench_random_draw,         deck_sizes },
+	{ "calculate_hand_val",  "cards", bench_calculate_hand_val,  hand_sizes },
+	{ "hand_batch_avx2",     "cards", bench_hand_batch_avx2,     batch_sizes },
+	{ "hand_batch_sse2",     "cards", bench_hand_batch_sse2,     batch_sizes },
+	{ "hand_batch_scalar",   "cards", bench_hand_batch_scalar,   batch_sizes },
+	{ "round",               "decks", bench_round,               deck_sizes },
+	{ "games",               "games", bench_games,               games_sizes },
+	{ "snapshot",            "decks", bench_snapshot,            deck_sizes },
+	{ "restore",             "decks", bench_restore,             deck_sizes },
+};
+
+//Runs the benchmark with growing iterations until a run lasts at least 'min_seconds', and prints that run
+static void bench_measure(const Bench_t* bench, size_t size, double min_seconds) {
+	Bench_run_t run = { 0 };
+	uint64_t iterations = 1;
+
+	for (;;) {
+		run._iterations = iterations;
+		bench->_run(&run, size);
+		if (!run._iterations) {
+			printf("%-20s %5zu %-5s %12s\n", bench->_name, size, bench->_size_unit, "n/a");
+			return;
+		}
+		if (run._seconds >= min_seconds || iterations >= MAX_ITERATIONS)
+			break;
+		//aims 20% above the minimum, growing 2x-100x at a time
+		double scale = run._seconds > 0 ? min_seconds * 1.2 / run._seconds : 100;
+		iterations = (uint64_t)(iterations * (scale < 2 ? 2 : scale > 100 ? 100 : scale));
+	}
+
+	double ns = run._seconds * 1e9 / run._iterations;
+	printf("%-20s %5zu %-5s %12.2f %10.3f %14.0f\n", bench->_name, size, bench->_size_unit, ns,
+	       (double)run._allocs / run._iterations, run._seconds > 0 ? run._iterations / run._seconds : 0.0);
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+
+	const char* prefix = argc > 1 && strcmp(argv[1], "all") ? argv[1] : "";
+	double min_seconds = argc > 2 ? strtod(argv[2], NULL) : DEFAULT_MIN_SECONDS;
+	size_t matched = 0;
+
+	if (min_seconds <= 0) {
+		min_seconds = DEFAULT_MIN_SECONDS;
+	}
+#ifdef LIST_DOUBLY_LINKED
+	printf("lists: doubly linked (DLL.c)\n");
+#else
+	printf("lists: singly linked (SLL.c)\n");
+#endif
+	printf("%-20s %-11s %12s %10s %14s\n", "benchmark", "size", "ns/op", "allocs/op", "ops/sec");
+
+	for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); ++b) {
+		if (strncmp(benchmarks[b]._name, prefix, strlen(prefix)))
+			continue;
+		for (const size_t* size = benchmarks[b]._sizes; *size; ++size) {
+			bench_measure(&benchmarks[b], *size, min_seconds);
+		}
+		matched++;
+	}
+	if (!matched) {
+		fprintf(stderr, "No benchmark named %s...\n", prefix);
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
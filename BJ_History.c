@@ -0,0 +1,68 @@
+/*
+ * Author: Noga Avraham
+ * Description: Reads a binary hand history log (see History.h): decodes all its rounds and prints the totals,
+ *              or replays them on a fresh table to verify the log.
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_History.c History.c Columns.c Black_Jack.c Render.c Exact_ev.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *              Usage: BJ_History [log file (e.g. a BJ_Simulator worker log)] [verify]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<inttypes.h>
+#include<time.h>
+#include "History.h"
+
+
+int main(int argc, char* argv[]) {
+
+	History_reader_t reader;
+	History_round_t round;
+	uint64_t rounds = 0, outcomes[4] = { 0 }, wagered = 0;
+	int64_t net = 0;
+	struct timespec start, end;
+	int next;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s [log file] [verify]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (history_open(&reader, argv[1]) != SUCCESS)
+		return EXIT_FAILURE;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while ((next = history_next(&reader, &round)) == 1) {
+		++rounds;
+		++outcomes[round._flags & HISTORY_OUTCOME_MASK];
+		wagered += round._stake;
+		net += round._net;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("decks:         %u\n", reader._decks);
+	printf("rounds:        %" PRIu64 "\n", rounds);
+	printf("player wins:   %" PRIu64 "\n", outcomes[OUTCOME_PLAYER_WIN]);
+	printf("dealer wins:   %" PRIu64 "\n", outcomes[OUTCOME_DEALER_WIN]);
+	printf("ties:          %" PRIu64 "\n", outcomes[OUTCOME_TIE]);
+	printf("net:           %" PRId64 "\n", net);
+	printf("average bet:   %.2f\n", rounds ? (double)wagered / rounds : 0.0);
+	printf("bytes/round:   %.2f\n", rounds ? (double)reader._size / rounds : 0.0);
+	printf("decoded/sec:   %.0f\n", seconds > 0 ? rounds / seconds : 0.0);
+	history_close(&reader);
+	if (next == FAIL) {
+		fprintf(stderr, "Corrupt log: decoding stopped after %" PRIu64 " rounds\n", rounds);
+		return EXIT_FAILURE;
+	}
+
+	if (argc > 2 && !strcmp(argv[2], "verify")) {
+		uint64_t verified = 0;
+		int result = history_verify(argv[1], &verified);
+		printf("verified:      %" PRIu64 " rounds, %s\n", verified, result == SUCCESS ? "replay matches" : "replay differs");
+		if (result != SUCCESS)
+			return EXIT_FAILURE;
+	}
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * Author: Noga Avraham
+ * Description: Load client of the "Black Jack" game server: many local connections, each playing its own rounds
+ *              (hitting below a hand value), with a single request in flight per connection.
+ *              Reports the server throughput and the request-to-reply latency percentiles.
+ *              Build: gcc -O2 BJ_Load_client.c Net.c
+ *              Usage: BJ_Load_client [address] [connections] [rounds per connection] [bet] [hit below value]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<inttypes.h>
+#include<errno.h>
+#include<time.h>
+#include<unistd.h>
+#include<sys/epoll.h>
+#include<sys/socket.h>
+#include "Net.h"
+
+#define FAIL -1
+#define SUCCESS 0
+
+#define DEFAULT_CONNECTIONS 1000
+#define DEFAULT_ROUNDS 100
+#define DEFAULT_BET 10
+#define DEFAULT_HIT_BELOW 17
+#define REPLY_SIZE 128
+#define MAX_EVENTS 256
+
+
+typedef struct Connection {
+	int _fd;
+	uint64_t _rounds_left;
+	uint64_t _sent_at;       //ns, of the request in flight
+	size_t _in_len;
+	char _in[REPLY_SIZE];
+}Connection_t;
+
+//Latencies of all the requests, in ns
+typedef struct Latencies {
+	uint64_t* _ns;
+	size_t _count;
+	size_t _capacity;
+}Latencies_t;
+
+typedef struct Load {
+	uint32_t _bet;
+	uint32_t _hit_below;
+	uint64_t _requests;
+	uint64_t _rounds;
+	uint64_t _errors;
+	Latencies_t _latencies;
+}Load_t;
+
+
+static uint64_t now_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static int compare_u64(const void* a, const void* b) {
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+static void latency_add(Latencies_t* latencies, uint64_t ns) {
+	if (latencies->_count == latencies->_capacity) {
+		size_t capacity = latencies->_capacity ? latencies->_capacity * 2 : 1 << 16;
+		uint64_t* grown = (uint64_t*)realloc(latencies->_ns, capacity * sizeof(uint64_t));
+		if (!grown) {
+			fprintf(stderr, "Error: function[latency_add()]: Failed allocating memory for latencies. exitting");
+			exit(EXIT_FAILURE);
+		}
+		latencies->_ns = grown;
+		latencies->_capacity = capacity;
+	}
+	latencies->_ns[latencies->_count++] = ns;
+}
+
+//latencies must be sorted. 'q' in range 0-1
+static double latency_us(const Latencies_t* latencies, double q) {
+	if (!latencies->_count)
+		return 0.0;
+	size_t i = (size_t)(q * (double)(latencies->_count - 1) + 0.5);
+	return latencies->_ns[i] / 1e3;
+}
+
+//Sends a request line. Returns: FAIL in case of fail, otherwise SUCCESS.
+static int send_request(Load_t* load, Connection_t* connection, const char* line) {
+	size_t len = strlen(line);
+
+	connection->_sent_at = now_ns();
+	if (send(connection->_fd, line, len, MSG_NOSIGNAL) != (ssize_t)len) {
+		fprintf(stderr, "Warning: function[send_request()]: send(): %s\n", strerror(errno));
+		return FAIL;
+	}
+	load->_requests++;
+	return SUCCESS;
+}
+
+//Plays on after a reply line. Returns: FAIL- the connection is done (or failed), otherwise SUCCESS.
+static int on_reply(Load_t* load, Connection_t* connection, const char* reply) {
+	char request[32];
+	unsigned int value = 0, up_card = 0;
+
+	latency_add(&load->_latencies, now_ns() - connection->_sent_at);
+
+	switch (reply[0]) {
+	case 'T':
+		if (sscanf(reply, "T %u %u", &value, &up_card) != 2)
+			break;
+		return send_request(load, connection, value < load->_hit_below ? "H\n" : "S\n");
+	case 'R':
+		load->_rounds++;
+		if (!--connection->_rounds_left)
+			return FAIL;
+		snprintf(request, sizeof(request), "B %u\n", load->_bet);
+		return send_request(load, connection, request);
+	default:
+		break;
+	}
+	load->_errors++;
+	fprintf(stderr, "Warning: function[on_reply()]: unexpected reply '%s'\n", reply);
+	return FAIL;
+}
+
+//Reads the replies. Returns: FAIL- the connection is done (or failed), otherwise SUCCESS.
+static int on_readable(Load_t* load, Connection_t* connection) {
+	for (;;) {
+		ssize_t got = read(connection->_fd, connection->_in + connection->_in_len, REPLY_SIZE - connection->_in_len);
+
+		if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return SUCCESS;
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return FAIL;
+		connection->_in_len += (size_t)got;
+
+		char* end = NULL;
+		while ((end = (char*)memchr(connection->_in, '\n', connection->_in_len))) {
+			*end = '\0';
+			if (on_reply(load, connection, connection->_in) != SUCCESS)
+				return FAIL;
+			connection->_in_len -= (size_t)(end + 1 - connection->_in);
+			memmove(connection->_in, end + 1, connection->_in_len);
+		}
+		if (connection->_in_len == REPLY_SIZE)
+			return FAIL;
+	}
+}
+
+int main(int argc, char* argv[]) {
+
+	const char* address = argc > 1 ? argv[1] : NET_DEFAULT_ADDRESS;
+	size_t connections = argc > 2 ? strtoull(argv[2], NULL, 10) : DEFAULT_CONNECTIONS;
+	uint64_t rounds = argc > 3 ? strtoull(argv[3], NULL, 10) : DEFAULT_ROUNDS;
+	Load_t load = { 0 };
+	char request[32];
+	size_t open = 0;
+	struct epoll_event events[MAX_EVENTS];
+
+	load._bet = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 10) : DEFAULT_BET;
+	load._hit_below = argc > 5 ? (uint32_t)strtoul(argv[5], NULL, 10) : DEFAULT_HIT_BELOW;
+	if (!connections || !rounds) {
+		fprintf(stderr, "Nothing to play\n");
+		return EXIT_FAILURE;
+	}
+	net_raise_files_limit();
+
+	Connection_t* conns = (Connection_t*)calloc(connections, sizeof(Connection_t));
+	int epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (!conns || epoll < 0) {
+		fprintf(stderr, "Failed allocating connections\n");
+		return EXIT_FAILURE;
+	}
+
+	//all the sessions are opened before the clock starts
+	for (size_t i = 0; i < connections; ++i) {
+		struct epoll_event ev = { EPOLLIN, { .ptr = &conns[i] } };
+
+		conns[i]._fd = net_connect(address);
+		if (conns[i]._fd < 0 || net_set_nonblocking(conns[i]._fd, true) != SUCCESS ||
+			epoll_ctl(epoll, EPOLL_CTL_ADD, conns[i]._fd, &ev) != 0) {
+			fprintf(stderr, "Failed opening connection %zu\n", i);
+			return EXIT_FAILURE;
+		}
+		conns[i]._rounds_left = rounds;
+	}
+
+	uint64_t start = now_ns();
+	snprintf(request, sizeof(request), "B %u\n", load._bet);
+	for (size_t i = 0; i < connections; ++i) {
+		if (send_request(&load, &conns[i], request) == SUCCESS)
+			open++;
+	}
+
+	while (open) {
+		int ready = epoll_wait(epoll, events, MAX_EVENTS, -1);
+
+		if (ready < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "epoll_wait(): %s\n", strerror(errno));
+			break;
+		}
+		for (int i = 0; i < ready; ++i) {
+			Connection_t* connection = (Connection_t*)events[i].data.ptr;
+
+			if (on_readable(&load, connection) != SUCCESS) {
+				epoll_ctl(epoll, EPOLL_CTL_DEL, connection->_fd, NULL);
+				close(connection->_fd);
+				open--;
+			}
+		}
+	}
+	double seconds = (now_ns() - start) / 1e9;
+
+	qsort(load._latencies._ns, load._latencies._count, sizeof(uint64_t), compare_u64);
+	printf("connections:   %zu\n", connections);
+	printf("rounds:        %" PRIu64 "\n", load._rounds);
+	printf("requests:      %" PRIu64 "\n", load._requests);
+	printf("errors:        %" PRIu64 "\n", load._errors);
+	printf("requests/sec:  %.0f\n", seconds > 0 ? load._requests / seconds : 0.0);
+	printf("rounds/sec:    %.0f\n", seconds > 0 ? load._rounds / seconds : 0.0);
+	printf("latency us:    p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+		latency_us(&load._latencies, 0.50), latency_us(&load._latencies, 0.90), latency_us(&load._latencies, 0.99),
+		latency_us(&load._latencies, 0.999), latency_us(&load._latencies, 1.0));
+
+	free(load._latencies._ns);
+	free(conns);
+	close(epoll);
+	return load._errors ? EXIT_FAILURE : 0;
+}
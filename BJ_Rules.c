@@ -0,0 +1,85 @@
+/*
+ * Author: Noga Avraham
+ * Description: Sweeps casino rule variants (see Rules.h): plays the same number of basic strategy rounds, on the same
+ *              shoes, under every variant and prints the player's edge and the actions frequencies of each.
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_Rules.c Rules.c Black_Jack.c Render.c History.c Columns.c Exact_ev.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *              Usage: BJ_Rules [rounds per variant] [threads (0: all cores)] [seed] [decks] [penetration]
+ *                              [variants names (default: all)...]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<inttypes.h>
+#include "Rules.h"
+
+#define DEFAULT_ROUNDS 10000000
+#define DEFAULT_SEED 2021
+#define DEFAULT_BET 10
+#define DEFAULT_DECKS 6
+#define DEFAULT_PENETRATION 0.75
+#define FIRST_VARIANT_ARG 6
+
+
+static void print_variant(const Rules_t* rules, const Rules_stats_t* stats);
+
+
+int main(int argc, char* argv[]) {
+
+	Rules_sweep_t sweep = {
+		._rounds = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_ROUNDS,
+		._threads = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 10) : 0,
+		._seed = argc > 3 ? strtoull(argv[3], NULL, 10) : DEFAULT_SEED,
+		._decks = (uint8_t)(argc > 4 ? strtoul(argv[4], NULL, 10) : DEFAULT_DECKS),
+		._penetration = argc > 5 ? strtod(argv[5], NULL) : DEFAULT_PENETRATION,
+		._bet = DEFAULT_BET,
+	};
+	const Rules_t* variants[RULES_VARIANTS];
+	int count = 0;
+
+	if (argc > FIRST_VARIANT_ARG) {
+		for (int a = FIRST_VARIANT_ARG; a < argc && count < RULES_VARIANTS; ++a) {
+			if (!(variants[count++] = rules_find(argv[a]))) {
+				fprintf(stderr, "Unknown variant '%s'. Variants:", argv[a]);
+				for (int v = 0; v < RULES_VARIANTS; ++v) {
+					fprintf(stderr, " %s", rules_variants[v]._name);
+				}
+				fprintf(stderr, "\n");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	else {
+		for (; count < RULES_VARIANTS; ++count) {
+			variants[count] = &rules_variants[count];
+		}
+	}
+
+	printf("%" PRIu64 " rounds per variant, %u decks, penetration %.2f, basic strategy\n\n", sweep._rounds, sweep._decks, sweep._penetration);
+	printf("%-14s %-30s %9s %8s %8s %8s %8s %8s %12s\n", "variant", "rules", "edge %", "bj %", "double %",
+		"split %", "surr %", "p.bust %", "rounds/sec");
+	for (int v = 0; v < count; ++v) {
+		Rules_stats_t stats;
+		if (rules_sweep(variants[v], &sweep, &stats) != SUCCESS)
+			return EXIT_FAILURE;
+		print_variant(variants[v], &stats);
+	}
+	return 0;
+}
+
+//A line per variant. Rates are per round, the edge is the net win per initial bet.
+static void print_variant(const Rules_t* rules, const Rules_stats_t* stats) {
+	static const char* const doubles[] = { "no DD", "DA2", "D9", "D10" };
+	char summary[64];
+	double rounds = stats->_rounds ? (double)stats->_rounds : 1.0;
+
+	snprintf(summary, sizeof(summary), "%s %u:%u %s%s %s%s%s%s", rules->_h17 ? "H17" : "S17", rules->_natural_num, rules->_natural_den,
+		doubles[rules->_double], rules->_double_after_split && rules->_max_hands > 1 ? "/DAS" : "",
+		rules->_max_hands > 1 ? "SP" : "no SP", rules->_max_hands > 2 ? "4" : "", rules->_surrender ? " LS" : "",
+		rules->_dealer_bust_pays > 1 ? " bust x2" : "");
+	printf("%-14s %-30s %+9.3f %8.3f %8.3f %8.3f %8.3f %8.3f %12.0f\n", rules->_name, summary,
+		stats->_bets ? 100.0 * stats->_net / stats->_bets : 0.0, 100.0 * stats->_black_jacks / rounds,
+		100.0 * stats->_doubles / rounds, 100.0 * stats->_splits / rounds, 100.0 * stats->_surrenders / rounds,
+		100.0 * stats->_player_busts / rounds, stats->_seconds > 0 ? stats->_rounds / stats->_seconds : 0.0);
+}
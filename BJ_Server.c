@@ -0,0 +1,106 @@
+/*
+ * Author: Noga Avraham
+ * Description: The "Black Jack" multi-table game server (protocol: see Server.h). Stops on Ctrl-C / SIGTERM.
+ *              Built with -DBJ_STATS, SIGUSR1 dumps the game phases stats (see Stats.h) while it runs, and on exit.
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_Server.c Server.c Net.c Exact_ev.c Black_Jack.c Render.c History.c Columns.c Snapshot.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *              Usage: BJ_Server [address (unix:<path> / tcp:<port>)] [loops (0: all cores)] [seed] [decks] [penetration]
+ *                               [phases stats dump: text / json] [sessions snapshots directory (crash recovery)]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<inttypes.h>
+#include<signal.h>
+#include<time.h>
+#include<string.h>
+#include<pthread.h>
+#include "Server.h"
+#include "Net.h"
+#include "Stats.h"
+
+#define DEFAULT_SEED 2021
+#define DEFAULT_DECKS 6
+#define DEFAULT_PENETRATION 0.75
+
+
+static enum stats_format dump_format = STATS_TEXT;
+
+
+static void on_stop_signal(int signal) {
+	server_stop();
+}
+
+static void stats_print(void) {
+	Stats_t stats;
+
+	stats_collect(&stats);
+	stats_dump(stdout, &stats, dump_format);
+	fflush(stdout);
+}
+
+//Waits for SIGUSR1 (blocked in all the other threads) and dumps the stats
+static void* stats_dump_run(void* arg) {
+	sigset_t* dump_signal = (sigset_t*)arg;
+	int signal = 0;
+
+	while (sigwait(dump_signal, &signal) == 0) {
+		stats_print();
+	}
+	return NULL;
+}
+
+int main(int argc, char* argv[]) {
+
+	Server_config_t config = {
+		._address = argc > 1 ? argv[1] : NET_DEFAULT_ADDRESS,
+		._loops = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 10) : 0,
+		._seed = argc > 3 ? strtoull(argv[3], NULL, 10) : DEFAULT_SEED,
+		._decks = (uint8_t)(argc > 4 ? strtoul(argv[4], NULL, 10) : DEFAULT_DECKS),
+		._penetration = argc > 5 ? strtod(argv[5], NULL) : DEFAULT_PENETRATION,
+		._snapshots = argc > 7 ? argv[7] : NULL,
+	};
+	Server_stats_t stats = { 0 };
+	struct sigaction stop = { 0 };
+	struct timespec start, end;
+	static sigset_t dump_signal;
+	pthread_t dump_thread;
+
+	stop.sa_handler = on_stop_signal;
+	sigaction(SIGINT, &stop, NULL);
+	sigaction(SIGTERM, &stop, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	if (stats_enabled()) {
+		dump_format = argc > 6 && !strcmp(argv[6], "json") ? STATS_JSON : STATS_TEXT;
+		sigemptyset(&dump_signal);
+		sigaddset(&dump_signal, SIGUSR1);
+		pthread_sigmask(SIG_BLOCK, &dump_signal, NULL); //the server loops inherit the mask
+		if (pthread_create(&dump_thread, NULL, stats_dump_run, &dump_signal) != 0)
+			fprintf(stderr, "Warning: no stats dump on SIGUSR1\n");
+	}
+
+	printf("open files limit: %lu\n", net_raise_files_limit());
+	printf("listening on %s\n", config._address);
+	fflush(stdout);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (server_run(&config, &stats) != SUCCESS) {
+		fprintf(stderr, "Server failed\n");
+		return EXIT_FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("sessions:      %" PRIu64 "\n", stats._sessions);
+	printf("peak sessions: %" PRIu64 "\n", stats._peak_sessions);
+	printf("requests:      %" PRIu64 "\n", stats._requests);
+	printf("rounds:        %" PRIu64 "\n", stats._rounds);
+	printf("errors:        %" PRIu64 "\n", stats._errors);
+	printf("requests/sec:  %.0f\n", seconds > 0 ? stats._requests / seconds : 0.0);
+	if (stats_enabled()) {
+		stats_print();
+	}
+
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Author: Noga Avraham
+ * Description: Command line Monte Carlo simulator of the "Black Jack" game, running on all cores.
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_Simulator.c Simulation.c Strategy.c Exact_ev.c Count.c Black_Jack.c Render.c History.c Columns.c Snapshot.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *                     (phases stats: -DBJ_STATS)
+ *              Usage: BJ_Simulator [rounds] [threads (0: all cores)] [seed] [bet] [hit below value] [decks] [penetration]
+ *                                   [strategy chart file (see BJ_Strategy.c) or "exact" (exact EV decisions):
+ *                                    played instead of hit below. "-": hit below]
+ *                                   [bet spread (bets 1-spread units by the count)] [count: hilo / ko / omega2]
+ *                                   [phases stats dump (-DBJ_STATS builds): text / json]
+ *                                   [hand history file: worker i logs to "<file>.<i>" (see BJ_History.c). "-": none]
+ *                                   [columns export file: worker i exports to "<file>.<i>" (see BJ_Analytics.c). "-": none]
+ *                                   [snapshot file (e.g. a game server session's): the workers are branches of it]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<inttypes.h>
+#include<time.h>
+#include "Simulation.h"
+#include "Strategy.h"
+#include "Stats.h"
+
+#define DEFAULT_ROUNDS 10000000
+#define DEFAULT_SEED 2021
+#define DEFAULT_BET 10
+#define DEFAULT_HIT_BELOW 17
+#define DEFAULT_DECKS 6
+#define DEFAULT_PENETRATION 0.75
+
+
+int main(int argc, char* argv[]) {
+
+	uintptr_t hit_below = argc > 5 ? strtoul(argv[5], NULL, 10) : DEFAULT_HIT_BELOW;
+	Sim_config_t config = {
+		._rounds = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_ROUNDS,
+		._threads = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 10) : 0,
+		._seed = argc > 3 ? strtoull(argv[3], NULL, 10) : DEFAULT_SEED,
+		._bet = argc > 4 ? (uint32_t)strtoul(argv[4], NULL, 10) : DEFAULT_BET,
+		._decks = (uint8_t)(argc > 6 ? strtoul(argv[6], NULL, 10) : DEFAULT_DECKS),
+		._penetration = argc > 7 ? strtod(argv[7], NULL) : DEFAULT_PENETRATION,
+		._decide = sim_hit_below,
+		._ctx = (void*)hit_below,
+	};
+	Sim_stats_t stats = { 0 };
+	Strategy_t strategy;
+	Table_snapshot_t from;
+	struct timespec start, end;
+
+	if (argc > 8 && !strcmp(argv[8], "exact")) {
+		config._exact_ev = true;
+	}
+	else if (argc > 8 && strcmp(argv[8], "-")) {
+		if (strategy_load(&strategy, argv[8]) != SUCCESS)
+			return EXIT_FAILURE;
+		config._decide = strategy_decide;
+		config._ctx = &strategy;
+	}
+
+	if (argc > 9) {
+		config._bet_spread = (uint8_t)strtoul(argv[9], NULL, 10);
+	}
+	if (argc > 10) {
+		config._count_system = !strcmp(argv[10], "ko") ? COUNT_KO : !strcmp(argv[10], "omega2") ? COUNT_OMEGA_II :
+		                       !strcmp(argv[10], "hilo") ? COUNT_HI_LO : COUNT_SYSTEMS;
+	}
+	if (argc > 12 && strcmp(argv[12], "-")) {
+		config._history = argv[12];
+	}
+	if (argc > 13 && strcmp(argv[13], "-")) {
+		config._columns = argv[13];
+	}
+	if (argc > 14) {
+		if (snapshot_load(argv[14], &from) != SUCCESS)
+			return EXIT_FAILURE;
+		config._from = &from;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (simulate_parallel(&config, &stats) != SUCCESS) {
+		fprintf(stderr, "Simulation failed\n");
+		return EXIT_FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("rounds:        %" PRIu64 "\n", stats._rounds);
+	printf("player wins:   %" PRIu64 "\n", stats._player_wins);
+	printf("dealer wins:   %" PRIu64 "\n", stats._dealer_wins);
+	printf("ties:          %" PRIu64 "\n", stats._ties);
+	printf("black jacks:   %" PRIu64 "\n", stats._black_jacks);
+	printf("player busts:  %" PRIu64 "\n", stats._player_busts);
+	printf("dealer busts:  %" PRIu64 "\n", stats._dealer_busts);
+	printf("re-buys:       %" PRIu64 "\n", stats._rebuys);
+	printf("shuffles:      %" PRIu64 "\n", stats._shuffles);
+	printf("net:           %" PRId64 "\n", stats._net);
+	printf("average bet:   %.2f\n", stats._rounds ? (double)stats._wagered / stats._rounds : 0.0);
+	printf("player edge:   %.6f\n", sim_player_edge(&stats));
+	printf("allocs/round:  %.6f\n", stats._rounds ? (double)stats._heap_allocs / stats._rounds : 0.0);
+	printf("rounds/sec:    %.0f\n", seconds > 0 ? stats._rounds / seconds : 0.0);
+
+	if (stats_enabled()) {
+		Stats_t phases;
+		stats_collect(&phases);
+		stats_dump(stdout, &phases, argc > 11 && !strcmp(argv[11], "json") ? STATS_JSON : STATS_TEXT);
+	}
+
+	return 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * Author: Noga Avraham
+ * Description: Generates the basic strategy chart of this game's rules (see Strategy.h), prints it and saves
+ *              it to a file the simulator can load.
+ *              Build: gcc -O2 -pthread -DBJ_NO_MAIN BJ_Strategy.c Strategy.c Exact_ev.c Black_Jack.c Render.c History.c Columns.c Cards.c SLL.c SLL_alloc.c Shoe.c Rng.c Stats.c
+ *              Usage: BJ_Strategy [output file] [decks (0: infinite deck)] [threads (0: all cores)]
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include "Strategy.h"
+
+#define DEFAULT_PATH "strategy.txt"
+#define DEFAULT_DECKS 6
+
+
+int main(int argc, char* argv[]) {
+
+	const char* path = argc > 1 ? argv[1] : DEFAULT_PATH;
+	uint8_t decks = (uint8_t)(argc > 2 ? strtoul(argv[2], NULL, 10) : DEFAULT_DECKS);
+	unsigned int threads = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : 0;
+	Strategy_t strategy;
+	double ev = 0;
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (strategy_generate(&strategy, decks, threads, &ev) != SUCCESS) {
+		fprintf(stderr, "Strategy generation failed\n");
+		return EXIT_FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("           A 2 3 4 5 6 7 8 9 10\n");
+	for (int soft = 0; soft <= 1; ++soft) {
+		for (int v = soft ? 12 : 4; v <= 20; ++v) {
+			printf("%s %2d:  ", soft ? "soft" : "hard", v);
+			for (int up = 0; up < STRATEGY_UP_CARDS; ++up) {
+				printf(" %c", (strategy._hit[soft][up] >> v) & 1 ? 'H' : 'S');
+			}
+			printf("\n");
+		}
+	}
+	printf("decks:         %u%s\n", decks, decks ? "" : " (infinite deck)");
+	printf("player edge:   %.6f\n", ev);
+	printf("generated in:  %.6f sec\n", seconds);
+
+	if (strategy_save(&strategy, path) != SUCCESS) {
+		return EXIT_FAILURE;
+	}
+	printf("saved to:      %s\n", path);
+	return 0;
+}
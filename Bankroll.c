@@ -0,0 +1,581 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the bankroll simulator.
+ *              The outcomes distribution is turned into a plan of integers: the pay of every outcome in fixed point,
+ *              and the cumulative probabilities as 32 bits thresholds. A round draws a 32 bits word per path, and
+ *              its pay is the lowest outcome's pay plus the step to every outcome whose threshold the word reaches,
+ *              so sampling is compares and adds only (the unsigned compares are signed ones on words XORed with
+ *              the sign bit). A block of 8 paths has 4 xoshiro256** generators, each draw giving 2 paths a word.
+ *              The SSE2 kernel runs a block as two 4 lanes halves, the AVX2 kernel as one 8 lanes register, and
+ *              both give the scalar kernel's exact results.
+ *              Link with Black_Jack.c compiled with -DBJ_NO_MAIN (and -pthread).
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<inttypes.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>//sysconf()
+#include "Bankroll.h"
+
+#if defined(__x86_64__) //SSE2 is the x86-64 baseline (32 bits x86 builds run the scalar kernel)
+#define BANKROLL_X86
+#include<immintrin.h>
+#endif
+
+#define MAX_THREADS 1024
+#define MAX_DECKS 8
+#define SIGN_BIT 0x80000000u
+#define FIXED_MAX (1 << 30)      //cash and caps: the drawdown (peak - cash) stays in 32 bits
+#define FIXED_MAX_PAY (1 << 27)  //a round's pay, either way
+#define ALIVE_CHECK 64           //vector kernels: rounds between checks for a block with no path left
+#define MEASURE_BET 100          //bet of the measured rounds (nets are in bets). Every variant pays it exactly
+#define MEASURE_CASH 1000000
+#define MEASURE_PENETRATION 0.75
+#define MEASURE_HIT_BELOW 17
+
+
+//The outcomes and the limits in the kernels' terms (fixed point)
+typedef struct Bankroll_plan {
+	uint32_t _outcomes;
+	int32_t _first_pay;                           //pay of the lowest outcome
+	uint32_t _threshold[BANKROLL_MAX_OUTCOMES];   //[k]: a word of at least it pays outcome k or a higher one (k >= 1)
+	int32_t _step[BANKROLL_MAX_OUTCOMES];         //[k]: pay of outcome k less the pay of outcome k - 1
+	int32_t _start;
+	int32_t _bet;
+	int32_t _cap;                                 //a path with more cash won the house budget
+	uint32_t _rounds;
+	uint64_t _seed;
+}Bankroll_plan_t;
+
+//A worker's batch of paths, structure of arrays
+typedef struct Bankroll_paths {
+	int32_t _cash[BANKROLL_BATCH];
+	int32_t _drawdown[BANKROLL_BATCH];
+	uint32_t _ruin[BANKROLL_BATCH];               //round of the ruin, 0: not ruined
+}Bankroll_paths_t;
+
+//evolves the paths of 'blocks' blocks from block 'block' (global index) into 'paths'
+typedef void (*bankroll_kernel_t)(const Bankroll_plan_t* plan, uint64_t block, size_t blocks, Bankroll_paths_t* paths);
+
+//A worker of bankroll_run(): the paths [_first, _last)
+typedef struct Bankroll_worker {
+	pthread_t _thread;
+	const Bankroll_plan_t* _plan;
+	bankroll_kernel_t _kernel;
+	uint64_t _first;
+	uint64_t _last;
+	int64_t _cash;                                //final cash sum, fixed point
+	Bankroll_paths_t _paths;
+	Bankroll_result_t _result;
+}Bankroll_worker_t;
+
+
+static int make_plan(const Bankroll_config_t* config, const Bankroll_outcomes_t* outcomes, Bankroll_plan_t* plan);
+static inline int64_t to_fixed(double amount);
+static void block_seed(uint64_t seed, uint64_t block, uint64_t state[4][4]);
+static void kernel_scalar(const Bankroll_plan_t* plan, uint64_t block, size_t blocks, Bankroll_paths_t* paths);
+static bankroll_kernel_t select_kernel(const char** name);
+static void* bankroll_worker_run(void* arg);
+static char measure_hit_below(Player_t* player, Player_t* dealer, void* ctx);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+int bankroll_outcomes_add(Bankroll_outcomes_t* outcomes, double net) {
+	assert_condition(outcomes, "Error: function[bankroll_outcomes_add()]: Null outcomes pointer provided");
+
+	uint32_t k = 0;
+	while (k < outcomes->_count && outcomes->_net[k] < net) {
+		k++;
+	}
+	if (k == outcomes->_count || outcomes->_net[k] != net) {
+		if (outcomes->_count == BANKROLL_MAX_OUTCOMES) {
+			fprintf(stderr, "Warning: function[bankroll_outcomes_add()]: More than %d different nets\n", BANKROLL_MAX_OUTCOMES);
+			return FAIL;
+		}
+		memmove(&outcomes->_net[k + 1], &outcomes->_net[k], (outcomes->_count - k) * sizeof(double));
+		memmove(&outcomes->_rounds[k + 1], &outcomes->_rounds[k], (outcomes->_count - k) * sizeof(uint64_t));
+		outcomes->_net[k] = net;
+		outcomes->_rounds[k] = 0;
+		outcomes->_count++;
+	}
+	outcomes->_rounds[k]++;
+	outcomes->_total++;
+	return SUCCESS;
+}
+
+int bankroll_game_outcomes(Bankroll_outcomes_t* outcomes, uint64_t rounds, uint64_t seed, hit_stand_decision decide, void* ctx) {
+	assert_condition(outcomes, "Error: function[bankroll_game_outcomes()]: Null outcomes pointer provided");
+
+	Table_t table;
+	Account_t* account = &table._player._account;
+	Account_t* house = &table._dealer._account;
+	int result = SUCCESS;
+
+	table_init_seeded(&table, true, seed);
+	table._player._info._id = 1;
+	account->_cash = MEASURE_CASH;
+	table._auto_bet = MEASURE_BET;
+	table._decide = decide ? decide : measure_hit_below;
+	table._decide_ctx = ctx;
+	const int32_t house_cash = house->_cash;
+
+	for (uint64_t r = 0; r < rounds && result == SUCCESS; ++r) {
+		if (account->_cash < MEASURE_CASH / 2) {
+			account->_cash = MEASURE_CASH;
+		}
+		if (house->_cash < house_cash / 2) {
+			house->_cash = house_cash;
+		}
+		//the equity (cash and the bet on the table) before and after: a push leaves the bet on the table
+		int64_t equity = (int64_t)account->_cash + account->_bet;
+		if (!play_round(&table) && table._outcome == OUTCOME_NONE) {
+			fprintf(stderr, "Warning: function[bankroll_game_outcomes()]: round %" PRIu64 " was not played\n", r);
+			result = FAIL;
+			break;
+		}
+		result = bankroll_outcomes_add(outcomes, (double)((int64_t)account->_cash + account->_bet - equity) / MEASURE_BET);
+	}
+	table_clear(&table);
+	return result;
+}
+
+int bankroll_rules_outcomes(Bankroll_outcomes_t* outcomes, const Rules_t* rules, uint64_t rounds, uint64_t seed, uint8_t decks) {
+	assert_condition(outcomes && rules, "Error: function[bankroll_rules_outcomes()]: Null outcomes or rules pointer provided");
+
+	if (decks < 1 || decks > MAX_DECKS) {
+		fprintf(stderr, "Warning: function[bankroll_rules_outcomes()]: Argument 'decks' = %u. Must be 1-%d\n", decks, MAX_DECKS);
+		return FAIL;
+	}
+
+	Rng_t rng;
+	Rules_round_t round;
+	int result = SUCCESS;
+
+	rng_seed(&rng, seed);
+	Shoe_t* shoe = create_shoe((size_t)decks * CARDS_COUNT, &rng);
+	for (uint8_t d = 0; d < decks; ++d) {
+		fill_shoe(shoe, card_codes, CARDS_COUNT);
+	}
+	shuffle_shoe(shoe);
+	set_shoe_penetration(shoe, MEASURE_PENETRATION);
+
+	for (uint64_t r = 0; r < rounds && result == SUCCESS; ++r) {
+		int64_t net = rules_play_round(rules, shoe, MEASURE_BET, rules_basic_decide, NULL, &round);
+		result = bankroll_outcomes_add(outcomes, (double)net / MEASURE_BET);
+	}
+	clear_shoe(shoe);
+	return result;
+}
+
+double bankroll_outcomes_mean(const Bankroll_outcomes_t* outcomes) {
+	assert_condition(outcomes, "Error: function[bankroll_outcomes_mean()]: Null outcomes pointer provided");
+
+	double sum = 0.0;
+	for (uint32_t k = 0; k < outcomes->_count; ++k) {
+		sum += outcomes->_net[k] * outcomes->_rounds[k];
+	}
+	return outcomes->_total ? sum / outcomes->_total : 0.0;
+}
+
+int bankroll_run(const Bankroll_config_t* config, const Bankroll_outcomes_t* outcomes, Bankroll_result_t* result) {
+	assert_condition(config && outcomes && result, "Error: function[bankroll_run()]: Null config, outcomes or result pointer provided");
+
+	Bankroll_plan_t plan;
+	Bankroll_worker_t* workers = NULL;
+	struct timespec start, end;
+	unsigned int threads = config->_threads;
+	const char* name = NULL;
+	bankroll_kernel_t kernel = config->_scalar ? kernel_scalar : select_kernel(&name);
+	int64_t cash = 0;
+
+	if (make_plan(config, outcomes, &plan) != SUCCESS)
+		return FAIL;
+
+	//blocks split evenly (a block's paths and generators do not depend on the worker running it)
+	uint64_t blocks = (config->_paths + BANKROLL_LANES - 1) / BANKROLL_LANES;
+	if (!threads) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned int)cores : 1;
+	}
+	if (threads > MAX_THREADS) {
+		threads = MAX_THREADS;
+	}
+	if (threads > blocks) {
+		threads = blocks ? (unsigned int)blocks : 1;
+	}
+
+	workers = (Bankroll_worker_t*)calloc(threads, sizeof(Bankroll_worker_t));
+	assert_condition(workers, "Error: function[bankroll_run()]: Failed allocating memory for workers");
+
+	uint64_t block = 0;
+	for (unsigned int i = 0; i < threads; ++i) {
+		uint64_t count = blocks / threads + (i < blocks % threads);
+		workers[i]._plan = &plan;
+		workers[i]._kernel = kernel;
+		workers[i]._first = block * BANKROLL_LANES;
+		block += count;
+		workers[i]._last = block * BANKROLL_LANES < config->_paths ? block * BANKROLL_LANES : config->_paths;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned int i = 0; i < threads; ++i) {
+		if (pthread_create(&workers[i]._thread, NULL, bankroll_worker_run, &workers[i]) != 0) {
+			fprintf(stderr, "Warning: function[bankroll_run()]: Failed creating worker %u. Running it on this thread\n", i);
+			bankroll_worker_run(&workers[i]);
+			workers[i]._thread = 0;
+		}
+	}
+	memset(result, 0, sizeof(Bankroll_result_t));
+	for (unsigned int i = 0; i < threads; ++i) {
+		if (workers[i]._thread)
+			pthread_join(workers[i]._thread, NULL);
+
+		const Bankroll_result_t* from = &workers[i]._result;
+		result->_paths += from->_paths;
+		result->_ruined += from->_ruined;
+		result->_house_broken += from->_house_broken;
+		cash += workers[i]._cash;
+		sketch_merge(&result->_final_cash, &from->_final_cash);
+		sketch_merge(&result->_drawdown, &from->_drawdown);
+		sketch_merge(&result->_ruin_round, &from->_ruin_round);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	result->_seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	result->_mean_cash = result->_paths ? (double)cash / result->_paths / BANKROLL_SCALE : 0.0;
+
+	free(workers);
+	return SUCCESS;
+}
+
+const char* bankroll_kernel(void) {
+	const char* name = "scalar";
+	select_kernel(&name);
+	return name;
+}
+
+//converts the settings and the distribution to fixed point. Returns: FAIL when out of its range.
+static int make_plan(const Bankroll_config_t* config, const Bankroll_outcomes_t* outcomes, Bankroll_plan_t* plan) {
+	double start = config->_bankroll * BANKROLL_SCALE;
+	double bet = config->_bet * BANKROLL_SCALE;
+	double cap = config->_house > 0 ? start + config->_house * BANKROLL_SCALE - 1 : FIXED_MAX;
+	uint64_t cumulative = 0;
+
+	memset(plan, 0, sizeof(Bankroll_plan_t));
+	if (!outcomes->_count || !outcomes->_total) {
+		fprintf(stderr, "Warning: function[bankroll_run()]: Empty outcomes distribution\n");
+		return FAIL;
+	}
+	if (bet < 1 || start < bet || cap > FIXED_MAX || config->_house < 0) {
+		fprintf(stderr, "Warning: function[bankroll_run()]: Bankroll %.2f, bet %.2f, house %.2f. Must be bet > 0, bankroll >= bet, bankroll + house <= %.0f\n",
+			config->_bankroll, config->_bet, config->_house, (double)FIXED_MAX / BANKROLL_SCALE);
+		return FAIL;
+	}
+
+	plan->_outcomes = outcomes->_count;
+	plan->_start = (int32_t)to_fixed(start);
+	plan->_bet = (int32_t)to_fixed(bet);
+	plan->_cap = (int32_t)cap;
+	plan->_rounds = config->_rounds;
+	plan->_seed = config->_seed;
+
+	int64_t last = 0;
+	for (uint32_t k = 0; k < outcomes->_count; ++k) {
+		double pay = outcomes->_net[k] * bet;
+		if (pay > FIXED_MAX_PAY || pay < -FIXED_MAX_PAY) {
+			fprintf(stderr, "Warning: function[bankroll_run()]: A round's pay %.2f. Cannot be over %d either way\n",
+				pay / BANKROLL_SCALE, FIXED_MAX_PAY / BANKROLL_SCALE);
+			return FAIL;
+		}
+		int64_t fixed = to_fixed(pay);
+		if (!k) {
+			plan->_first_pay = (int32_t)fixed;
+		}
+		else {
+			//P(word >= threshold) = P(outcome >= k)
+			double share = (double)cumulative / outcomes->_total * 4294967296.0;
+			plan->_threshold[k] = share >= 4294967295.0 ? 0xFFFFFFFFu : (uint32_t)share;
+			plan->_step[k] = (int32_t)(fixed - last);
+		}
+		last = fixed;
+		cumulative += outcomes->_rounds[k];
+	}
+	return SUCCESS;
+}
+
+//rounds to the nearest fixed point unit (halves away from 0)
+static inline int64_t to_fixed(double amount) {
+	return (int64_t)(amount < 0 ? amount - 0.5 : amount + 0.5);
+}
+
+//The 4 generators of a block: state[word][generator]. Path 2g / 2g + 1 of the block takes the low / high half of
+//generator g's draws.
+static void block_seed(uint64_t seed, uint64_t block, uint64_t state[4][4]) {
+	for (int g = 0; g < 4; ++g) {
+		Rng_t rng;
+		rng_seed(&rng, seed ^ (0x9E3779B97F4A7C15ULL * (block * 4 + g + 1)));
+		for (int w = 0; w < 4; ++w) {
+			state[w][g] = rng._s[w];
+		}
+	}
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+//scalar kernel (the reference)
+static void kernel_scalar(const Bankroll_plan_t* plan, uint64_t block, size_t blocks, Bankroll_paths_t* paths) {
+	for (size_t b = 0; b < blocks; ++b) {
+		uint64_t s[4][4];
+		int32_t cash[BANKROLL_LANES], peak[BANKROLL_LANES], drawdown[BANKROLL_LANES];
+		uint32_t ruin[BANKROLL_LANES];
+		bool alive[BANKROLL_LANES];
+		uint32_t left = BANKROLL_LANES;
+
+		block_seed(plan->_seed, block + b, s);
+		for (int l = 0; l < BANKROLL_LANES; ++l) {
+			cash[l] = peak[l] = plan->_start;
+			drawdown[l] = 0;
+			ruin[l] = 0;
+			alive[l] = true;
+		}
+		for (uint32_t r = 1; r <= plan->_rounds && left; ++r) {
+			uint32_t words[BANKROLL_LANES];
+			for (int g = 0; g < 4; ++g) {
+				const uint64_t word = rotl(s[1][g] * 5, 7) * 9;
+				const uint64_t t = s[1][g] << 17;
+				s[2][g] ^= s[0][g];
+				s[3][g] ^= s[1][g];
+				s[1][g] ^= s[2][g];
+				s[0][g] ^= s[3][g];
+				s[2][g] ^= t;
+				s[3][g] = rotl(s[3][g], 45);
+				words[2 * g] = (uint32_t)word;
+				words[2 * g + 1] = (uint32_t)(word >> 32);
+			}
+			for (int l = 0; l < BANKROLL_LANES; ++l) {
+				if (!alive[l])
+					continue;
+				int32_t pay = plan->_first_pay;
+				for (uint32_t k = 1; k < plan->_outcomes; ++k) {
+					pay += words[l] >= plan->_threshold[k] ? plan->_step[k] : 0;
+				}
+				cash[l] += pay;
+				peak[l] = cash[l] > peak[l] ? cash[l] : peak[l];
+				drawdown[l] = peak[l] - cash[l] > drawdown[l] ? peak[l] - cash[l] : drawdown[l];
+				if (cash[l] < plan->_bet) {
+					ruin[l] = r;
+					alive[l] = false;
+					left--;
+				}
+				else if (cash[l] > plan->_cap) {
+					alive[l] = false;
+					left--;
+				}
+			}
+		}
+		for (int l = 0; l < BANKROLL_LANES; ++l) {
+			paths->_cash[b * BANKROLL_LANES + l] = cash[l];
+			paths->_drawdown[b * BANKROLL_LANES + l] = drawdown[l];
+			paths->_ruin[b * BANKROLL_LANES + l] = ruin[l];
+		}
+	}
+}
+
+#ifdef BANKROLL_X86
+
+//SSE2 kernel: a block as two halves of 4 paths (generators 0-1 and 2-3)
+static void kernel_sse2(const Bankroll_plan_t* plan, uint64_t block, size_t blocks, Bankroll_paths_t* paths) {
+	const __m128i sign = _mm_set1_epi32((int)SIGN_BIT);
+	const __m128i first_pay = _mm_set1_epi32(plan->_first_pay);
+	const __m128i bet = _mm_set1_epi32(plan->_bet);
+	const __m128i cap = _mm_set1_epi32(plan->_cap);
+	__m128i threshold[BANKROLL_MAX_OUTCOMES], step[BANKROLL_MAX_OUTCOMES];
+
+	for (uint32_t k = 1; k < plan->_outcomes; ++k) {
+		threshold[k] = _mm_set1_epi32((int)(plan->_threshold[k] ^ SIGN_BIT));
+		step[k] = _mm_set1_epi32(plan->_step[k]);
+	}
+	for (size_t b = 0; b < blocks; ++b) {
+		uint64_t state[4][4];
+		__m128i s0[2], s1[2], s2[2], s3[2], cash[2], peak[2], drawdown[2], ruin[2], alive[2];
+
+		block_seed(plan->_seed, block + b, state);
+		for (int h = 0; h < 2; ++h) {
+			s0[h] = _mm_loadu_si128((const __m128i*)&state[0][2 * h]);
+			s1[h] = _mm_loadu_si128((const __m128i*)&state[1][2 * h]);
+			s2[h] = _mm_loadu_si128((const __m128i*)&state[2][2 * h]);
+			s3[h] = _mm_loadu_si128((const __m128i*)&state[3][2 * h]);
+			cash[h] = peak[h] = _mm_set1_epi32(plan->_start);
+			drawdown[h] = ruin[h] = _mm_setzero_si128();
+			alive[h] = _mm_set1_epi32(-1);
+		}
+		for (uint32_t r = 1; r <= plan->_rounds; ++r) {
+			const __m128i round = _mm_set1_epi32((int)r);
+			for (int h = 0; h < 2; ++h) {
+				//xoshiro256**: rotl(s1 * 5, 7) * 9, the multiplications as shifts and adds
+				__m128i x5 = _mm_add_epi64(_mm_slli_epi64(s1[h], 2), s1[h]);
+				__m128i rotated = _mm_or_si128(_mm_slli_epi64(x5, 7), _mm_srli_epi64(x5, 57));
+				__m128i word = _mm_add_epi64(_mm_slli_epi64(rotated, 3), rotated);
+				__m128i t = _mm_slli_epi64(s1[h], 17);
+				s2[h] = _mm_xor_si128(s2[h], s0[h]);
+				s3[h] = _mm_xor_si128(s3[h], s1[h]);
+				s1[h] = _mm_xor_si128(s1[h], s2[h]);
+				s0[h] = _mm_xor_si128(s0[h], s3[h]);
+				s2[h] = _mm_xor_si128(s2[h], t);
+				s3[h] = _mm_or_si128(_mm_slli_epi64(s3[h], 45), _mm_srli_epi64(s3[h], 19));
+
+				__m128i u = _mm_xor_si128(word, sign);
+				__m128i pay = first_pay;
+				for (uint32_t k = 1; k < plan->_outcomes; ++k) {
+					pay = _mm_add_epi32(pay, _mm_andnot_si128(_mm_cmpgt_epi32(threshold[k], u), step[k]));
+				}
+				cash[h] = _mm_add_epi32(cash[h], _mm_and_si128(pay, alive[h]));
+				//no signed 32 bits max in SSE2: select by a compare
+				__m128i higher = _mm_cmpgt_epi32(cash[h], peak[h]);
+				peak[h] = _mm_or_si128(_mm_and_si128(higher, cash[h]), _mm_andnot_si128(higher, peak[h]));
+				__m128i drop = _mm_sub_epi32(peak[h], cash[h]);
+				__m128i deeper = _mm_cmpgt_epi32(drop, drawdown[h]);
+				drawdown[h] = _mm_or_si128(_mm_and_si128(deeper, drop), _mm_andnot_si128(deeper, drawdown[h]));
+
+				__m128i ruined = _mm_and_si128(alive[h], _mm_cmpgt_epi32(bet, cash[h]));
+				__m128i broke = _mm_and_si128(alive[h], _mm_cmpgt_epi32(cash[h], cap));
+				ruin[h] = _mm_or_si128(ruin[h], _mm_and_si128(ruined, round));
+				alive[h] = _mm_andnot_si128(_mm_or_si128(ruined, broke), alive[h]);
+			}
+			if (!(r % ALIVE_CHECK) && !_mm_movemask_epi8(_mm_or_si128(alive[0], alive[1])))
+				break;
+		}
+		for (int h = 0; h < 2; ++h) {
+			size_t p = b * BANKROLL_LANES + 4 * h;
+			_mm_storeu_si128((__m128i*)(paths->_cash + p), cash[h]);
+			_mm_storeu_si128((__m128i*)(paths->_drawdown + p), drawdown[h]);
+			_mm_storeu_si128((__m128i*)(paths->_ruin + p), ruin[h]);
+		}
+	}
+}
+
+//AVX2 kernel: a block in one register (generators 0-3)
+__attribute__((target("avx2")))
+static void kernel_avx2(const Bankroll_plan_t* plan, uint64_t block, size_t blocks, Bankroll_paths_t* paths) {
+	const __m256i sign = _mm256_set1_epi32((int)SIGN_BIT);
+	const __m256i first_pay = _mm256_set1_epi32(plan->_first_pay);
+	const __m256i bet = _mm256_set1_epi32(plan->_bet);
+	const __m256i cap = _mm256_set1_epi32(plan->_cap);
+	__m256i threshold[BANKROLL_MAX_OUTCOMES], step[BANKROLL_MAX_OUTCOMES];
+
+	for (uint32_t k = 1; k < plan->_outcomes; ++k) {
+		threshold[k] = _mm256_set1_epi32((int)(plan->_threshold[k] ^ SIGN_BIT));
+		step[k] = _mm256_set1_epi32(plan->_step[k]);
+	}
+	for (size_t b = 0; b < blocks; ++b) {
+		uint64_t state[4][4];
+
+		block_seed(plan->_seed, block + b, state);
+		__m256i s0 = _mm256_loadu_si256((const __m256i*)state[0]);
+		__m256i s1 = _mm256_loadu_si256((const __m256i*)state[1]);
+		__m256i s2 = _mm256_loadu_si256((const __m256i*)state[2]);
+		__m256i s3 = _mm256_loadu_si256((const __m256i*)state[3]);
+		__m256i cash = _mm256_set1_epi32(plan->_start), peak = cash;
+		__m256i drawdown = _mm256_setzero_si256(), ruin = _mm256_setzero_si256();
+		__m256i alive = _mm256_set1_epi32(-1);
+
+		for (uint32_t r = 1; r <= plan->_rounds; ++r) {
+			__m256i x5 = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+			__m256i rotated = _mm256_or_si256(_mm256_slli_epi64(x5, 7), _mm256_srli_epi64(x5, 57));
+			__m256i word = _mm256_add_epi64(_mm256_slli_epi64(rotated, 3), rotated);
+			__m256i t = _mm256_slli_epi64(s1, 17);
+			s2 = _mm256_xor_si256(s2, s0);
+			s3 = _mm256_xor_si256(s3, s1);
+			s1 = _mm256_xor_si256(s1, s2);
+			s0 = _mm256_xor_si256(s0, s3);
+			s2 = _mm256_xor_si256(s2, t);
+			s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+
+			__m256i u = _mm256_xor_si256(word, sign);
+			__m256i pay = first_pay;
+			for (uint32_t k = 1; k < plan->_outcomes; ++k) {
+				pay = _mm256_add_epi32(pay, _mm256_andnot_si256(_mm256_cmpgt_epi32(threshold[k], u), step[k]));
+			}
+			cash = _mm256_add_epi32(cash, _mm256_and_si256(pay, alive));
+			peak = _mm256_max_epi32(peak, cash);
+			drawdown = _mm256_max_epi32(drawdown, _mm256_sub_epi32(peak, cash));
+
+			__m256i ruined = _mm256_and_si256(alive, _mm256_cmpgt_epi32(bet, cash));
+			__m256i broke = _mm256_and_si256(alive, _mm256_cmpgt_epi32(cash, cap));
+			ruin = _mm256_or_si256(ruin, _mm256_and_si256(ruined, _mm256_set1_epi32((int)r)));
+			alive = _mm256_andnot_si256(_mm256_or_si256(ruined, broke), alive);
+			if (!(r % ALIVE_CHECK) && _mm256_testz_si256(alive, alive))
+				break;
+		}
+		size_t p = b * BANKROLL_LANES;
+		_mm256_storeu_si256((__m256i*)(paths->_cash + p), cash);
+		_mm256_storeu_si256((__m256i*)(paths->_drawdown + p), drawdown);
+		_mm256_storeu_si256((__m256i*)(paths->_ruin + p), ruin);
+	}
+}
+
+#endif //BANKROLL_X86
+
+//picks the widest kernel the CPU supports
+static bankroll_kernel_t select_kernel(const char** name) {
+#ifdef BANKROLL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		*name = "avx2";
+		return kernel_avx2;
+	}
+	*name = "sse2";
+	return kernel_sse2;
+#else
+	*name = "scalar";
+	return kernel_scalar;
+#endif
+}
+
+static void* bankroll_worker_run(void* arg) {
+	Bankroll_worker_t* worker = (Bankroll_worker_t*)arg;
+	const Bankroll_plan_t* plan = worker->_plan;
+	Bankroll_result_t* result = &worker->_result;
+	Bankroll_paths_t* paths = &worker->_paths;
+
+	for (uint64_t first = worker->_first; first < worker->_last; first += BANKROLL_BATCH) {
+		size_t count = worker->_last - first < BANKROLL_BATCH ? (size_t)(worker->_last - first) : BANKROLL_BATCH;
+
+		//the last block may be partial: its padding paths are evolved but not counted
+		worker->_kernel(plan, first / BANKROLL_LANES, (count + BANKROLL_LANES - 1) / BANKROLL_LANES, paths);
+		for (size_t p = 0; p < count; ++p) {
+			int32_t cash = paths->_cash[p];
+			result->_paths++;
+			worker->_cash += cash;
+			if (paths->_ruin[p]) {
+				result->_ruined++;
+				sketch_add(&result->_ruin_round, paths->_ruin[p]);
+			}
+			else if (cash > plan->_cap) {
+				result->_house_broken++;
+			}
+			sketch_add(&result->_final_cash, cash > 0 ? (uint32_t)cash : 0);
+			sketch_add(&result->_drawdown, (uint32_t)paths->_drawdown[p]);
+		}
+	}
+	return NULL;
+}
+
+//measured rounds' default player: hits below 17
+static char measure_hit_below(Player_t* player, Player_t* dealer, void* ctx) {
+	(void)dealer;
+	(void)ctx;
+	return player->_hand._value < MEASURE_HIT_BELOW ? 'H' : 'S';
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the bankroll (risk of ruin) simulator: many independent bankrolls betting flat, round after
+ *              round, each round's result drawn from a measured distribution of round outcomes.
+ *              Paths are kept as structure of arrays and evolved 8 at a time by SSE2/AVX2 kernels chosen at runtime
+ *              by the CPU (and a scalar fallback), in fixed point (BANKROLL_SCALE units per cash unit) integers.
+ *              Every 8 paths draw from their own generators (seeded by the seed and their index), so the results
+ *              do not depend on the kernel or on the threads count.
+ *              A path ends when its cash is below the bet (ruin) or above the house budget (the house is broken),
+ *              and only its summary is kept: the final cash, drawdown and ruin round go to streaming quantile
+ *              sketches (see Sketch.h), so the memory does not grow with the paths.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include "Black_Jack.h"
+#include "Rules.h"
+#include "Sketch.h"
+
+#define BANKROLL_SCALE 100          //fixed point: cents
+#define BANKROLL_MAX_OUTCOMES 32
+#define BANKROLL_LANES 8            //paths evolved together (one block)
+#define BANKROLL_BATCH 4096         //paths of a worker kept in arrays at once
+
+//A distribution of a round's net result, in bets (e.g. -1 lose, 0 push, 1.5 natural), sorted by net
+typedef struct Bankroll_outcomes {
+	uint32_t _count;
+	double _net[BANKROLL_MAX_OUTCOMES];
+	uint64_t _rounds[BANKROLL_MAX_OUTCOMES]; //rounds ending with each net
+	uint64_t _total;
+}Bankroll_outcomes_t;
+
+//bankroll_run() settings. Cash amounts are in cash units ($).
+typedef struct Bankroll_config {
+	uint64_t _paths;
+	uint32_t _rounds;            //rounds per path (at most)
+	double _bankroll;            //the player's cash at start
+	double _bet;                 //flat bet of every round (the table's minimum bet): a path is ruined below it
+	double _house;               //house budget: a path is over when it won all of it (0: no limit but the fixed point
+	                             //range, about 10 million)
+	unsigned int _threads;       //0: all the online cores
+	uint64_t _seed;
+	bool _scalar;                //runs the scalar kernel (the reference of the vector kernels)
+}Bankroll_config_t;
+
+typedef struct Bankroll_result {
+	uint64_t _paths;
+	uint64_t _ruined;            //paths whose cash fell below the bet
+	uint64_t _house_broken;      //paths that won the house budget
+	double _mean_cash;           //final cash, cash units
+	double _seconds;
+	Sketch_t _final_cash;        //in fixed point units
+	Sketch_t _drawdown;          //largest drop of the cash from its peak, in fixed point units
+	Sketch_t _ruin_round;        //rounds played until the ruin (ruined paths only)
+}Bankroll_result_t;
+
+//Counts a round ending with 'net' bets. Returns: FAIL when the distribution has BANKROLL_MAX_OUTCOMES nets already.
+int bankroll_outcomes_add(Bankroll_outcomes_t* outcomes, double net);
+
+//Measures the table game's outcomes (the house rules of Black_Jack.c): 'rounds' headless rounds of a table seeded
+//by 'seed', asking 'decide' (NULL: hit below 17). Returns: FAIL in case of fail, otherwise SUCCESS.
+int bankroll_game_outcomes(Bankroll_outcomes_t* outcomes, uint64_t rounds, uint64_t seed, hit_stand_decision decide, void* ctx);
+
+//Measures a rule variant's outcomes (see Rules.h): 'rounds' basic strategy rounds of a 'decks' decks shoe.
+//Returns: FAIL in case of fail, otherwise SUCCESS.
+int bankroll_rules_outcomes(Bankroll_outcomes_t* outcomes, const Rules_t* rules, uint64_t rounds, uint64_t seed, uint8_t decks);
+
+//Player's expected net per round, in bets
+double bankroll_outcomes_mean(const Bankroll_outcomes_t* outcomes);
+
+//Evolves the configured paths under the outcomes distribution, split between worker threads.
+//Results are written to 'result' (reset first). The same config and outcomes always give the same results.
+//Returns: FAIL for invalid settings (e.g. amounts out of the fixed point range), otherwise SUCCESS.
+int bankroll_run(const Bankroll_config_t* config, const Bankroll_outcomes_t* outcomes, Bankroll_result_t* result);
+
+//Name of the kernel bankroll_run() runs on this CPU: "avx2", "sse2" or "scalar"
+const char* bankroll_kernel(void);
@@ -1,6 +1,6 @@
 /*
  * Author: Noga Avraham
- * Description: .cpp Implementation of the "Black Jack" game (using generelized void* data storing Single Linked List).
+ * Description: .cpp Implementation of the "Black Jack" game (hands are typed, inline cards lists: see Typed_list.h).
                 [Real-Time Group C course project]
  * Language:  C
  * Date: July 2021
@@ -11,51 +11,39 @@
 #include<string.h>
 #include <ctype.h>
 #include<stdlib.h>
-#include<time.h>//srand()
+#include<stdarg.h>//va_list
+#include<time.h>//time() seeds the table's generator
 #include<math.h>
-#include"SLL.h" //for SLL's: Deck, player_hand and dealer_hand
+#include"Shoe.h" //for the Deck
+#include"Cards.h" //cards lookup tables
+#include"Exact_ev.h" //hit or stand hints
+#include"Stats.h" //phases instrumentation (-DBJ_STATS)
+#include"Render.h" //all the game output
+#include"History.h" //rounds log
+#include"Columns.h" //rounds export
+#include"Rules.h" //the game's rules constants
 #include "Black_Jack.h"
 
 
 #define MIN_CASH 1000
 #define HOUSE_CASH_LIMIT 1000 //multiplier of MIN_CASH for house max cash budget (Note for tester: I added this limitation)
-#define DECK_SIZE 52
-#define CARDS_IN_SET 13
-#define BLACK_JACK 21
-#define MAX_NAME_LEN 15
+#define DECK_SIZE CARDS_COUNT
+#define DEFAULT_DECKS 1
+#define MAX_DECKS 8
+#define DEFAULT_PENETRATION 0.75 //part of the shoe dealt before it is reshuffled
 #define ATTEMPTS 3
+#define INPUT_LINE_LEN 256 //play(): an answer line
 
 
 enum check_card_states{ RESET_CARDS=1, LOOSE_BET, CONTINUE_BET};
-enum game_states{STOP_GAME, CONTINEU_GAME, CONTINEU_HIT};
+enum game_states{STOP_GAME = ROUND_STOP, CONTINEU_GAME = ROUND_OVER, CONTINEU_HIT = ROUND_PLAYER_TURN};
 
 //GLOBALS
-static const char* suits[] = { "SPADES", "HEARTS", "CLUBS", "DIAMONDS" };
-static const char* cards_symbols[CARDS_IN_SET] = { "Ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "Jack", "Queen", "King" };
-
-//suit_rank[] values are pointed to by SLL nodes (by void *data). This array is built once at game_init() and doesn't change after.
-static uint8_t suit_rank[DECK_SIZE] = { 0 };// [1:0] bits kept for card suit.  [5:2] bits kept for card rank. [6-7] empty
+//Cards are bytes in the suit_rank encoding (see Cards.h). The hands hold them by value (Card_list_t),
+//and the deck Shoe is filled from the constant card_codes[] table.
 static const char currency = '$';
-static unsigned int moves_counter = 0;
-
-//STRUCTS
-typedef struct Person{
-	char _name[MAX_NAME_LEN];
-	int32_t _id;
-}Person_t;
-
-typedef struct Account {
-	int32_t _cash;
-	uint32_t _bet;
-}Account_t;
-
-typedef struct Player {
-	Person_t _info; //'Dealer' _info.id = 0
-	Account_t _account;
-	List* _cards;
-}Player_t;
-
-//This struct is used as args to sum() pointer function 
+
+//This struct is used as args to sum() pointer function
 typedef struct sum_args {
 	uint32_t sum;
 	uint8_t aces;
@@ -65,316 +53,615 @@ typedef struct sum_args {
 //STATIC PROTOTYPES - to be used internaly only by this .cpp file
 //-----------------
 //initialization functions:
-static int play();
-static void game_init(List** dealer_hand, List** player_hand, List** deck);
-static int cach_deposit_request(Player* player);
-static void build_deck(List* deck);
+static void game_init(Shoe_t** deck, Rng_t* rng);
+static Shoe_t* build_shoe(uint8_t decks, double penetration, Rng_t* rng);
+
+//interactive game functions (a question suspends the game, see game_input()):
+static int game_ask(Table_t* table, int8_t wait, const char* format, ...);
+static int cach_deposit_request(Table_t* table, int8_t wait);
+static int game_round(Table_t* table);
+static int game_bet(Table_t* table);
+static int game_step(Table_t* table, int step);
+static int game_end(Table_t* table, int8_t end);
 
 //print functions:
-static const char* extract_suit(uint8_t *card);
-static const char* extract_rank(uint8_t* card);
-static void display_cards(Player* player, size_t start_pos, size_t end_pos);
-void print_card(void* card);
-static void print_winner_loser(Player_t* loser, Player_t* winner);
+static void table_print(Table_t* table, const char* format, ...);
+static void table_prompt(Table_t* table, const char* format, ...);
+static void display_cards(Table_t* table, Player_t* player, size_t start_pos, size_t end_pos);
+static void display_hand(Table_t* table, Player_t* player);
+static void print_winner_loser(Table_t* table, Player_t* loser, Player_t* winner);
+static void print_round_summary(Table_t* table);
 
 //game phases functions:
-static int bet(Player_t* player, Player_t* dealer);
-static int deal(Player_t* dealer, Player_t* player, List* deck);
-static int hit_or_stand(Player_t* dealer, Player_t* player, List* deck);
-static int random_draw(List* deck, Player_t* player, size_t count, bool display);
-static bool reset_cards(Player_t* dealer, Player_t* player, List* deck);
+static void round_open(Table_t* table);
+static int round_deal(Table_t* table, int betting);
+static int round_step(Table_t* table, int step);
+static int bet(Table_t* table);
+static void bet_open(Table_t* table);
+static int bet_allowed(Table_t* table);
+static int bet_answer(Table_t* table, const char* line);
+static int deal(Table_t* table);
+static void hit_or_stand_begin(Table_t* table);
+static int hit_or_stand(Table_t* table);
+static int hit_or_stand_play(Table_t* table, char hit_stand);
+static bool dealer_draw(Table_t* table);
+static int random_draw(Table_t* table, Player_t* player, size_t count, bool display);
+static bool reset_cards(Table_t* table);
 
 //handler functions:
-static void win_lose_transactions(Player_t* loser, Player_t* winner, double transact_multiplier);
-static uint32_t calculate_hand_val(List* cards);
-static int player_cards_check(Player_t* player, Player_t* dealer);
-static void clear_input(void);
+static void win_lose_transactions(Table_t* table, Player_t* loser, Player_t* winner, double transact_multiplier);
+static int player_cards_check(Table_t* table);
+static char pending_hit_stand(Player_t* player, Player_t* dealer, void* ctx);
 
 //free resources
-static void clearAll(Player_t* player, Player_t* dealer, List* deck);
+static void clearAll(Player_t* player, Player_t* dealer, Shoe_t* deck);
 //error prints and exit
 static void assert_condition(bool isValid, const char* errorMsg, bool isFatal);
 
 
 
-//This is the only function exposed to player/main in header.
+//This is the only function exposed to player/main in header: the game of game_start(), answered from stdin.
 //Returns: FAIL (-1 int), otherwise returns SUCCESS (0).
 int play() {
 
-	Player_t dealer = { {"Dealer", 0}, {MIN_CASH * HOUSE_CASH_LIMIT, 0}, NULL };
-	Player_t player = { 0 };
-	List* deck = NULL;
-	bool new_round = true;
-	int hit_stand = { 0 };
-	uint8_t attempts = ATTEMPTS;
+	Table_t table = { 0 };
+	char line[INPUT_LINE_LEN];
+	int wait = GAME_FAILED;
+
+	table_init(&table, false);
+
+	wait = game_start(&table);
+	while (wait > GAME_OVER) {
+		wait = game_input(&table, fgets(line, sizeof(line), stdin)); //NULL at the end of the input
+	}
+
+	//free resources (the last output is flushed)
+	table_clear(&table);
+
+	return wait == GAME_OVER ? SUCCESS : FAIL;
+}
+
+int game_start(Table_t* table) {
+	assert_condition(table, "Error: function[game_start()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	printf("\nWellcome to the 'Black-Jack' betting game!\n"
+	return game_ask(table, GAME_NAME, "\nWellcome to the 'Black-Jack' betting game!\n"
 		"******************************************\n"
 		"Enter your name : ");
+}
 
-	//player can put any name or nick-name he chooses (all chars are valid)
-	fgets(player._info._name, MAX_NAME_LEN, stdin);
-	player._info._name[strcspn(player._info._name, "\n")] = '\0';
+//Answers the pending question. Invalid answers ask it again (ID, deposit and bet: ATTEMPTS answers at most).
+int game_input(Table_t* table, const char* line) {
+	assert_condition(table, "Error: function[game_input()]: pointer provided to argument 'table' is Null. exitting", true);
+
+	Player_t* player = &table->_player;
+	Account_t* account = &player->_account;
+	size_t len = line ? strcspn(line, "\r\n") : 0;
+	char answer = len ? (char)toupper((unsigned char)line[0]) : '\0';
+
+	if (table->_wait <= GAME_OVER)
+		return table->_wait;
+	if (!line) //no more answers: a game that got to the rounds is over, otherwise it failed
+		return game_end(table, table->_wait >= GAME_NO_CASH ? GAME_OVER : GAME_FAILED);
+
+	switch (table->_wait) {
+
+	case GAME_NAME:
+		//player can put any name or nick-name he chooses (all chars are valid)
+		len = len < MAX_NAME_LEN - 1 ? len : MAX_NAME_LEN - 1;
+		memcpy(player->_info._name, line, len);
+		player->_info._name[len] = '\0';
+		return game_ask(table, GAME_ID, "%s, Enter your ID : ", player->_info._name);
+
+	case GAME_ID: {
+		//id 0 reserved to the dealer. id cannot be negative
+		unsigned long id = strtoul(line, NULL, 10);
+
+		if (id && id <= INT32_MAX && line[strspn(line, " \t")] != '-') {
+			player->_info._id = (int32_t)id;
+			return game_ask(table, GAME_HINTS, "%s, Would you like hints (the exact odds of hitting and standing)? [Y/N]\n",
+				player->_info._name);
+		}
+		//Invalid input of alphabet chars can also result in invalid 0
+		table_prompt(table, "ID must contain digits only, and not 0. Try again\n");
+		if (--table->_attempts)
+			return game_ask(table, GAME_ID, "%s, Enter your ID : ", player->_info._name);
+		table_prompt(table, "%s, Your %d attempts to input valid ID failed. Please see Cazino manager.\n", player->_info._name, ATTEMPTS);
+		return game_end(table, GAME_FAILED);
+	}
 
-	//id 0 reserved to the dealer. id cannot be negative
-	while (player._info._id <= 0 && attempts) {
-		printf("%s, Enter your ID : ", player._info._name);
-		scanf("%u", &player._info._id);
-		--attempts;
+	case GAME_HINTS:
+		if (answer == 'Y') {
+			table->_hints = create_ev_cache(0);
+		}
+		return cach_deposit_request(table, GAME_DEPOSIT);
 
-		//Invalid input of alphabet chars can also result in invalid 0
-		if (player._info._id == 0) {
-			printf("ID must contain digits only, and not 0. Try again\n");
+	case GAME_DEPOSIT:
+	case GAME_REDEPOSIT: {
+		long cash = strtol(line, NULL, 10);
+
+		//check valid input amount(cash must be at least 1,000, in 10's)
+		if (cash > 0 && cash <= (long)INT32_MAX - account->_cash && account->_cash + cash >= MIN_CASH && cash % 10 == 0) {
+			account->_cash += (int32_t)cash;
+			return table->_wait == GAME_DEPOSIT ? game_round(table) : game_bet(table);
 		}
-		clear_input();
+		if (--table->_attempts)
+			return game_ask(table, table->_wait, "Invalid input. No deposit occured. Try again:\n");
+		table_prompt(table, "%s, Your %d attempts to deposit cash have failed. Please see Cazino manager\n", player->_info._name, ATTEMPTS);
+		return game_end(table, table->_wait == GAME_DEPOSIT ? GAME_FAILED : GAME_OVER);
+	}
+
+	case GAME_NO_CASH:
+		if (answer == 'Y')
+			return cach_deposit_request(table, GAME_REDEPOSIT);
+		if (answer == 'N')
+			return game_step(table, round_deal(table, STOP_GAME));
+		return game_bet(table);
+
+	case GAME_BET: {
+		if (STATS_TIMED(PHASE_BET, bet_answer(table, line)) == SUCCESS)
+			return game_step(table, round_deal(table, SUCCESS));
+		table_prompt(table, "Invalid input. No bet adding occured.\n");
+		if (--table->_attempts)
+			return game_ask(table, GAME_BET, "Try again: ");
+		table_print(table, "%s, you failed to add bet. Game ends.\n", player->_info._name);
+		return game_step(table, round_deal(table, FAIL));
+	}
+
+	case GAME_HIT_STAND:
+		if (answer != 'H' && answer != 'S')
+			return game_ask(table, GAME_HIT_STAND, "Enter 'H' (to hit) or 'S' (to stand): ");
+		table->_action = answer;
+		return game_step(table, round_step(table, STATS_TIMED(PHASE_HIT_STAND, hit_or_stand_play(table, answer))));
+
+	case GAME_AGAIN:
+		if (answer == 'Y')
+			return game_round(table);
+		if (answer == 'N')
+			return game_end(table, GAME_OVER);
+		return game_ask(table, GAME_AGAIN, "%s, Would you like to bet again? [Y/N]\n", player->_info._name);
+	}
+	return table->_wait;
+}
+
+//Asks the question and suspends the game on it (asking the same question again keeps its attempts count)
+static int game_ask(Table_t* table, int8_t wait, const char* format, ...) {
+	if (table->_wait != wait) {
+		table->_attempts = ATTEMPTS;
 	}
-	if (!attempts) {
-		printf("%s, Your %d attempts to input valid ID failed. Please see Cazino manager.\n", player._info._name, ATTEMPTS);
-		return FAIL;
+	table->_wait = wait;
+	if (table->_render) {
+		va_list args;
+		va_start(args, format);
+		render_vprintf(table->_render, format, args);
+		va_end(args);
+		render_flush(table->_render);
 	}
+	return wait;
+}
 
-	if (cach_deposit_request(&player) == STOP_GAME)
-		return FAIL;
+//A new round, up to its bet question (Betting phase)
+static int game_round(Table_t* table) {
+	round_open(table);
+	bet_open(table);
+	return game_bet(table);
+}
 
-	game_init(&dealer._cards, &player._cards, &deck);
+//The Betting phase questions: a deposit when there is no cash left, otherwise the bet
+static int game_bet(Table_t* table) {
+	Player_t* player = &table->_player;
 
-	while (new_round) {
+	if (player->_account._cash == 0)
+		return game_ask(table, GAME_NO_CASH, "%s, you have no cash left on your account.\n"
+			"Would you like to deposit to cash and continue betting? [Y/N]\n", player->_info._name);
+	if (bet_allowed(table) != SUCCESS)
+		return game_step(table, round_deal(table, FAIL));
 
-		if (bet(&player, &dealer) != SUCCESS) //Betting phase 
-			break;
+	return game_ask(table, GAME_BET, "%s, How much to add to your BET?\n"
+		"Your current bet is: %u%c   [Your current cash: %d%c]. (Add in multiples of 10 only.)\n"
+		, player->_info._name, player->_account._bet, currency, player->_account._cash, currency);
+}
 
-		if (deal(&dealer, &player, deck) != SUCCESS) //Initial Deal phase 
-			break;
+//The question that follows a round's step
+static int game_step(Table_t* table, int step) {
+	switch (step) {
+	case ROUND_PLAYER_TURN:
+		hit_or_stand_begin(table);
+		return game_ask(table, GAME_HIT_STAND, "Enter 'H' (to hit) or 'S' (to stand): ");
+	case ROUND_OVER:
+		return game_ask(table, GAME_AGAIN, "%s, Would you like to bet again? [Y/N]\n", table->_player._info._name);
+	default:
+		return game_end(table, GAME_OVER);
+	}
+}
 
-		switch (player_cards_check(&player, &dealer)) { //Black Jack phase
+static int game_end(Table_t* table, int8_t end) {
+	if (end == GAME_OVER) {
+		table_print(table, "\nGAME-OVER\n");
+	}
+	render_flush(table->_render);
+	table->_wait = end;
+	return end;
+}
 
-		case RESET_CARDS:
-			new_round = reset_cards(&dealer, &player, deck);
-			break;
-		case LOOSE_BET:
-			win_lose_transactions(&player, &dealer, 1);
-			new_round = false;
-			break;
-		case CONTINUE_BET:
-			do {
-				hit_stand = hit_or_stand(&dealer, &player, deck);  //Hit or Stand phase
-			} while (hit_stand == CONTINEU_HIT);
+void table_init(Table_t* table, bool headless) {
+	table_init_seeded(table, headless, (uint64_t)time(NULL));
+}
 
-			new_round = hit_stand;//hit_stand 1(true) or 0(false)
-			break;
-		}
-		moves_counter = 0;
+void table_init_seeded(Table_t* table, bool headless, uint64_t seed) {
+	Rng_t rng;
+
+	rng_seed(&rng, seed);
+	table_init_rng(table, headless, &rng);
+}
+
+void table_init_rng(Table_t* table, bool headless, const Rng_t* rng) {
+	assert_condition(table, "Error: function[table_init_rng()]: pointer provided to argument 'table' is Null. exitting", true);
+	assert_condition(rng, "Error: function[table_init_rng()]: pointer provided to argument 'rng' is Null. exitting", true);
+
+	Player_t dealer = { {"Dealer", 0}, {MIN_CASH * HOUSE_CASH_LIMIT, 0}, {0} };
+
+	memset(table, 0, sizeof(Table_t));
+	table->_dealer = dealer;
+	table->_headless = headless;
+	table->_render = headless ? NULL : create_render(RENDER_FULL, stdout);
+	table->_decide = pending_hit_stand; //the answer round_turn() is resumed with, unless replaced by a strategy
+	table->_decide_ctx = table;
+	table->_rng = *rng;
+	game_init(&table->_deck, &table->_rng);
+}
+
+void table_clear(Table_t* table) {
+	assert_condition(table, "Error: function[table_clear()]: pointer provided to argument 'table' is Null. exitting", true);
+
+	clearAll(&table->_player, &table->_dealer, table->_deck);
+	clear_ev_cache(table->_hints);
+	clear_render(table->_render);
+	table->_deck = NULL;
+	table->_hints = NULL;
+	table->_render = NULL;
+}
+
+void table_set_render(Table_t* table, enum render_level level, FILE* out) {
+	assert_condition(table, "Error: function[table_set_render()]: pointer provided to argument 'table' is Null. exitting", true);
+	assert_condition(out, "Error: function[table_set_render()]: pointer provided to argument 'out' is Null. exitting", true);
+
+	clear_render(table->_render);
+	table->_render = create_render(level, out);
+}
+
+//returns: true- continue to next round, false- stop game.
+bool play_round(Table_t* table) {
+	assert_condition(table, "Error: function[play_round()]: pointer provided to argument 'table' is Null. exitting", true);
 
+	int step = round_begin(table);
+
+	while (step == ROUND_PLAYER_TURN) {
+		step = round_turn(table);  //Hit or Stand phase
 	}
+	return step == ROUND_OVER;
+}
 
-	//free resources
-	clearAll(&player, &dealer, deck);
-	printf("\nGAME-OVER\n");
+//returns: ROUND_STOP/ROUND_OVER/ROUND_PLAYER_TURN (the game_states values)
+int round_begin(Table_t* table) {
+	assert_condition(table, "Error: function[round_begin()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	return SUCCESS;
+	round_open(table);
+	return round_deal(table, STATS_TIMED(PHASE_BET, bet(table)));
 }
 
-//This function is sent to SSL 'print_list()' as pointer to printing function.
-void print_card(void *card) {
-	const char* suit = extract_suit((uint8_t*)card);
-	const char* rank = extract_rank((uint8_t*)card);
-	printf(" [%s of %s] ", rank, suit);
+//returns: ROUND_STOP/ROUND_OVER/ROUND_PLAYER_TURN (the game_states values)
+int round_turn(Table_t* table) {
+	assert_condition(table, "Error: function[round_turn()]: pointer provided to argument 'table' is Null. exitting", true);
+
+	return round_step(table, STATS_TIMED(PHASE_HIT_STAND, hit_or_stand(table)));
 }
 
-static void display_cards(Player* player, size_t start_pos, size_t end_pos){
-	assert_condition(player, "Error: function[display_cards()]: pointer provided to argument 'player' is Null. exitting", true);
+static void round_open(Table_t* table) {
+	table->_outcome = OUTCOME_NONE;
+	table->_black_jack = table->_player_bust = table->_dealer_bust = table->_stood = false;
+	STATS_COUNT(STATS_ROUNDS, 1);
+}
+
+//The round once its Betting phase is done ('betting' is its result): Initial Deal and Black Jack check phases.
+//returns: ROUND_STOP/ROUND_OVER/ROUND_PLAYER_TURN (the game_states values)
+static int round_deal(Table_t* table, int betting) {
+	int step = ROUND_STOP;
+
+	if (betting == SUCCESS && table->_history) {
+		history_round_begin(table->_history, table); //the stake is on the table
+	}
+	if (betting == SUCCESS && table->_columns) {
+		columns_round_begin(table->_columns, table);
+	}
+	if (betting != SUCCESS || STATS_TIMED(PHASE_DEAL, deal(table)) != SUCCESS) { //Initial Deal phase
+		table->_moves_counter = 0;
+		render_flush(table->_render);
+		return ROUND_STOP;
+	}
+
+	switch (STATS_TIMED(PHASE_BLACK_JACK, player_cards_check(table))) { //Black Jack phase
+
+	case RESET_CARDS:
+		step = STATS_TIMED(PHASE_RESET, reset_cards(table));
+		break;
+	case LOOSE_BET:
+		win_lose_transactions(table, &table->_player, &table->_dealer, 1);
+		step = STOP_GAME;
+		break;
+	case CONTINUE_BET:
+		return ROUND_PLAYER_TURN;
+	}
+	return round_step(table, step);
+}
 
-	   printf("   %-*s", MAX_NAME_LEN, player->_info._name);
-       print_list_by_range(player->_cards, start_pos, end_pos, print_card);
+//The round's step after one of its phases. The output is flushed once the round is over.
+static int round_step(Table_t* table, int step) {
+	if (step != CONTINEU_HIT) {
+		table->_moves_counter = 0;
+		render_flush(table->_render); //once per round
+	}
+	return step;
 }
 
-static const char* extract_suit(uint8_t *card) {
-	assert_condition(card, "Error: function[extract_suit()]: pointer provided to argument 'card' is Null. exitting", true);
+//Output point of the game phases transcript (RENDER_FULL). Nothing is formatted below that level.
+static void table_print(Table_t* table, const char* format, ...) {
+	if (!render_on(table->_render, RENDER_FULL))
+		return;
 
-	return suits[(*card) & 0x03];
+	va_list args;
+	va_start(args, format);
+	render_vprintf(table->_render, format, args);
+	va_end(args);
 }
-static const char* extract_rank(uint8_t *card) {
-	return cards_symbols[((*card) >> 2)];
+
+//Output point of the interactive questions: the transcript so far is flushed, and the question shown right away
+//(whatever the verbosity level), since the answer is awaited next. A silent table asks no one.
+static void table_prompt(Table_t* table, const char* format, ...) {
+	if (!table->_render)
+		return;
+
+	va_list args;
+	va_start(args, format);
+	render_vprintf(table->_render, format, args);
+	va_end(args);
+	render_flush(table->_render);
 }
 
+static void display_cards(Table_t* table, Player_t* player, size_t start_pos, size_t end_pos){
+	assert_condition(player, "Error: function[display_cards()]: pointer provided to argument 'player' is Null. exitting", true);
 
-static void build_deck(List* deck) {
-	assert_condition(deck, "Error: function[build_deck()]: pointer to 'deck' list is Null. exitting", true);
+	render_printf(table->_render, "   %-*s", MAX_NAME_LEN, player->_info._name);
+	render_cards(table->_render, &player->_cards, start_pos, end_pos);
+}
 
-	uint8_t cards_sets = DECK_SIZE / CARDS_IN_SET; //default: 4
-	uint8_t index = 0;
+//the whole hand, and a new line
+static void display_hand(Table_t* table, Player_t* player) {
+	render_cards(table->_render, &player->_cards, 1, player->_cards._count);
+	render_text(table->_render, "\n", 1);
+}
 
-	for (uint8_t i = 0; i < cards_sets; ++i) {
-		for (uint8_t j = 0; j < CARDS_IN_SET; ++j) {
-			index = i * CARDS_IN_SET + j;
-			suit_rank[index] |= i;
-			suit_rank[index] |= (j<<2);
+static Shoe_t* build_shoe(uint8_t decks, double penetration, Rng_t* rng) {
+	Shoe_t* deck = create_shoe((size_t)decks * DECK_SIZE, rng);
 
-			add_to_back(deck, create_node((void*)&suit_rank[index]));
-		}
+	for (uint8_t i = 0; i < decks; ++i) {
+		fill_shoe(deck, card_codes, DECK_SIZE);
 	}
+	shuffle_shoe(deck);
+	set_shoe_penetration(deck, penetration);
+	return deck;
 }
 
-static void game_init(List** dealer_hand, List** player_hand, List** deck) {
-	assert_condition(dealer_hand, "Error: function[game_init()]: pointer provided to argument 'dealer_hand**' is Null. exitting", true);
-	assert_condition(player_hand, "Error: function[game_init()]: pointer provided to argument 'player_hand**' is Null. exitting", true);
-	assert_condition(deck, "Error: function[game_init()]: pointer provided to argument 'deck**' is Null. exitting", true);
+int table_set_shoe(Table_t* table, uint8_t decks, double penetration) {
+	assert_condition(table, "Error: function[table_set_shoe()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	srand((unsigned int)time(NULL));//used in random_draw()
+	if (decks < 1 || decks > MAX_DECKS || penetration <= 0 || penetration > 1) {
+		fprintf(stderr, "Warning: function[table_set_shoe()]: %u decks, penetration %.2f. Must be 1-%d decks, penetration (0-1]\n", decks, penetration, MAX_DECKS);
+		return FAIL;
+	}
+	if (table->_player._cards._count || table->_dealer._cards._count) {
+		fprintf(stderr, "Warning: function[table_set_shoe()]: Cannot replace the shoe in the middle of a round\n");
+		return FAIL;
+	}
+	clear_shoe(table->_deck);
+	table->_deck = build_shoe(decks, penetration, &table->_rng);
+	return SUCCESS;
+}
 
-	*deck = create_list();
-	build_deck(*deck);
+static void game_init(Shoe_t** deck, Rng_t* rng) {
+	assert_condition(deck, "Error: function[game_init()]: pointer provided to argument 'deck**' is Null. exitting", true);
 
-	*dealer_hand = create_list();
-	*player_hand = create_list();
+	//the hands are zeroed (empty) lists inside the table: no heap calls are made after game_init()
+	*deck = build_shoe(DEFAULT_DECKS, DEFAULT_PENETRATION, rng);
 }
 
-static void print_winner_loser(Player_t* loser, Player_t* winner) {
+static void print_winner_loser(Table_t* table, Player_t* loser, Player_t* winner) {
 	assert_condition(loser, "Error: function[print_winner_loser()]: pointer provided to argument 'loser' is Null. exitting", true);
 	assert_condition(winner, "Error: function[print_winner_loser()]: pointer provided to argument 'winner' is Null. exitting", true);
 
-	uint32_t winner_result = calculate_hand_val(winner->_cards);
-	printf("\n     $ $ $ $ $ $ $ $\n"
+	uint32_t winner_result = winner->_hand._value;
+	table_print(table, "\n     $ $ $ $ $ $ $ $\n"
 		   "#%u) |WIN LOSE status|:\n"
 		   "     $ $ $ $ $ $ $ $\n"
-	       "-------------------------------------\n", ++moves_counter);
+	       "-------------------------------------\n", ++table->_moves_counter);
 
-	printf("%s WINS with cards: ", winner->_info._name);
-	print_list(winner->_cards, print_card);
+	table_print(table, "%s WINS with cards: ", winner->_info._name);
+	display_hand(table, winner);
 	if(winner_result == 21)
-		printf("Cards value: 21 BLACK JACK !!!\n");
+		table_print(table, "Cards value: 21 BLACK JACK !!!\n");
 	else {
-		printf("Cards value: %u\n", winner_result);
+		table_print(table, "Cards value: %u\n", winner_result);
 	}
-	printf("\n%s LOSES with cards: ", loser->_info._name);
-	print_list(loser->_cards, print_card);
-	printf("Cards value: %u\n", calculate_hand_val(loser->_cards));
+	table_print(table, "\n%s LOSES with cards: ", loser->_info._name);
+	display_hand(table, loser);
+	table_print(table, "Cards value: %u\n", loser->_hand._value);
 }
 
-//Transacting money from the loser's account to the winner's account, 
+//RENDER_SUMMARY only (the full transcript has it all): the round's hands, result and cash, on a single line
+static void print_round_summary(Table_t* table) {
+	static const char* const outcome_name[] = { "-", "WIN", "LOSE", "TIE" };
+	Render_t* render = table->_render;
+
+	if (!render || render->_level != RENDER_SUMMARY)
+		return;
+	render_printf(render, "%s:", table->_player._info._name);
+	render_cards(render, &table->_player._cards, 1, table->_player._cards._count);
+	render_printf(render, "= %u | Dealer:", table->_player._hand._value);
+	render_cards(render, &table->_dealer._cards, 1, table->_dealer._cards._count);
+	render_printf(render, "= %u | %s | cash %d%c\n", table->_dealer._hand._value,
+		table->_black_jack ? "BLACK JACK" : outcome_name[table->_outcome], table->_player._account._cash, currency);
+}
+
+//Transacting money from the loser's account to the winner's account,
 //Transaction amount calculated as: transact_multiplier*winner->_account._bet
-static void win_lose_transactions(Player_t* loser, Player_t* winner, double transact_multiplier) {
+static void win_lose_transactions(Table_t* table, Player_t* loser, Player_t* winner, double transact_multiplier) {
 	assert_condition(loser, "Error: function[win_lose_transactions()]: pointer provided to argument 'loser' is Null. exitting", true);
 	assert_condition(winner, "Error: function[win_lose_transactions()]: pointer provided to argument 'winner' is Null. exitting", true);
 	assert_condition(transact_multiplier > 0, "Warning: function[win_lose_transactions()]: 'transact_multiplier' should not be 0 or negative", false);
 
-	print_winner_loser(loser, winner);
+	if (render_on(table->_render, RENDER_FULL))
+		print_winner_loser(table, loser, winner);
 	uint32_t money_to_transact = { 0 };
 
 	//Dealer loses, Player wins
 	if (!loser->_info._id) { //Dealer id is always 0
 
+		table->_outcome = OUTCOME_PLAYER_WIN;
 		money_to_transact = (uint32_t)(transact_multiplier * winner->_account._bet);
-		printf("\n%s BUST!\n", loser->_info._name);
+		table_print(table, "\n%s BUST!\n", loser->_info._name);
 
 		if (loser->_account._cash <= (int32_t)money_to_transact) {
-			printf("The house budget for this game ran out. ");
+			table_print(table, "The house budget for this game ran out. ");
 
 			if (loser->_account._cash < (int32_t)money_to_transact)
-				printf("and the house uses extra cash budget of %d%c to fully pay the winner %s.\n",
+				table_print(table, "and the house uses extra cash budget of %d%c to fully pay the winner %s.\n",
 					    money_to_transact - loser->_account._cash, currency, winner->_info._name);
 		}
 		loser->_account._cash -= money_to_transact; //House/Dealer cash may get negative here if is in debt to player
 		winner->_account._cash += money_to_transact;
 		winner->_account._cash += winner->_account._bet; //bet returns to player
 		winner->_account._bet = 0;
-		printf("%s, You WIN! your account is rewarded with %.1lf times your bet (i.e: %u%c)."
-			    "  [Your current cash: %d%c. Current bet: %u%c]\n", 
+		table_print(table, "%s, You WIN! your account is rewarded with %.1lf times your bet (i.e: %u%c)."
+			    "  [Your current cash: %d%c. Current bet: %u%c]\n",
 			     winner->_info._name, transact_multiplier, money_to_transact, currency, winner->_account._cash, currency, winner->_account._bet, currency);
 	}
 	else { //Player loses, Dealer wins
 
+		table->_outcome = OUTCOME_DEALER_WIN;
 		money_to_transact = (uint32_t)(transact_multiplier * loser->_account._bet);
 		winner->_account._cash += money_to_transact; //house gets player's money
 		loser->_account._bet = 0;
-		printf("\nBUST! %s, You lose! %.1lf times your bet was subtracted from your account. [Your current cash: %d%c. Current bet: %u%c].\n",
+		table_print(table, "\nBUST! %s, You lose! %.1lf times your bet was subtracted from your account. [Your current cash: %d%c. Current bet: %u%c].\n",
 			loser->_info._name, transact_multiplier, loser->_account._cash, currency, loser->_account._bet, currency);
-		printf("%s WINS!", winner->_info._name);
+		table_print(table, "%s WINS!", winner->_info._name);
 
 	}
 }
 
-static bool dealer_draw(Player_t* dealer, Player_t* player, List* deck) {
-	assert_condition(dealer, "Error: function[dealer_draw()]: pointer provided to argument 'dealer' is Null. exitting", true);
-	assert_condition(player, "Error: function[dealer_draw()]: pointer provided to argument 'player' is Null. exitting", true);
-	assert_condition(deck, "Error: function[dealer_draw()]: pointer provided to argument 'deck' is Null. exitting", true);
+static bool dealer_draw(Table_t* table) {
+	assert_condition(table, "Error: function[dealer_draw()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	printf("\n#%u)       DEALER DRAWS:\n"
-		   "-------------------------------------\n", ++moves_counter);
-	uint32_t player_hand_val = calculate_hand_val(player->_cards);
+	Player_t* dealer = &table->_dealer;
+	Player_t* player = &table->_player;
+
+	table_print(table, "\n#%u)       DEALER DRAWS:\n"
+		   "-------------------------------------\n", ++table->_moves_counter);
+	uint32_t player_hand_val = player->_hand._value;
 	uint32_t dealer_hand_val = 0;
 
-	if (calculate_hand_val(dealer->_cards) > player_hand_val) {
-		win_lose_transactions(player, dealer, 1);
-		return reset_cards(dealer, player, deck); //returns: STOP_GAME/CONTINUE_GAME
+	if (dealer->_hand._value > player_hand_val) {
+		win_lose_transactions(table, player, dealer, 1);
+		return STATS_TIMED(PHASE_RESET, reset_cards(table)); //returns: STOP_GAME/CONTINUE_GAME
 	}
 
-	while ((dealer_hand_val = calculate_hand_val(dealer->_cards)) <= player_hand_val && dealer_hand_val < 17) {
-		random_draw(deck, dealer, 1, true);
+	while ((dealer_hand_val = dealer->_hand._value) <= player_hand_val && dealer_hand_val < HOUSE_DEALER_STANDS) {
+		random_draw(table, dealer, 1, true);
 	}
 
 
 	if (dealer_hand_val > BLACK_JACK) {
-		win_lose_transactions(dealer, player, 2);
+		table->_dealer_bust = true;
+		win_lose_transactions(table, dealer, player, HOUSE_DEALER_BUST_PAYS);
 	}
 	else if (dealer_hand_val == BLACK_JACK) {
-		win_lose_transactions(player, dealer, 1);
+		win_lose_transactions(table, player, dealer, 1);
 	}
 	else{
 
 		if (dealer_hand_val == player_hand_val) {
-			printf("TIE!\n");
+			table->_outcome = OUTCOME_TIE;
+			table_print(table, "TIE!\n");
 		}
 		else if (dealer_hand_val < player_hand_val) {
-			win_lose_transactions(dealer, player, 1);
+			win_lose_transactions(table, dealer, player, 1);
 		}
 		else {
-			win_lose_transactions(player, dealer, 1);
+			win_lose_transactions(table, player, dealer, 1);
 		}
 	}
-	return reset_cards(dealer, player, deck);//returns: STOP_GAME(0)/CONTINUE_GAME(1)
+	return STATS_TIMED(PHASE_RESET, reset_cards(table));//returns: STOP_GAME(0)/CONTINUE_GAME(1)
 }
 
-//returns: STOP_GAME(0)/CONTINUE_GAME(1)
-static int hit_or_stand(Player_t* dealer, Player_t *player, List* deck) {
-	assert_condition(dealer, "Error: function[hit_or_stand()]: pointer provided to argument 'dealer' is Null. exitting", true);
-	assert_condition(player, "Error: function[hit_or_stand()]: pointer provided to argument 'player' is Null. exitting", true);
-	assert_condition(deck, "Error: function[hit_or_stand()]: pointer provided to argument 'deck' is Null. exitting", true);
+//The default decision source of hit_or_stand(): the answer the table was given (see game_input() and the game server)
+static char pending_hit_stand(Player_t* player, Player_t* dealer, void* ctx) {
+	return ((Table_t*)ctx)->_action == 'H' ? 'H' : 'S';
+}
 
-	uint32_t hand_value = 0;
+//Hit or Stand phase, up to the decision: its header and the hint
+static void hit_or_stand_begin(Table_t* table) {
+	table_print(table, "\n#%u)      HIT OR STAND:\n"
+	       "-------------------------------------\n", ++table->_moves_counter);
 
-	printf("\n#%u)      HIT OR STAND:\n"
-	       "-------------------------------------\n", ++moves_counter);
+	if (table->_hints && render_on(table->_render, RENDER_FULL)) {
+		Ev_result_t ev;
+		if (exact_ev_table(table->_hints, table, &ev) == SUCCESS)
+			table_print(table, "Hint: standing %+.3f, hitting %+.3f times your bet on average -> %s is better.\n",
+				ev._stand, ev._hit, ev._hit > ev._stand ? "HIT" : "STAND");
+	}
 
-	char hit_stand = '?';
+	render_flush(table->_render); //the decision may be awaited
+}
+
+//returns: STOP_GAME(0)/CONTINUE_GAME(1)
+static int hit_or_stand(Table_t* table) {
+	assert_condition(table, "Error: function[hit_or_stand()]: pointer provided to argument 'table' is Null. exitting", true);
+
+	hit_or_stand_begin(table);
+	return hit_or_stand_play(table, table->_decide(&table->_player, &table->_dealer, table->_decide_ctx));
+}
+
+//The rest of the Hit or Stand phase, once decided. returns: STOP_GAME(0)/CONTINUE_GAME(1)/CONTINEU_HIT
+static int hit_or_stand_play(Table_t* table, char hit_stand) {
+	Player_t* dealer = &table->_dealer;
+	Player_t* player = &table->_player;
+	uint32_t hand_value = 0;
 
-	while (hit_stand != 'H' && hit_stand != 'S') {
-		getchar();
-		printf("Enter 'H' (to hit) or 'S' (to stand): ");
-		scanf("%c", &hit_stand);
-		if (isalpha(hit_stand)) { hit_stand = toupper(hit_stand); }
-	}
 	if (hit_stand == 'S') {
-		printf("\n\nSTAND!\n");
-		//revealing the dealer's cards
-		printf("Dealer cards revealed:    ");
-		print_list(dealer->_cards, print_card);
-		return dealer_draw(dealer, player, deck);//returns: STOP_GAME(0)/CONTINUE_GAME(1)
+		table->_stood = true;
+		if (render_on(table->_render, RENDER_FULL)) {
+			table_print(table, "\n\nSTAND!\n");
+			//revealing the dealer's cards
+			table_print(table, "Dealer cards revealed:    ");
+			display_hand(table, dealer);
+		}
+		return STATS_TIMED(PHASE_DEALER_DRAW, dealer_draw(table));//returns: STOP_GAME(0)/CONTINUE_GAME(1)
 	}
 	else {
-		printf("\n\nHIT!\n");
-		random_draw(deck, player, 1, true);//drawing single card to player
-		printf("%s, your list of cards after draw: ", player->_info._name);
-		print_list(player->_cards, print_card);
-		hand_value = calculate_hand_val(player->_cards);
-		printf("\nYour hand value after draw is: %u\n\n",hand_value);
+		table_print(table, "\n\nHIT!\n");
+		random_draw(table, player, 1, true);//drawing single card to player
+		hand_value = player->_hand._value;
+		if (render_on(table->_render, RENDER_FULL)) {
+			table_print(table, "%s, your list of cards after draw: ", player->_info._name);
+			display_hand(table, player);
+			table_print(table, "\nYour hand value after draw is: %u\n\n", hand_value);
+		}
 		if (hand_value > BLACK_JACK) {
-			win_lose_transactions(player, dealer, 1);
-			return reset_cards(dealer, player, deck);
+			table->_player_bust = true;
+			win_lose_transactions(table, player, dealer, 1);
+			return STATS_TIMED(PHASE_RESET, reset_cards(table));
 		}
 		if (hand_value == BLACK_JACK) {
-			win_lose_transactions(dealer, player, 1);
-			return reset_cards(dealer, player, deck);
+			win_lose_transactions(table, dealer, player, 1);
+			return STATS_TIMED(PHASE_RESET, reset_cards(table));
 		}
 		return CONTINEU_HIT;
 	}
@@ -382,106 +669,70 @@ static int hit_or_stand(Player_t* dealer, Player_t *player, List* deck) {
 
 
 
-static void clearAll(Player_t* player, Player_t *dealer, List *deck) {
-	clear_list(player->_cards);
-	free(player->_cards);
+static void clearAll(Player_t* player, Player_t *dealer, Shoe_t *deck) {
+	card_list_clear(&player->_cards);
+	card_list_clear(&dealer->_cards);
 
-	clear_list(dealer->_cards);
-	free(dealer->_cards);
-
-	clear_list(deck);
+	clear_shoe(deck);
 }
 
-//Adds all the cards in the players and dealers hand to the top of the deck. 
+//Moves all the cards in the players and dealers hand to the deck discards.
 //If the player's cash is less than 10, the game is over.
-//returns true- continue to play, or false- stop game.
-static bool reset_cards(Player_t *dealer, Player_t *player, List* deck) {
-	assert_condition(dealer, "Error: function[reset_cards()]: pointer provided to argument 'dealer' is Null. exitting", true);
-	assert_condition(player, "Error: function[reset_cards()]: pointer provided to argument 'player' is Null. exitting", true);
-	assert_condition(deck, "Error: function[reset_cards()]: pointer provided to argument 'deck' is Null. exitting", true);
+//returns true- the next round may start (the interactive game asks first, see game_input()), or false- stop game.
+static bool reset_cards(Table_t* table) {
+	assert_condition(table, "Error: function[reset_cards()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	printf("\n\n#%u)     CARDS RESETTING:\n"
-		   "-------------------------------------\n", ++moves_counter);
-	char continu = 0;
-	Node_t* node;
+	Player_t* dealer = &table->_dealer;
+	Player_t* player = &table->_player;
+	Shoe_t* deck = table->_deck;
 
-	while (node = pop(dealer->_cards)) {
-		push(deck, node);
-	}
+	table_print(table, "\n\n#%u)     CARDS RESETTING:\n"
+		   "-------------------------------------\n", ++table->_moves_counter);
 
-	while (node = pop(player->_cards)) {
-		push(deck, node);
+	print_round_summary(table);
+	if (table->_history) {
+		history_round_end(table->_history, table);
 	}
+	if (table->_columns) {
+		columns_round_end(table->_columns, table);
+	}
+	shoe_discard(deck, dealer->_cards._count + player->_cards._count);
+
+	card_list_reset(&dealer->_cards);
+	hand_reset(&dealer->_hand);
+
+	card_list_reset(&player->_cards);
+	hand_reset(&player->_hand);
 
 	if (player->_account._cash < 10 || dealer->_account._cash < 10) {
-		if(player->_account._cash < 10) printf("Sorry %s, You are out of cash to bet  :(\n", player->_info._name);
-		if (dealer->_account._cash < 10) printf("House budget for this game ran out.\n");
+		if(player->_account._cash < 10) table_print(table, "Sorry %s, You are out of cash to bet  :(\n", player->_info._name);
+		if (dealer->_account._cash < 10) table_print(table, "House budget for this game ran out.\n");
 		return STOP_GAME;
 	}
-
-	while (continu != 'Y' && continu != 'N') {
-		getchar();
-		printf("%s, Would you like to bet again? [Y/N]\n", player->_info._name);
-		scanf("%c", &continu);
-		if (isalpha(continu)) { continu = toupper(continu); }
-	}
-	return (continu == 'Y' ? CONTINEU_GAME : STOP_GAME);
+	return CONTINEU_GAME;
 }
 
-static int cach_deposit_request(Player *player) {
-	assert_condition(player, "Error: function[cach_deposit_request()]: pointer provided to argument 'player' is Null. exitting", true);
-
-	uint32_t cash = 0;
-	uint8_t attempts = ATTEMPTS;
+//Asks for a deposit (the game's first, or a 'wait' GAME_REDEPOSIT when the cash ran out)
+static int cach_deposit_request(Table_t* table, int8_t wait) {
+	Player_t* player = &table->_player;
 
-	printf("\n#%u)     CASH DEPOSITING:\n"
+	return game_ask(table, wait, "\n#%u)     CASH DEPOSITING:\n"
 		   "-------------------------------------\n"
 		   "%s, How much CASH would you like to deposite?\n"
 		   "Your current cash: %d%c.   (NOTE: Minimum deposit amount: 1,000$, in multiples of 10)\n"
-		    , ++moves_counter, player->_info._name, player->_account._cash, currency);
-
-	scanf("%d", &cash);
-	//check valid input amount(cash must be at least 1,000, in 10's) 
-	while (attempts && ((player->_account._cash + cash < MIN_CASH) || cash % 10 != 0)) {
-		printf("Invalid input. No deposit occured. Try again:\n");
-		scanf("%d", &cash);
-		--attempts;
-	}
-
-	if (!attempts) {
-		printf("%s, Your %d attempts to deposit cash have failed. Please see Cazino manager\n", player->_info._name, ATTEMPTS);
-		return STOP_GAME;
-	}
-
-	player->_account._cash = cash;
-	return CONTINEU_GAME;
+		    , ++table->_moves_counter, player->_info._name, player->_account._cash, currency);
 }
 
-static int bet_request(Player* player) {
-	assert_condition(player, "Error: function[bet_request()]: pointer provided to argument 'player' is Null. exitting", true);
+//The round's bet, topped up to table->_auto_bet (the interactive game asks for it instead, see game_input())
+static int bet_request(Table_t* table) {
+	assert_condition(table, "Error: function[bet_request()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	uint8_t attempts = ATTEMPTS;
-	uint32_t bet = 0;
+	Player_t* player = &table->_player;
+	//a tie leaves the last bet on the table
+	uint32_t bet = (player->_account._bet < table->_auto_bet) ? table->_auto_bet - player->_account._bet : 0;
 
-	printf("%s, How much to add to your BET?\n"
-		    "Your current bet is: %u%c   [Your current cash: %d%c]. (Add in multiples of 10 only.)\n"
-		     , player->_info._name, player->_account._bet, currency, player->_account._cash, currency);
-
-	scanf("%u", &bet);
-	//check valid input amount(bet must be added in multiples of 10. player can add 0 only if bet>0) 
-	while (attempts && ((player->_account._bet + bet > (uint32_t)player->_account._cash)||
-		               !(player->_account._bet + bet) ||
-		                 bet % 10)) {
-		printf("Invalid input. No bet adding occured.\n");
-
-		if (--attempts) {
-			printf("Try again: ");
-			scanf("%u", &bet);
-		}
-		else {
-			return FAIL; //returning to while loop with option for user to end the game
-		}
-	}
+	if ((player->_account._bet + bet > (uint32_t)player->_account._cash) || !(player->_account._bet + bet))
+		return FAIL;
 
 	player->_account._bet += bet;
 	player->_account._cash -= bet;
@@ -489,58 +740,68 @@ static int bet_request(Player* player) {
 	return SUCCESS;
 }
 
-//draws 'count' number of cards from 'deck' and insert to the end of player's deck 
-static int random_draw(List* deck, Player_t* player, size_t count, bool display) {
-	assert_condition(deck, "Error: function[random_draw()]: pointer to 'deck' list is Null. exitting", true);
+//The bet added by the interactive player's answer 'line' (see game_input()). Returns: FAIL on an invalid amount
+static int bet_answer(Table_t* table, const char* line) {
+	Account_t* account = &table->_player._account;
+
+	//check valid input amount(bet must be added in multiples of 10. player can add 0 only if bet>0)
+	unsigned long bet = strtoul(line, NULL, 10);
+	bool valid = line[strspn(line, " \t")] != '-' && bet <= (uint32_t)account->_cash &&
+		account->_bet + bet <= (uint32_t)account->_cash && account->_bet + bet && !(bet % 10);
+
+	if (!valid)
+		return FAIL;
+	account->_bet += (uint32_t)bet;
+	account->_cash -= (int32_t)bet;
+	return SUCCESS;
+}
+
+//draws 'count' number of cards from 'deck' and insert to the end of player's deck
+static int random_draw(Table_t* table, Player_t* player, size_t count, bool display) {
+	assert_condition(table, "Error: function[random_draw()]: pointer to 'table' is Null. exitting", true);
 	assert_condition(player, "Error: function[random_draw()]: pointer to 'player' is Null. exitting", true);
-	
-	size_t pos = -1;
 
-	if (count > deck->_count) {
-		printf("Cannot draw more cards than exist in deck. Number of cards in deck is: %zu", deck->_count);
+	Shoe_t* deck = table->_deck;
+	uint8_t drawn = 0;
+
+	if (count > shoe_available(deck)) {
+		table_print(table, "Cannot draw more cards than exist in deck. Number of cards in deck is: %zu", shoe_available(deck));
 		return FAIL;
 	}
 
 	for (size_t i = 0; i < count; ++i) {
-		pos = rand() % deck->_count + 1;//draws random positions in range 1-52
-		Node_t* card = remove_at(deck, pos);
-		add_to_back(player->_cards, card);
-
-		if (display) { 
-			printf("Added card to %s:  ", player->_info._name);
-			print_card(card->_data);
-			puts("");
+		shoe_draw(deck, &drawn);//draws a random card out of the deck in O(1)
+		card_list_add_to_back(&player->_cards, drawn);
+		hand_add_card(&player->_hand, drawn);
+		STATS_COUNT(STATS_CARDS_DRAWN, 1);
+
+		if (display && render_on(table->_render, RENDER_FULL)) {
+			render_printf(table->_render, "Added card to %s:  ", player->_info._name);
+			render_card(table->_render, drawn);
+			render_text(table->_render, "\n", 1);
 		}
 	}
 
 	return SUCCESS;
 }
 
-//used as pointer to function to be sent for for_each() SLL 
+//used as pointer to function to be sent for card_list_for_each()
 //returnes number of Ace's in the cards
-void sum(void* data, void* args) {
+void sum(const uint8_t* data, void* args) {
 	assert_condition(data, "Error: function[sum()]: pointer to 'data' is Null. exitting", true);
 	assert_condition(args, "Error: function[sum()]: pointer to 'args' is Null. exitting", true);
 
-	uint8_t rank = (*(uint8_t*)data >> 2) +1; //1 is added because ranks range is 0-12
-	if (rank == 1) {
-		((sum_args_t*)args)->aces++;
-	}
-
-	if (rank >10) {  //Jack, Queen and King value is 10
-		((sum_args_t*)args)->sum += 10;
-	}
-	else {
-		((sum_args_t*)args)->sum += rank;
-	}
+	uint8_t card = *data;
+	((sum_args_t*)args)->aces += card_is_ace[card];
+	((sum_args_t*)args)->sum += card_value[card]; //Jack, Queen and King value is 10
 }
 
-static uint32_t calculate_hand_val(List* cards) {
+uint32_t calculate_hand_val(const Card_list_t* cards) {
 	assert_condition(cards, "Error: function[calculate_hand_val()]: pointer provided to argument 'cards' is Null. exitting", true);
 
 	sum_args_t args = { 0 };
 
-	for_each(cards, (void*)&args, sum); 
+	card_list_for_each(cards, (void*)&args, sum);
 
 	while (args.aces > 0 && (args.sum + 10 <= 21)) {
 		args.sum += 10;
@@ -550,15 +811,38 @@ static uint32_t calculate_hand_val(List* cards) {
 
 }
 
+void hand_add_card(Hand_t* hand, uint8_t card) {
+	hand->_aces += card_is_ace[card];
+	hand->_hard += card_value[card];
+	//a single Ace may count as 11 (two would make at least 22)
+	hand->_soft = (hand->_aces != 0) & (hand->_hard + 10 <= BLACK_JACK);
+	hand->_value = hand->_hard + 10 * hand->_soft;
+	hand->_bust = hand->_value > BLACK_JACK;
+}
+
+void hand_reset(Hand_t* hand) {
+	memset(hand, 0, sizeof(Hand_t));
+}
 
-static int player_cards_check(Player_t *player, Player_t* dealer) {
-	assert_condition(player, "Error: function[player_cards_check()]: pointer provided to argument 'player' is Null. exitting", true);
-	assert_condition(dealer, "Error: function[player_cards_check()]: pointer provided to argument 'dealer' is Null. exitting", true);
+//The dealer reveals the one card before last in his card list (see deal())
+uint8_t dealer_up_card(Table_t* table) {
+	assert_condition(table, "Error: function[dealer_up_card()]: pointer provided to argument 'table' is Null. exitting", true);
+
+	Card_list_t* cards = &table->_dealer._cards;
+	uint8_t* up_card = card_list_find(cards, cards->_count - 1);
+	assert_condition(up_card, "Error: function[dealer_up_card()]: dealer has less than 2 cards. exitting", true);
+	return *up_card;
+}
 
-	uint32_t cards_value = calculate_hand_val(player->_cards);
+
+static int player_cards_check(Table_t* table) {
+	assert_condition(table, "Error: function[player_cards_check()]: pointer provided to argument 'table' is Null. exitting", true);
+
+	uint32_t cards_value = table->_player._hand._value;
 	if (cards_value == BLACK_JACK) {
-		printf("BLACK-JACK !!!\n");
-		win_lose_transactions(dealer, player, 1.5);
+		table->_black_jack = true;
+		table_print(table, "BLACK-JACK !!!\n");
+		win_lose_transactions(table, &table->_dealer, &table->_player, HOUSE_NATURAL_PAYS);
 		return RESET_CARDS;
 	}
 	else if (cards_value > BLACK_JACK) {
@@ -569,65 +853,71 @@ static int player_cards_check(Player_t *player, Player_t* dealer) {
 	}
 }
 
-static int deal(Player_t* dealer, Player_t* player, List* deck) {
-	assert_condition(deck, "Error: function[deal()]: pointer to 'deck' list is Null. exitting", true);
-	assert_condition(dealer, "Error: function[deal()]: pointer to 'dealer' is Null. exitting", true);
-	assert_condition(player, "Error: function[deal()]: pointer to 'player' is Null. exitting", true);
+static int deal(Table_t* table) {
+	assert_condition(table, "Error: function[deal()]: pointer to 'table' is Null. exitting", true);
 
-	printf("\n#%u)        DEALLING:\n"
-		   "-------------------------------------\n", ++moves_counter);
-	if ((random_draw(deck, dealer, 2, false) | random_draw(deck, player, 2, false)) != 0) {
-		printf("Failed to deal cards to players.\n");
+	Player_t* dealer = &table->_dealer;
+	Player_t* player = &table->_player;
+
+	table_print(table, "\n#%u)        DEALLING:\n"
+		   "-------------------------------------\n", ++table->_moves_counter);
+	if (shoe_cut_card_out(table->_deck)) {
+		shoe_reshuffle(table->_deck);
+		table_print(table, "Cut card is out. Shuffling the shoe.\n");
+	}
+	if ((random_draw(table, dealer, 2, false) | random_draw(table, player, 2, false)) != 0) {
+		table_print(table, "Failed to deal cards to players.\n");
 		return FAIL;
 	}
 
-	printf("Cards delt:\n");
-	//dealer reveals only the one card before last in his card list (cards added to back of list in draw)
-	display_cards(dealer, dealer->_cards->_count - 1, dealer->_cards->_count - 1);
-	printf("   ????????\n");
-	//player reveals two last cards in his card list
-	display_cards(player, player->_cards->_count-1, player->_cards->_count);
-	puts("\n\n");
+	if (render_on(table->_render, RENDER_FULL)) {
+		table_print(table, "Cards delt:\n");
+		//dealer reveals only the one card before last in his card list (cards added to back of list in draw)
+		display_cards(table, dealer, dealer->_cards._count - 1, dealer->_cards._count - 1);
+		table_print(table, "   ????????\n");
+		//player reveals two last cards in his card list
+		display_cards(table, player, player->_cards._count - 1, player->_cards._count);
+		table_print(table, "\n\n\n");
+	}
 
 	return SUCCESS;
 }
 
-static int bet(Player_t *player, Player_t *dealer) {
-	assert_condition(player, "Error: function[bet()]: pointer provided to argument 'player' is Null. exitting", true);
-	assert_condition(dealer, "Error: function[bet()]: pointer provided to argument 'dealer' is Null. exitting", true);
+static int bet(Table_t* table) {
+	assert_condition(table, "Error: function[bet()]: pointer provided to argument 'table' is Null. exitting", true);
 
-	printf("\n#%u)          BETTING:\n"
-	        "-------------------------------------\n", ++moves_counter);
-	char continu='?';
+	bet_open(table);
 
-		if (player->_account._cash == 0) {
-			while (continu != 'Y' && continu != 'N') {
-				printf("%s, you have no cash left on your account.\n"
-				    	"Would you like to deposit to cash and continue betting? [Y/N]\n", player->_info._name);
-				scanf("%c", &continu);
+	int betting = bet_allowed(table);
+	if (betting == SUCCESS && bet_request(table) == FAIL) {
+		table_print(table, "%s, you failed to add bet. Game ends.\n", table->_player._info._name);
+		return FAIL;
+	}
+	return betting;
+}
 
-				if (isalpha(continu)) { toupper(continu); }
-			}
-			if (continu == 'N') return STOP_GAME;
+static void bet_open(Table_t* table) {
+	table_print(table, "\n#%u)          BETTING:\n"
+	        "-------------------------------------\n", ++table->_moves_counter);
+}
 
-			if (cach_deposit_request(player) == STOP_GAME)
-				return STOP_GAME;
-		}
+//Whether the round can be bet on. returns: SUCCESS, STOP_GAME (no cash left, or the house's budget ran out) or FAIL
+static int bet_allowed(Table_t* table) {
+	Player_t* dealer = &table->_dealer;
+	Player_t* player = &table->_player;
 
-		if (player->_account._cash < 0) {//this state should never occure.
-			return FAIL;
-		}
-			
-		//dded a dealer/house budget limit of cash for this game
-		if (dealer->_account._cash <= 0) {
-			return STOP_GAME;
-		}
+	if (player->_account._cash == 0) //the interactive game asks for a deposit first (see game_bet())
+		return STOP_GAME;
 
-		if(bet_request(player) == FAIL) {
-			printf("%s, you failed to add bet. Game ends.\n", player->_info._name);
-			return FAIL;
-		}
-		return SUCCESS;
+	if (player->_account._cash < 0) {//this state should never occure.
+		return FAIL;
+	}
+
+	//dded a dealer/house budget limit of cash for this game
+	if (dealer->_account._cash <= 0) {
+		return STOP_GAME;
+	}
+	return SUCCESS;
 }
 
 void assert_condition(bool isValid, const char* errorMsg, bool isFatal) {
@@ -647,16 +937,13 @@ void assert_condition(bool isValid, const char* errorMsg, bool isFatal) {
 	}
 }
 
-static void clear_input(void) {	
-	while (getchar() != '\n');
-}
-
 
+#ifndef BJ_NO_MAIN //defined when the engine is linked into another program (simulation, tools)
 int main() {
 	play();
 	return 0;
 }
-
+#endif
 
 
 
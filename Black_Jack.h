@@ -5,10 +5,147 @@
  * Language:  C
  * Date: July 2021
 */
+#include<stdint.h>
+#include<stdbool.h>
+#include"Cards.h"
+#include"Shoe.h"
+#include"Rng.h"
+#include"Render.h"
+
 #define FAIL -1
 #define SUCCESS 0
 
+#define MAX_NAME_LEN 15
+
+enum round_outcome { OUTCOME_NONE, OUTCOME_PLAYER_WIN, OUTCOME_DEALER_WIN, OUTCOME_TIE };
+//round_begin()/round_turn() results
+enum round_step { ROUND_STOP, ROUND_OVER /*next round may start*/, ROUND_PLAYER_TURN /*waits for a Hit or Stand*/ };
+//game_start()/game_input() results: the question a suspended game waits an answer line for, or the game's end
+enum game_wait {
+	GAME_FAILED = -1,  //ended before any round (no valid ID or deposit)
+	GAME_OVER,         //ended after "GAME-OVER"
+	GAME_NAME, GAME_ID, GAME_HINTS, GAME_DEPOSIT,
+	GAME_NO_CASH,      //no cash left: deposit again? [Y/N]
+	GAME_REDEPOSIT,
+	GAME_BET, GAME_HIT_STAND, GAME_AGAIN
+};
+
+//STRUCTS
+typedef struct Person {
+	char _name[MAX_NAME_LEN];
+	int32_t _id;
+}Person_t;
+
+typedef struct Account {
+	int32_t _cash;
+	uint32_t _bet;
+}Account_t;
+
+//Running value of a hand, updated in O(1) on every card added to it (see hand_add_card())
+typedef struct Hand {
+	uint8_t _hard;   //cards sum, Aces counted as 1
+	uint8_t _aces;
+	uint8_t _value;  //hand value: _hard, plus 10 when an Ace can count as 11
+	bool _soft;      //an Ace counts as 11 in _value
+	bool _bust;      //_value > 21
+}Hand_t;
+
+typedef struct Player {
+	Person_t _info; //'Dealer' _info.id = 0
+	Account_t _account;
+	Card_list_t _cards; //held inline: a hand makes no allocations
+	Hand_t _hand;   //value of _cards
+}Player_t;
 
-//Call this function to start playing.
+//Hit or Stand decision source. Returns 'H' (hit) or 'S' (stand).
+//The interactive game reads it from stdin, a simulation supplies its own strategy.
+typedef char (*hit_stand_decision)(Player_t* player, Player_t* dealer, void* ctx);
+
+//All the state of a single game table (one player against the dealer).
+//The deck keeps a pointer to the table's _rng, so a table must not be moved/copied after table_init().
+typedef struct Table {
+	Player_t _dealer;
+	Player_t _player;
+	Shoe_t* _deck;
+	Rng_t _rng;              //the table's own random generator (the deck draws from it)
+	unsigned int _moves_counter;
+
+	bool _headless;          //true: no terminal game at all (simulation). Only picks the table_init() output.
+	Render_t* _render;       //the game output (NULL: silent, the headless default). See table_set_render().
+	uint32_t _auto_bet;      //round_begin(): bet the player tops up to on every round
+	hit_stand_decision _decide; //round_turn() decision source (default: _action)
+	void* _decide_ctx;
+	char _action;            //the pending Hit or Stand answer ('H'/'S') of the default decision source
+	int8_t _wait;            //the interactive game's question (enum game_wait, see game_input())
+	uint8_t _attempts;       //invalid answers left to the question
+	struct Ev_cache* _hints; //not NULL: hit_or_stand() shows the exact EV of hitting and standing (owned, see Exact_ev.h)
+	struct History_writer* _history; //not NULL: the rounds are logged (see History.h, not owned)
+	struct Column_writer* _columns;  //not NULL: the rounds are exported for analytics (see Columns.h, not owned)
+
+	//last round results:
+	enum round_outcome _outcome;
+	bool _black_jack;        //player got 21 on the initial deal
+	bool _player_bust;
+	bool _dealer_bust;
+	bool _stood;             //the player's last decision was a stand
+}Table_t;
+
+
+//Call this function to start playing (the game of game_start(), answered from stdin line by line).
 //Returns: error int number FAIL in case of fail, otherwise returns SUCCESS.
 int play();
+
+//The interactive game as a resumable state machine: every question suspends the game, and the answer line resumes
+//it, so a single thread may run any number of games (a game's whole state is its table).
+//game_start() asks the first question of a table_init() table, game_input() answers the question pending
+//('line' with or without its new line, NULL: the input ended) and runs the game up to the next question.
+//The questions and the transcript go to the table's render (see table_set_render(), silent: none at all).
+//Returns: the next question (enum game_wait), GAME_OVER or GAME_FAILED when the game ended (table_clear() it).
+int game_start(Table_t* table);
+int game_input(Table_t* table, const char* line);
+
+//Engine API (used by play() and by the headless simulation):
+//Initializes the table: dealer account, deck and empty hands. 'headless' disables all terminal I/O.
+//The table's random generator is seeded from the clock.
+void table_init(Table_t* table, bool headless);
+
+//Same as table_init(), with a given seed: same seed and same decisions -> same game.
+void table_init_seeded(Table_t* table, bool headless, uint64_t seed);
+
+//Same as table_init(), with the table's generator copied from 'rng' (e.g. one jumped to its own stream)
+void table_init_rng(Table_t* table, bool headless, const Rng_t* rng);
+
+//Sets the table's output: messages up to 'level' are buffered and written to 'out' once per round.
+//table_init() tables render RENDER_FULL to stdout, headless ones are silent (no formatting work at all).
+void table_set_render(Table_t* table, enum render_level level, FILE* out);
+
+//Replaces the table's shoe by a new shuffled shoe of 'decks' decks (1-8). 'penetration' (0-1] is the part of it
+//dealt before the cut card comes out and the shoe is reshuffled. (default: 1 deck, 0.75)
+//Returns: FAIL for invalid arguments or in the middle of a round, otherwise SUCCESS.
+int table_set_shoe(Table_t* table, uint8_t decks, double penetration);
+
+//Plays a single round: Betting, Initial Deal, Black Jack check, Hit or Stand and Dealer draw phases.
+//Returns: true- continue to next round, false- stop game.
+bool play_round(Table_t* table);
+
+//The same round, one step at a time (for callers that cannot block on the decision, e.g. the game server):
+//round_begin() runs the Betting (a top up to table->_auto_bet), Initial Deal and Black Jack check phases. While it
+//(or round_turn()) returns ROUND_PLAYER_TURN, round_turn() runs a single Hit or Stand phase, asking table->_decide once.
+//Neither waits on any input.
+//Returns: ROUND_PLAYER_TURN, ROUND_OVER (results in table->_outcome), or ROUND_STOP (game cannot go on).
+int round_begin(Table_t* table);
+int round_turn(Table_t* table);
+
+//Returns the dealer's revealed card (in suit_rank encoding)
+uint8_t dealer_up_card(Table_t* table);
+
+//Returns the value of the given hand of cards (Aces counted as 11 when possible).
+//Walks the whole list: the game reads the running Player_t::_hand._value instead.
+uint32_t calculate_hand_val(const Card_list_t* cards);
+
+//Adds a card (suit_rank encoding) to the hand's running value / clears it
+void hand_add_card(Hand_t* hand, uint8_t card);
+void hand_reset(Hand_t* hand);
+
+//Frees the table resources
+void table_clear(Table_t* table);
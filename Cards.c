@@ -0,0 +1,41 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Compile time generated cards lookup tables (see Cards.h).
+ * Language:  C
+*/
+
+#include "Cards.h"
+
+
+//the 4 suits of a rank, in encoding order
+#define FOR_SUITS(F, rank) F(0, rank), F(1, rank), F(2, rank), F(3, rank)
+
+//all the 52 cards, in encoding order
+#define FOR_CARDS(F) \
+	FOR_SUITS(F, 0), FOR_SUITS(F, 1), FOR_SUITS(F, 2), FOR_SUITS(F, 3), FOR_SUITS(F, 4), FOR_SUITS(F, 5), FOR_SUITS(F, 6), \
+	FOR_SUITS(F, 7), FOR_SUITS(F, 8), FOR_SUITS(F, 9), FOR_SUITS(F, 10), FOR_SUITS(F, 11), FOR_SUITS(F, 12)
+
+#define SUIT_NAME(suit) ((suit) == 0 ? "SPADES" : (suit) == 1 ? "HEARTS" : (suit) == 2 ? "CLUBS" : "DIAMONDS")
+
+#define CODE(suit, rank) MAKE_CARD(suit, rank)
+#define VALUE(suit, rank) ((rank) >= 9 ? 10 : (rank) + 1)
+#define IS_ACE(suit, rank) ((rank) == 0)
+#define SUIT(suit, rank) SUIT_NAME(suit)
+
+__thread uint64_t typed_list_allocs = 0; //see Typed_list.h
+
+const uint8_t card_codes[CARDS_COUNT] = { FOR_CARDS(CODE) };
+const uint8_t card_value[CARDS_COUNT] = { FOR_CARDS(VALUE) };
+const uint8_t card_is_ace[CARDS_COUNT] = { FOR_CARDS(IS_ACE) };
+const char* const card_suit_name[CARDS_COUNT] = { FOR_CARDS(SUIT) };
+
+//names are string literals, so they are spelled per rank
+#define RANK_NAMES(name) name, name, name, name
+#define CARD_NAMES(name) " [" name " of SPADES] ", " [" name " of HEARTS] ", " [" name " of CLUBS] ", " [" name " of DIAMONDS] "
+#define CARD_NAME_LENS(name) sizeof(" [" name " of SPADES] ") - 1, sizeof(" [" name " of HEARTS] ") - 1, \
+	sizeof(" [" name " of CLUBS] ") - 1, sizeof(" [" name " of DIAMONDS] ") - 1
+#define FOR_RANK_NAMES(F) F("Ace"), F("2"), F("3"), F("4"), F("5"), F("6"), F("7"), F("8"), F("9"), F("10"), F("Jack"), F("Queen"), F("King")
+
+const char* const card_rank_name[CARDS_COUNT] = { FOR_RANK_NAMES(RANK_NAMES) };
+const char* const card_name[CARDS_COUNT] = { FOR_RANK_NAMES(CARD_NAMES) };
+const uint8_t card_name_len[CARDS_COUNT] = { FOR_RANK_NAMES(CARD_NAME_LENS) };
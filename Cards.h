@@ -0,0 +1,31 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the cards lookup tables. A card is a byte in the suit_rank encoding:
+ *              [1:0] bits kept for card suit.  [5:2] bits kept for card rank (0 = Ace ... 12 = King). [6-7] empty.
+ *              The 52 encodings are 0-51, so every card property is a single table load indexed by the card.
+ *              All tables are generated at compile time (Cards.c).
+ * Language:  C
+*/
+#include<stdint.h>
+#include"Typed_list.h"
+
+#define CARDS_COUNT 52
+#define CARD_NONE 0xFF //not a card (e.g. an empty slot in a packed hand)
+
+#define CARD_SUIT(card) ((card) & 0x03)
+#define CARD_RANK(card) ((card) >> 2)
+#define MAKE_CARD(suit, rank) (uint8_t)(((rank) << 2) | (suit))
+
+#define CARD_LIST_INLINE 24 //cards held with no allocation: more than any hand (even a single deck allows 11 cards)
+
+//A hand: cards stored by value in draw order (see Typed_list.h), card_list_* functions
+TYPED_LIST(Card_list_t, card_list, uint8_t, CARD_LIST_INLINE)
+
+extern const uint8_t card_codes[CARDS_COUNT];     //card_codes[c] == c: the full deck, in order
+extern const uint8_t card_value[CARDS_COUNT];     //Ace = 1, Jack/Queen/King = 10
+extern const uint8_t card_is_ace[CARDS_COUNT];    //1 for an Ace, otherwise 0
+extern const char* const card_suit_name[CARDS_COUNT];
+extern const char* const card_rank_name[CARDS_COUNT];
+extern const char* const card_name[CARDS_COUNT];  //pre-formatted " [Rank of Suit] "
+extern const uint8_t card_name_len[CARDS_COUNT];  //strlen(card_name[c])
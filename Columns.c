@@ -0,0 +1,279 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the columnar rounds export.
+ *              File layout (host byte order):
+ *                header:  "BJCO", version, columns count, 2 reserved bytes, chunk rows (4), byte order mark (4)
+ *                chunks:  rows (4), payload bytes (4), every column's min and max (8 bytes each), then the columns
+ *                         arrays in enum column_id order, each padded to 8 bytes.
+ *              A chunk's min and max are computed once, when it is written out.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include "Columns.h"
+#include "History.h"
+#include "Cards.h"
+
+
+#define COLUMNS_MAGIC "BJCO"
+#define COLUMNS_VERSION 1
+#define BYTE_ORDER_MARK 0x01020304u
+#define HEADER_SIZE 16
+#define ALIGN8(size) (((size) + 7) & ~(size_t)7)
+
+const uint8_t column_width[COLUMNS] = { 1, 1, 1, 1, 4, 4 };
+
+typedef struct Chunk_header {
+	uint32_t _rows;
+	uint32_t _bytes;          //the columns arrays that follow
+	int64_t _min[COLUMNS];
+	int64_t _max[COLUMNS];
+}Chunk_header_t;
+
+
+static int columns_flush(Column_writer_t* writer);
+static int64_t column_value(const void* data, enum column_id column, size_t row);
+static size_t chunk_bytes(uint32_t rows);
+static bool write_all(int fd, const void* data, size_t size);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+Column_writer_t* create_column_writer(const char* path, Table_t* table) {
+	assert_condition(path && table, "Error: function[create_column_writer()]: Null path or table pointer provided");
+
+	uint8_t header[HEADER_SIZE] = { 0 };
+	uint32_t rows = COLUMNS_CHUNK_ROWS, mark = BYTE_ORDER_MARK;
+
+	if (table->_player._cards._count || table->_dealer._cards._count) { //the round's stake is not known
+		fprintf(stderr, "Warning: function[create_column_writer()]: Cannot start an export in the middle of a round\n");
+		return NULL;
+	}
+	Column_writer_t* writer = (Column_writer_t*)calloc(1, sizeof(Column_writer_t));
+	assert_condition(writer, "Error: function[create_column_writer()]: Failed allocating memory for new writer");
+	for (int c = 0; c < COLUMNS; ++c) {
+		writer->_data[c] = (uint8_t*)malloc((size_t)COLUMNS_CHUNK_ROWS * column_width[c]);
+		assert_condition(writer->_data[c], "Error: function[create_column_writer()]: Failed allocating memory for the chunk");
+	}
+
+	memcpy(header, COLUMNS_MAGIC, 4);
+	header[4] = COLUMNS_VERSION;
+	header[5] = COLUMNS;
+	memcpy(header + 8, &rows, 4);
+	memcpy(header + 12, &mark, 4);
+	writer->_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (writer->_fd < 0 || !write_all(writer->_fd, header, HEADER_SIZE)) {
+		fprintf(stderr, "Warning: function[create_column_writer()]: Cannot create %s: %s\n", path, strerror(errno));
+		writer->_table = NULL;
+		clear_column_writer(writer);
+		return NULL;
+	}
+
+	writer->_table = table;
+	table->_columns = writer;
+	return writer;
+}
+
+int clear_column_writer(Column_writer_t* writer) {
+	if (!writer)
+		return SUCCESS;
+
+	int result = writer->_fd >= 0 ? columns_flush(writer) : FAIL;
+	if (writer->_table && writer->_table->_columns == writer) {
+		writer->_table->_columns = NULL;
+	}
+	if (writer->_fd >= 0 && close(writer->_fd) != 0) {
+		result = FAIL;
+	}
+	result = writer->_failed ? FAIL : result;
+	for (int c = 0; c < COLUMNS; ++c) {
+		free(writer->_data[c]);
+	}
+	free(writer);
+	return result;
+}
+
+void columns_round_begin(Column_writer_t* writer, Table_t* table) {
+	writer->_stake = table->_player._account._bet;
+	writer->_equity = (int64_t)table->_player._account._cash + table->_player._account._bet;
+}
+
+void columns_round_end(Column_writer_t* writer, Table_t* table) {
+	Account_t* account = &table->_player._account;
+	const Card_list_t* dealer = &table->_dealer._cards; //the dealer's first card is the one revealed (see dealer_up_card())
+	uint32_t row = writer->_len;
+	int32_t net = (int32_t)((int64_t)account->_cash + account->_bet - writer->_equity);
+
+	writer->_data[COLUMN_PLAYER_TOTAL][row] = (uint8_t)table->_player._hand._value;
+	writer->_data[COLUMN_DEALER_UP][row] = dealer->_count ? card_value[card_list_cdata(dealer)[0]] : 0;
+	writer->_data[COLUMN_DEALER_TOTAL][row] = (uint8_t)table->_dealer._hand._value;
+	writer->_data[COLUMN_FLAGS][row] = history_round_flags(table);
+	((uint32_t*)writer->_data[COLUMN_STAKE])[row] = writer->_stake;
+	((int32_t*)writer->_data[COLUMN_NET])[row] = net;
+	writer->_rows++;
+	if (++writer->_len == COLUMNS_CHUNK_ROWS) {
+		columns_flush(writer);
+	}
+}
+
+//Writes the chunk out (its header first) and starts a new one
+static int columns_flush(Column_writer_t* writer) {
+	static const uint8_t padding[8] = { 0 };
+	Chunk_header_t header;
+
+	if (!writer->_len)
+		return SUCCESS;
+
+	header._rows = writer->_len;
+	header._bytes = (uint32_t)(chunk_bytes(writer->_len) - sizeof(Chunk_header_t));
+	for (int c = 0; c < COLUMNS; ++c) {
+		int64_t min = column_value(writer->_data[c], (enum column_id)c, 0), max = min;
+		for (uint32_t row = 1; row < writer->_len; ++row) {
+			int64_t value = column_value(writer->_data[c], (enum column_id)c, row);
+			min = value < min ? value : min;
+			max = value > max ? value : max;
+		}
+		header._min[c] = min;
+		header._max[c] = max;
+	}
+
+	bool written = write_all(writer->_fd, &header, sizeof(header));
+	for (int c = 0; c < COLUMNS && written; ++c) {
+		size_t size = (size_t)writer->_len * column_width[c];
+		written = write_all(writer->_fd, writer->_data[c], size) && write_all(writer->_fd, padding, ALIGN8(size) - size);
+	}
+	if (!written) {
+		fprintf(stderr, "Warning: function[columns_flush()]: Failed writing %u rows: %s\n", writer->_len, strerror(errno));
+		writer->_failed = true;
+	}
+	writer->_len = 0;
+	return writer->_failed ? FAIL : SUCCESS;
+}
+
+int columns_open(Columns_reader_t* reader, const char* path) {
+	assert_condition(reader && path, "Error: function[columns_open()]: Null reader or path pointer provided");
+
+	struct stat info;
+	uint32_t rows = 0, mark = 0;
+	size_t capacity = 0;
+	int fd = open(path, O_RDONLY);
+
+	memset(reader, 0, sizeof(Columns_reader_t));
+	if (fd < 0 || fstat(fd, &info) != 0) {
+		fprintf(stderr, "Warning: function[columns_open()]: Cannot open %s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return FAIL;
+	}
+	if ((size_t)info.st_size >= HEADER_SIZE) {
+		reader->_map = (const uint8_t*)mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd); //the mapping stays
+	if (!reader->_map || reader->_map == MAP_FAILED) {
+		fprintf(stderr, "Warning: function[columns_open()]: Cannot map %s\n", path);
+		reader->_map = NULL;
+		return FAIL;
+	}
+	reader->_size = info.st_size;
+
+	memcpy(&rows, reader->_map + 8, 4);
+	memcpy(&mark, reader->_map + 12, 4);
+	bool valid = !memcmp(reader->_map, COLUMNS_MAGIC, 4) && reader->_map[4] == COLUMNS_VERSION &&
+		reader->_map[5] == COLUMNS && rows == COLUMNS_CHUNK_ROWS && mark == BYTE_ORDER_MARK;
+
+	//indexing the chunks: only their headers are read
+	for (size_t pos = HEADER_SIZE; valid && pos < reader->_size; ) {
+		const Chunk_header_t* header = (const Chunk_header_t*)(reader->_map + pos);
+		if (reader->_size - pos < sizeof(Chunk_header_t) || !header->_rows || header->_rows > COLUMNS_CHUNK_ROWS ||
+			chunk_bytes(header->_rows) > reader->_size - pos ||
+			header->_bytes != chunk_bytes(header->_rows) - sizeof(Chunk_header_t)) {
+			valid = false; //a truncated or corrupt chunk
+			break;
+		}
+		if (reader->_chunks == capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			reader->_chunk = (const uint8_t**)realloc(reader->_chunk, capacity * sizeof(const uint8_t*));
+			assert_condition(reader->_chunk, "Error: function[columns_open()]: Failed allocating memory for the chunks index");
+		}
+		reader->_chunk[reader->_chunks++] = reader->_map + pos;
+		reader->_rows += header->_rows;
+		pos += chunk_bytes(header->_rows);
+	}
+	if (!valid) {
+		fprintf(stderr, "Warning: function[columns_open()]: %s is not a valid columns export\n", path);
+		columns_close(reader);
+		return FAIL;
+	}
+	return SUCCESS;
+}
+
+void columns_close(Columns_reader_t* reader) {
+	if (!reader)
+		return;
+	if (reader->_map) {
+		munmap((void*)reader->_map, reader->_size);
+	}
+	free(reader->_chunk);
+	memset(reader, 0, sizeof(Columns_reader_t));
+}
+
+void columns_chunk(const Columns_reader_t* reader, size_t index, Column_chunk_t* chunk) {
+	assert_condition(reader && chunk && index < reader->_chunks, "Error: function[columns_chunk()]: Invalid reader, chunk or index");
+
+	const Chunk_header_t* header = (const Chunk_header_t*)reader->_chunk[index];
+	const uint8_t* data = (const uint8_t*)(header + 1);
+
+	chunk->_rows = header->_rows;
+	for (int c = 0; c < COLUMNS; ++c) {
+		chunk->_min[c] = header->_min[c];
+		chunk->_max[c] = header->_max[c];
+		chunk->_data[c] = data;
+		data += ALIGN8((size_t)header->_rows * column_width[c]);
+	}
+}
+
+static int64_t column_value(const void* data, enum column_id column, size_t row) {
+	switch (column_width[column]) {
+	case 1:
+		return ((const uint8_t*)data)[row];
+	default:
+		return column == COLUMN_NET ? (int64_t)((const int32_t*)data)[row] : (int64_t)((const uint32_t*)data)[row];
+	}
+}
+
+//A chunk's size in the file, header included
+static size_t chunk_bytes(uint32_t rows) {
+	size_t size = sizeof(Chunk_header_t);
+	for (int c = 0; c < COLUMNS; ++c) {
+		size += ALIGN8((size_t)rows * column_width[c]);
+	}
+	return size;
+}
+
+static bool write_all(int fd, const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	while (size) {
+		ssize_t written = write(fd, bytes, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		bytes += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the columnar rounds export: a stream of the rounds played at a table, stored field by field.
+ *              Rounds are buffered into chunks of COLUMNS_CHUNK_ROWS rows. A chunk holds one array per column and
+ *              every column's min and max, so a scan reads only the columns it needs and skips the chunks a filter
+ *              rules out without touching their rows. The arrays are mapped as they are (host byte order).
+ *              See Analytics.h for the parallel scan.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include "Black_Jack.h"
+
+#define COLUMNS_CHUNK_ROWS 65536
+
+//The columns of a round
+enum column_id {
+	COLUMN_PLAYER_TOTAL,  //uint8_t: the player's final hand value
+	COLUMN_DEALER_UP,     //uint8_t: the dealer's up card value (1-10)
+	COLUMN_DEALER_TOTAL,  //uint8_t: the dealer's final hand value
+	COLUMN_FLAGS,         //uint8_t: outcome and results, as the hand history flags (see History.h)
+	COLUMN_STAKE,         //uint32_t: bet on the table when the cards were dealt
+	COLUMN_NET,           //int32_t: player's win (negative: loss)
+	COLUMNS
+};
+
+//Size in bytes of a column's value
+extern const uint8_t column_width[COLUMNS];
+
+//Streams the rounds of one table to a file (a writer is not thread safe: one per table)
+typedef struct Column_writer {
+	int _fd;
+	Table_t* _table;
+	bool _failed;             //a write failed: the export is incomplete
+	uint64_t _rows;           //rounds written so far
+	uint32_t _len;            //rows in the chunk
+	uint32_t _stake;          //the round in play (see columns_round_begin())
+	int64_t _equity;
+	uint8_t* _data[COLUMNS];  //the chunk's columns, COLUMNS_CHUNK_ROWS each
+}Column_writer_t;
+
+//A chunk as mapped by the reader
+typedef struct Column_chunk {
+	uint32_t _rows;
+	int64_t _min[COLUMNS];
+	int64_t _max[COLUMNS];
+	const void* _data[COLUMNS];
+}Column_chunk_t;
+
+typedef struct Columns_reader {
+	const uint8_t* _map;
+	size_t _size;
+	uint64_t _rows;
+	size_t _chunks;
+	const uint8_t** _chunk;   //the chunks headers, in rounds order
+}Columns_reader_t;
+
+//Creates the export file 'path' (replaced if it exists) and attaches it to the table: its rounds are written from now on.
+//Returns NULL in case of fail.
+Column_writer_t* create_column_writer(const char* path, Table_t* table);
+
+//Writes the last chunk out, detaches from the table and closes the file.
+//Returns: FAIL if any round could not be written, otherwise SUCCESS.
+int clear_column_writer(Column_writer_t* writer);
+
+//Game engine hooks (Black_Jack.c): once the stake is on the table, and when the round is over (hands not reset yet)
+void columns_round_begin(Column_writer_t* writer, Table_t* table);
+void columns_round_end(Column_writer_t* writer, Table_t* table);
+
+//Maps an export file and indexes its chunks. Returns: FAIL for a missing or invalid file, otherwise SUCCESS.
+int columns_open(Columns_reader_t* reader, const char* path);
+void columns_close(Columns_reader_t* reader);
+
+//Gets chunk 'index' (0 - _chunks-1) of an open file
+void columns_chunk(const Columns_reader_t* reader, size_t index, Column_chunk_t* chunk);
@@ -0,0 +1,108 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the cards counter.
+ *              A draw adds the card's tag of every system and takes it off the rank's remaining cards.
+ *              A reshuffle restarts from the full shoe less the cards still in play (a few cards).
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include "Count.h"
+
+
+//cards tags by rank: Ace, 2, ..., 10, Jack, Queen, King
+static const int8_t count_tags[COUNT_SYSTEMS][COUNT_RANKS] = {
+	{ -1, 1, 1, 1, 1, 1, 0, 0, 0, -1, -1, -1, -1 },  //Hi-Lo
+	{ -1, 1, 1, 1, 1, 1, 1, 0, 0, -1, -1, -1, -1 },  //KO
+	{ 0, 1, 1, 2, 2, 2, 1, 0, -1, -2, -2, -2, -2 },  //Omega II
+};
+static const char* const count_names[COUNT_SYSTEMS] = { "Hi-Lo", "KO", "Omega II" };
+
+
+static void count_observe(void* ctx, const Shoe_t* shoe, enum shoe_event event, uint8_t card);
+static void count_restart(Count_t* count, const Shoe_t* shoe);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+void count_attach(Count_t* count, Shoe_t* shoe) {
+	assert_condition(count && shoe, "Error: function[count_attach()]: Null count or shoe pointer provided");
+
+	memset(count, 0, sizeof(Count_t));
+	for (size_t i = 0; i < shoe->_count + shoe->_in_play + shoe->_discards; ++i) {
+		count->_full[CARD_RANK(shoe->_cards[i])]++;
+	}
+	count->_full_total = (uint32_t)(shoe->_count + shoe->_in_play + shoe->_discards);
+
+	//the cards already out of the shoe were seen
+	count_restart(count, shoe);
+	for (size_t i = shoe->_count + shoe->_in_play; i < count->_full_total; ++i) {
+		count_observe(count, shoe, SHOE_DRAW, shoe->_cards[i]);
+	}
+	count->_seen = 0;
+	set_shoe_observer(shoe, count_observe, count);
+}
+
+void count_detach(Count_t* count, Shoe_t* shoe) {
+	assert_condition(count && shoe, "Error: function[count_detach()]: Null count or shoe pointer provided");
+
+	if (shoe->_observer_ctx == count) {
+		set_shoe_observer(shoe, NULL, NULL);
+	}
+}
+
+double count_true(const Count_t* count, enum count_system system) {
+	double decks = count_remaining_decks(count);
+	return decks > 0 ? count->_running[system] / decks : 0.0;
+}
+
+double count_remaining_decks(const Count_t* count) {
+	return (double)count->_remaining_total / CARDS_COUNT;
+}
+
+const char* count_system_name(enum count_system system) {
+	return system < COUNT_SYSTEMS ? count_names[system] : "?";
+}
+
+static void count_observe(void* ctx, const Shoe_t* shoe, enum shoe_event event, uint8_t card) {
+	Count_t* count = (Count_t*)ctx;
+
+	if (event == SHOE_RESHUFFLE) {
+		count_restart(count, shoe);
+		return;
+	}
+	uint8_t rank = CARD_RANK(card);
+	count->_running[COUNT_HI_LO] += count_tags[COUNT_HI_LO][rank];
+	count->_running[COUNT_KO] += count_tags[COUNT_KO][rank];
+	count->_running[COUNT_OMEGA_II] += count_tags[COUNT_OMEGA_II][rank];
+	count->_remaining[rank]--;
+	count->_remaining_total--;
+	count->_seen++;
+}
+
+//A fresh shoe: all the cards are back but the ones in play, which are seen again
+static void count_restart(Count_t* count, const Shoe_t* shoe) {
+	int decks = (int)((count->_full_total + CARDS_COUNT / 2) / CARDS_COUNT);
+
+	memcpy(count->_remaining, count->_full, sizeof(count->_remaining));
+	count->_remaining_total = count->_full_total;
+	count->_running[COUNT_HI_LO] = 0;
+	count->_running[COUNT_KO] = 4 - 4 * decks; //KO is unbalanced: its initial running count
+	count->_running[COUNT_OMEGA_II] = 0;
+
+	for (size_t i = shoe->_count; i < shoe->_count + shoe->_in_play; ++i) {
+		uint8_t rank = CARD_RANK(shoe->_cards[i]);
+		for (int s = 0; s < COUNT_SYSTEMS; ++s)
+			count->_running[s] += count_tags[s][rank];
+		count->_remaining[rank]--;
+		count->_remaining_total--;
+	}
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the cards counter: observes a shoe (see set_shoe_observer()) and keeps the running counts
+ *              of several count systems at once, the true counts and the cards of each rank not seen yet.
+ *              Every drawn card is an O(1) update, with no allocation.
+ * Language:  C
+*/
+#include<stdint.h>
+#include "Shoe.h"
+#include "Cards.h"
+
+#define COUNT_RANKS 13
+
+enum count_system { COUNT_HI_LO, COUNT_KO, COUNT_OMEGA_II, COUNT_SYSTEMS };
+
+typedef struct Count {
+	int32_t _running[COUNT_SYSTEMS];
+	uint16_t _remaining[COUNT_RANKS]; //cards of each rank (0 = Ace ... 12 = King) not seen since the last reshuffle
+	uint32_t _remaining_total;
+	uint16_t _full[COUNT_RANKS];      //the full shoe's cards of each rank
+	uint32_t _full_total;
+	uint64_t _seen;                   //cards seen since attached
+}Count_t;
+
+//Counts the shoe from now on: the cards out of the shoe (in play or discarded) count as seen.
+//Replaces the shoe's observer. A new shoe (e.g. table_set_shoe()) needs attaching again.
+void count_attach(Count_t* count, Shoe_t* shoe);
+
+//Stops observing the shoe
+void count_detach(Count_t* count, Shoe_t* shoe);
+
+//Running count divided by the decks not seen yet
+double count_true(const Count_t* count, enum count_system system);
+
+//Decks not seen yet
+double count_remaining_decks(const Count_t* count);
+
+const char* count_system_name(enum count_system system);
@@ -0,0 +1,313 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of SLL.h as a generelized void* data storing Doubly Linked List.
+ *              Build with -DLIST_DOUBLY_LINKED (adds Node_t::_prev), instead of SLL.c.
+ *              Head and tail handlers are O(1). Positional handlers walk from the closer end of the list.
+ * Language:  C
+*/
+
+#ifndef LIST_DOUBLY_LINKED
+#error "DLL.c must be built with -DLIST_DOUBLY_LINKED"
+#endif
+
+#include<stdio.h>
+#include<stdlib.h>
+#include "SLL.h"
+
+
+#define FAIL -1
+#define SUCCESS 0
+
+
+void assert_condition(bool isValid, const char* errorMsg);
+
+
+//unlinks the node 'n' from the list
+static void unlink_node(List* list, Node_t* n) {
+	if (n->_prev) { n->_prev->_next = n->_next; }
+	else { list->_pHead = n->_next; }
+
+	if (n->_next) { n->_next->_prev = n->_prev; }
+	else { list->_pTail = n->_prev; }
+
+	n->_next = n->_prev = NULL;
+	list->_count--;
+}
+
+//The given node is added at the head of the list
+void push(List* list, Node_t* n) {
+	assert_condition(list, "Error: function[push()]: Argument List* is NULL");
+	assert_condition(n, "Error: function[push()]: Argument Node_t* is NULL");
+
+	n->_prev = NULL;
+	n->_next = list->_pHead;
+	if (list->_pHead) { list->_pHead->_prev = n; }
+	else { list->_pTail = n; } //adding the first node to an empty list
+	list->_pHead = n;
+	list->_count++;
+}
+
+//The first node is removed from the head of the list
+Node_t* pop(List* list) {
+	assert_condition(list, "Error: function[pop()]: Argument List* is NULL");
+	if (list->_count == 0) {
+		return NULL;
+	}
+	Node_t* toPop = list->_pHead;
+	unlink_node(list, toPop);
+	return toPop;
+}
+
+void add_to_back(List* list, Node_t* n) {
+	assert_condition(n, "Error: function[add()]: Argument Node_t* is NULL");
+	assert_condition(list, "Error: function[add()]: Argument List* is NULL");
+
+	n->_next = NULL;
+	n->_prev = list->_pTail;
+	if (list->_pTail) { list->_pTail->_next = n; }
+	else { list->_pHead = n; }
+	list->_pTail = n;
+	list->_count++;
+}
+
+Node_t* remove_from_back(List* list) {
+	assert_condition(list, "Error: function[remove()]: Argument List* is NULL");
+	if (list->_count == 0) {
+		return NULL;
+	}
+	Node_t* toRemove = list->_pTail;
+	unlink_node(list, toRemove);
+	return toRemove;
+}
+
+//returns node at the position given, otherwise returns NULL
+Node_t* find(List* list, size_t pos) {
+	assert_condition(list, "Error: function[find()]: Argument List* cannot be NULL");
+
+	if (pos == 0 || pos > list->_count) {
+		return NULL;
+	}
+	Node_t* itr = NULL;
+
+	if (pos <= list->_count / 2 + 1) { //walking from the head
+		itr = list->_pHead;
+		while (itr && --pos) { itr = itr->_next; }
+	}
+	else { //walking from the tail
+		itr = list->_pTail;
+		pos = list->_count - pos;
+		while (itr && pos--) { itr = itr->_prev; }
+	}
+	return itr;
+}
+
+Node_t* remove_at(List* list, size_t pos) {
+	assert_condition(list, "Error: function[remove_at()]: Argument List* is NULL");
+	if (pos > list->_count) {
+		fprintf(stderr, "Warning: function[remove_at()]: Argument 'pos' = %zu. Cannot be larger than list nodes count = %zu. Null returned\n.", pos, list->_count);
+		return NULL;
+	}
+
+	Node_t* current = find(list, pos);
+	if (!current) {
+		return NULL;
+	}
+	unlink_node(list, current);
+	return current;
+}
+
+Node_t* remove_by_val(List* list, void *value, int(*cmp)(void* v1, void *v2)){
+	assert_condition(list, "Error: function[remove_by_val()]: Argument List* is NULL");
+	assert_condition(cmp, "Error: function[remove_by_val()]: Argument func-pointer cmp* is NULL");
+
+	for (Node_t* current = list->_pHead; current; current = current->_next) {
+		if (cmp(current->_data, value) == 0) {
+			unlink_node(list, current);
+			return current;
+		}
+	}
+	//In case value not found in the list
+	return NULL;
+}
+
+//inserting before the node at given pos
+int insert(List* list, Node_t* n, size_t pos) {
+	assert_condition(n, "Error: function[insert()]: Argument Node_t* is NULL");
+	assert_condition(list, "Error: function[insert()]: Argument List* is NULL");
+
+	if (pos > list->_count) {
+		fprintf(stderr, "Warning: function[insert()]: Argument 'pos' = %zu. Cannot be larger than list nodes count = %zu. Null returned\n.", pos, list->_count);
+		return FAIL;
+	}
+	if (list->_count == 0 || pos <= 1) {
+		push(list, n);
+		return SUCCESS;
+	}
+
+	Node_t* current = find(list, pos);
+	n->_next = current;
+	n->_prev = current->_prev;
+	current->_prev->_next = n;
+	current->_prev = n;
+	list->_count++;
+	return SUCCESS;
+}
+
+int splice(List* list, size_t pos, List* src) {
+	assert_condition(list, "Error: function[splice()]: Argument List* is NULL");
+	assert_condition(src, "Error: function[splice()]: Argument List* src is NULL");
+
+	if (list == src || list->_pool != src->_pool) {
+		fprintf(stderr, "Warning: function[splice()]: Cannot splice a list into itself or into a list of another nodes pool\n");
+		return FAIL;
+	}
+	if (pos > list->_count + 1) {
+		fprintf(stderr, "Warning: function[splice()]: Argument 'pos' = %zu. Cannot be larger than list nodes count + 1 = %zu\n", pos, list->_count + 1);
+		return FAIL;
+	}
+	if (src->_count == 0) {
+		return SUCCESS;
+	}
+
+	//the nodes go between 'prev' and 'next' (NULL: the list head / tail)
+	Node_t* next = pos <= 1 ? list->_pHead : pos == list->_count + 1 ? NULL : find(list, pos);
+	Node_t* prev = next ? next->_prev : list->_pTail;
+
+	src->_pHead->_prev = prev;
+	src->_pTail->_next = next;
+	if (prev) { prev->_next = src->_pHead; }
+	else { list->_pHead = src->_pHead; }
+	if (next) { next->_prev = src->_pTail; }
+	else { list->_pTail = src->_pTail; }
+
+	list->_count += src->_count;
+	src->_pHead = src->_pTail = NULL;
+	src->_count = 0;
+	return SUCCESS;
+}
+
+int concat(List* list, List* src) {
+	assert_condition(list, "Error: function[concat()]: Argument List* is NULL");
+	return splice(list, list->_count + 1, src);
+}
+
+size_t extract_range(List* list, size_t start_pos, size_t end_pos, List* out) {
+	assert_condition(list, "Error: function[extract_range()]: Argument List* is NULL");
+	assert_condition(out, "Error: function[extract_range()]: Argument List* out is NULL");
+
+	Node_t* first = NULL;
+	if (list == out || list->_pool != out->_pool || end_pos < start_pos || end_pos > list->_count || !(first = find(list, start_pos))) {
+		fprintf(stderr, "Warning: function[extract_range()]: Range %zu-%zu of a %zu nodes list cannot be moved to the given list\n", start_pos, end_pos, list->_count);
+		return 0;
+	}
+
+	Node_t* last = first;
+	size_t moved = end_pos - start_pos + 1;
+	for (size_t i = 1; i < moved; ++i) {
+		last = last->_next;
+	}
+
+	//unlinking first - last
+	if (first->_prev) { first->_prev->_next = last->_next; }
+	else { list->_pHead = last->_next; }
+	if (last->_next) { last->_next->_prev = first->_prev; }
+	else { list->_pTail = first->_prev; }
+	list->_count -= moved;
+
+	//and linking them at the back of 'out'
+	first->_prev = out->_pTail;
+	last->_next = NULL;
+	if (out->_pTail) { out->_pTail->_next = first; }
+	else { out->_pHead = first; }
+	out->_pTail = last;
+	out->_count += moved;
+	return moved;
+}
+
+void add_array_to_back(List* list, void* const* data, size_t count) {
+	assert_condition(list, "Error: function[add_array_to_back()]: Argument List* is NULL");
+	assert_condition(data || !count, "Error: function[add_array_to_back()]: Argument data array is NULL");
+
+	if (!count)
+		return;
+
+	//the new nodes are chained first, then linked to the list at once
+	Node_t* first = list_create_node(list, data[0]);
+	Node_t* last = first;
+	for (size_t i = 1; i < count; ++i) {
+		last->_next = list_create_node(list, data[i]);
+		last->_next->_prev = last;
+		last = last->_next;
+	}
+	last->_next = NULL;
+
+	first->_prev = list->_pTail;
+	if (list->_pTail) { list->_pTail->_next = first; }
+	else { list->_pHead = first; }
+	list->_pTail = last;
+	list->_count += count;
+}
+
+Node_t* cursor_begin(List_cursor_t* cursor, List* list, size_t pos) {
+	assert_condition(cursor, "Error: function[cursor_begin()]: Argument List_cursor_t* is NULL");
+	assert_condition(list, "Error: function[cursor_begin()]: Argument List* is NULL");
+
+	cursor->_list = list;
+	cursor->_node = find(list, pos); //from the closer end
+	cursor->_prev = cursor->_node ? cursor->_node->_prev : NULL;
+	cursor->_pos = pos;
+	return cursor->_node;
+}
+
+Node_t* cursor_next(List_cursor_t* cursor) {
+	assert_condition(cursor, "Error: function[cursor_next()]: Argument List_cursor_t* is NULL");
+	if (!cursor->_node)
+		return NULL;
+
+	cursor->_prev = cursor->_node;
+	cursor->_node = cursor->_node->_next;
+	cursor->_pos++;
+	return cursor->_node;
+}
+
+Node_t* cursor_remove(List_cursor_t* cursor) {
+	assert_condition(cursor, "Error: function[cursor_remove()]: Argument List_cursor_t* is NULL");
+
+	Node_t* n = cursor->_node;
+	if (!n)
+		return NULL;
+
+	cursor->_node = n->_next; //takes the removed node's position
+	unlink_node(cursor->_list, n);
+	return n;
+}
+
+void clear_list(List* list) {
+
+	//The data pointed to by void* in node_t was not allocated by SLL and therefor is not freed.
+	list_free_nodes(list);
+}
+
+void print_list(List* list, void(*print_data)(void *data)) {
+	assert_condition(list, "Error: function[print_list()]: Argument List* cannot be NULL");
+	for (Node_t* itr = list->_pHead; itr != NULL; itr = itr->_next) {
+		print_data(itr->_data);
+	}
+	puts("");
+}
+
+void print_list_by_range(List* list, size_t start_pos, size_t end_pos, void(*print_data)(void* data)) {
+	assert_condition(list, "Error: function[print_list_by_range()]: Argument List* is NULL");
+
+	//a single walk: to the start node (from the closer end), then on up to the end position
+	List_cursor_t cursor;
+	for (Node_t* itr = cursor_begin(&cursor, list, start_pos); itr && cursor._pos <= end_pos; itr = cursor_next(&cursor)) {
+		print_data(itr->_data);
+	}
+}
+
+void for_each(List* list, void *result, void(*calculate)(void* data, void* result)) {
+	for (Node_t* itr = list->_pHead; itr != NULL; itr = itr->_next) {
+		calculate(itr->_data, result);
+	}
+}
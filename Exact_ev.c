@@ -0,0 +1,309 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the exact expected value calculator.
+ *              The counts of the 10 card values are packed in 62 bits (6 bits per value, 8 for the ten cards:
+ *              up to 8 decks), and a state (the dealer's hand and the value it must beat, or the player's hand
+ *              and the up card) in 16 more. Drawing a card subtracts its value's unit from the packed key.
+ *              Both the dealer's and the player's recursion results are cached under (counts, state).
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include "Exact_ev.h"
+#include "Cards.h"
+#include "Rules.h"
+
+
+#define MIN_STAND 4        //lowest value the player can stand on (2 + 2)
+#define STAND_VALUES (BLACK_JACK - MIN_STAND) //4-20: 21 is never stood on
+#define MAX_LOAD_NUM 3     //a table is cleared above 3/4 full
+#define MAX_LOAD_DEN 4
+
+//state bits
+#define STATE_ACE 0x0400
+#define STATE_ONE_CARD 0x0800 //the dealer holds its up card only: it draws the hole card
+
+//Entries of both tables start with their key
+typedef struct Ev_key {
+	uint64_t _counts;
+	uint16_t _state;
+	bool _used;
+}Ev_key_t;
+
+//Player's EV for each value he may stand on, against the dealer's hand
+typedef struct Ev_dealer_entry {
+	Ev_key_t _key;
+	double _ev[STAND_VALUES];
+}Ev_dealer_entry_t;
+
+typedef struct Ev_player_entry {
+	Ev_key_t _key;
+	double _ev;
+}Ev_player_entry_t;
+
+//Unseen cards: counts per value and their packed key
+typedef struct Ev_shoe {
+	uint8_t _counts[EV_CARD_VALUES];
+	uint64_t _key;
+	unsigned int _total;
+}Ev_shoe_t;
+
+
+static const uint8_t value_shift[EV_CARD_VALUES] = { 0, 6, 12, 18, 24, 30, 36, 42, 48, 54 };
+static const uint8_t value_max[EV_CARD_VALUES] = { 63, 63, 63, 63, 63, 63, 63, 63, 63, 255 };
+
+
+static const double* dealer_ev(Ev_cache_t* cache, Ev_shoe_t* shoe, int hard, bool ace, bool one_card, double* out);
+static double player_ev(Ev_cache_t* cache, Ev_shoe_t* shoe, int hard, bool ace, int up_value, double* stand, double* hit);
+static void table_create(Ev_table_t* table, size_t entries, size_t entry_size);
+static void* table_find(Ev_cache_t* cache, Ev_table_t* table, uint64_t counts, uint16_t state);
+static void* table_store(Ev_cache_t* cache, Ev_table_t* table, uint64_t counts, uint16_t state);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+static inline int hand_value(int hard, bool ace) {
+	return (ace && hard + 10 <= BLACK_JACK) ? hard + 10 : hard;
+}
+
+//the player's result when the dealer stops on 'value' (<= 21) and he stands on 'stand_value'
+static inline double stop_outcome(int value, int stand_value) {
+	return value > stand_value ? -1.0 : value == stand_value ? 0.0 : 1.0;
+}
+
+static inline void shoe_take(Ev_shoe_t* shoe, int value) {
+	shoe->_counts[value - 1]--;
+	shoe->_key -= 1ULL << value_shift[value - 1];
+	shoe->_total--;
+}
+
+static inline void shoe_put(Ev_shoe_t* shoe, int value) {
+	shoe->_counts[value - 1]++;
+	shoe->_key += 1ULL << value_shift[value - 1];
+	shoe->_total++;
+}
+
+Ev_cache_t* create_ev_cache(size_t entries) {
+	Ev_cache_t* cache = (Ev_cache_t*)calloc(1, sizeof(Ev_cache_t));
+
+	assert_condition(cache, "Error: function[create_ev_cache()]: Failed allocating memory for new cache");
+	table_create(&cache->_dealer, entries ? entries : EV_DEFAULT_ENTRIES, sizeof(Ev_dealer_entry_t));
+	table_create(&cache->_player, entries ? entries : EV_DEFAULT_ENTRIES, sizeof(Ev_player_entry_t));
+	return cache;
+}
+
+void clear_ev_cache(Ev_cache_t* cache) {
+	if (!cache)
+		return;
+	free(cache->_dealer._entries);
+	free(cache->_player._entries);
+	free(cache);
+}
+int exact_ev(Ev_cache_t* cache, const uint8_t* counts, uint8_t hard, bool ace, uint8_t up_value, Ev_result_t* result) {
+	Ev_shoe_t shoe = { {0}, 0, 0 };
+
+	if (!cache || !counts || !result || up_value < 1 || up_value > EV_CARD_VALUES || hand_value(hard, ace) >= BLACK_JACK) {
+		fprintf(stderr, "Warning: function[exact_ev()]: Invalid arguments (hand %u, up card %u)\n", hard, up_value);
+		return FAIL;
+	}
+	for (int v = 0; v < EV_CARD_VALUES; ++v) {
+		if (counts[v] > value_max[v]) {
+			fprintf(stderr, "Warning: function[exact_ev()]: %u cards of value %d. Up to 8 decks are supported\n", counts[v], v + 1);
+			return FAIL;
+		}
+		shoe._counts[v] = counts[v];
+		shoe._key |= (uint64_t)counts[v] << value_shift[v];
+		shoe._total += counts[v];
+	}
+	if (!shoe._total) {
+		fprintf(stderr, "Warning: function[exact_ev()]: No unseen cards\n");
+		return FAIL;
+	}
+
+	player_ev(cache, &shoe, hard, ace, up_value, &result->_stand, &result->_hit);
+	return SUCCESS;
+}
+
+int exact_ev_table(Ev_cache_t* cache, Table_t* table, Ev_result_t* result) {
+	uint8_t counts[EV_CARD_VALUES] = { 0 };
+
+	if (!table || table->_dealer._cards._count < 2) {
+		fprintf(stderr, "Warning: function[exact_ev_table()]: No round in play\n");
+		return FAIL;
+	}
+	Shoe_t* deck = table->_deck;
+	for (size_t i = 0; i < deck->_count; ++i) {
+		counts[card_value[deck->_cards[i]] - 1]++;
+	}
+	//the hole card is the dealer's last one (its up card is the one before, see dealer_up_card())
+	counts[card_value[card_list_cdata(&table->_dealer._cards)[table->_dealer._cards._count - 1]] - 1]++;
+
+	return exact_ev(cache, counts, table->_player._hand._hard, table->_player._hand._aces > 0,
+		card_value[dealer_up_card(table)], result);
+}
+
+char exact_ev_decide(Player_t* player, Player_t* dealer, void* ctx) {
+	Ev_player_t* ev_player = (Ev_player_t*)ctx;
+	Ev_result_t result;
+
+	if (exact_ev_table(ev_player->_cache, ev_player->_table, &result) != SUCCESS)
+		return 'S';
+	return result._hit > result._stand ? 'H' : 'S';
+}
+
+//Best EV of the player's hand. The top call ('stand' and 'hit' not NULL) gets the EV of each decision.
+static double player_ev(Ev_cache_t* cache, Ev_shoe_t* shoe, int hard, bool ace, int up_value, double* stand, double* hit) {
+	uint16_t state = (uint16_t)((ace ? STATE_ACE : 0) | (hard << 4) | up_value);
+	double dealer[STAND_VALUES];
+
+	if (!stand) {
+		Ev_player_entry_t* entry = (Ev_player_entry_t*)table_find(cache, &cache->_player, shoe->_key, state);
+		if (entry)
+			return entry->_ev;
+	}
+
+	double stand_ev = dealer_ev(cache, shoe, up_value, up_value == 1, true, dealer)[hand_value(hard, ace) - MIN_STAND];
+	double hit_ev = 0;
+
+	for (int v = 1; v <= EV_CARD_VALUES; ++v) {
+		if (!shoe->_counts[v - 1])
+			continue;
+		double p = (double)shoe->_counts[v - 1] / shoe->_total;
+		int next_hard = hard + v;
+		bool next_ace = ace || v == 1;
+		int next = hand_value(next_hard, next_ace);
+
+		if (next > BLACK_JACK) {
+			hit_ev -= p;
+		}
+		else if (next == BLACK_JACK) { //reaching 21 wins at once
+			hit_ev += p;
+		}
+		else {
+			shoe_take(shoe, v);
+			hit_ev += p * player_ev(cache, shoe, next_hard, next_ace, up_value, NULL, NULL);
+			shoe_put(shoe, v);
+		}
+	}
+
+	double best = hit_ev > stand_ev ? hit_ev : stand_ev;
+	if (stand) {
+		*stand = stand_ev;
+		*hit = hit_ev;
+	}
+	else {
+		((Ev_player_entry_t*)table_store(cache, &cache->_player, shoe->_key, state))->_ev = best;
+	}
+	return best;
+}
+
+//The player's EV for every stand value (index: value - MIN_STAND), the dealer holding (hard, ace).
+//See dealer_draw() of Black_Jack.c. A single recursion serves all the stand values: the dealer draws on
+//the same cards until it beats the stand value, so the values it already beats just stop earlier.
+//Returns the results: the cache entry, or 'out'.
+static const double* dealer_ev(Ev_cache_t* cache, Ev_shoe_t* shoe, int hard, bool ace, bool one_card, double* out) {
+	int value = hand_value(hard, ace);
+
+	if (!one_card && value > BLACK_JACK) {
+		for (int s = 0; s < STAND_VALUES; ++s)
+			out[s] = HOUSE_DEALER_BUST_PAYS;
+		return out;
+	}
+	if ((!one_card && value >= HOUSE_DEALER_STANDS) || !shoe->_total) { //the dealer stops (or has no card left to draw)
+		for (int s = 0; s < STAND_VALUES; ++s)
+			out[s] = stop_outcome(value, s + MIN_STAND);
+		return out;
+	}
+
+	uint16_t state = (uint16_t)((one_card ? STATE_ONE_CARD : 0) | (ace ? STATE_ACE : 0) | hard);
+	Ev_dealer_entry_t* entry = (Ev_dealer_entry_t*)table_find(cache, &cache->_dealer, shoe->_key, state);
+	if (entry)
+		return entry->_ev;
+
+	//stand values the dealer already beats need no draw
+	int first_draw = one_card ? 0 : value - MIN_STAND;
+	double child[STAND_VALUES];
+
+	if (first_draw < 0)
+		first_draw = 0;
+	for (int s = 0; s < STAND_VALUES; ++s)
+		out[s] = s < first_draw ? -1.0 : 0.0;
+
+	for (int v = 1; v <= EV_CARD_VALUES; ++v) {
+		if (!shoe->_counts[v - 1])
+			continue;
+		double p = (double)shoe->_counts[v - 1] / shoe->_total;
+
+		shoe_take(shoe, v);
+		const double* next = dealer_ev(cache, shoe, hard + v, ace || v == 1, false, child);
+		for (int s = first_draw; s < STAND_VALUES; ++s)
+			out[s] += p * next[s];
+		shoe_put(shoe, v);
+	}
+
+	entry = (Ev_dealer_entry_t*)table_store(cache, &cache->_dealer, shoe->_key, state);
+	memcpy(entry->_ev, out, sizeof(entry->_ev));
+	return out;
+}
+
+static void table_create(Ev_table_t* table, size_t entries, size_t entry_size) {
+	size_t size = 1;
+
+	while (size < entries) {
+		size <<= 1;
+	}
+	table->_entries = (uint8_t*)calloc(size, entry_size);
+	assert_condition(table->_entries, "Error: function[create_ev_cache()]: Failed allocating memory for cache entries");
+	table->_entry_size = entry_size;
+	table->_mask = size - 1;
+	table->_count = 0;
+}
+
+static inline Ev_key_t* table_entry(Ev_table_t* table, size_t i) {
+	return (Ev_key_t*)(table->_entries + i * table->_entry_size);
+}
+
+static inline size_t table_slot(const Ev_table_t* table, uint64_t counts, uint16_t state) {
+	uint64_t hash = (counts ^ ((uint64_t)state << 48) ^ state) * 0x9E3779B97F4A7C15ULL;
+	return (size_t)(hash >> 32) & table->_mask;
+}
+
+//Linear probing. Returns the entry of (counts, state), or NULL.
+static void* table_find(Ev_cache_t* cache, Ev_table_t* table, uint64_t counts, uint16_t state) {
+	for (size_t i = table_slot(table, counts, state); table_entry(table, i)->_used; i = (i + 1) & table->_mask) {
+		Ev_key_t* key = table_entry(table, i);
+		if (key->_counts == counts && key->_state == state) {
+			cache->_hits++;
+			return key;
+		}
+	}
+	cache->_misses++;
+	return NULL;
+}
+
+//Returns a new entry for (counts, state), which is not in the table. A too full table is cleared first.
+static void* table_store(Ev_cache_t* cache, Ev_table_t* table, uint64_t counts, uint16_t state) {
+	size_t i;
+
+	if (table->_count * MAX_LOAD_DEN >= (table->_mask + 1) * MAX_LOAD_NUM) {
+		memset(table->_entries, 0, (table->_mask + 1) * table->_entry_size);
+		table->_count = 0;
+		cache->_resets++;
+	}
+	for (i = table_slot(table, counts, state); table_entry(table, i)->_used; i = (i + 1) & table->_mask) {}
+
+	Ev_key_t* key = table_entry(table, i);
+	key->_used = true;
+	key->_counts = counts;
+	key->_state = state;
+	table->_count++;
+	return key;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
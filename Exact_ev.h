@@ -0,0 +1,61 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the exact expected value calculator: the EV of hitting and of standing, computed by
+ *              recursing over the unseen cards composition (no sampling), under the rules of Black_Jack.c
+ *              (see Strategy.h). The dealer's outcomes (for every value the player may stand on) are memoized
+ *              in a hash cache keyed by the packed card values counts, as are the player's hands EVs, so repeated
+ *              queries on similar compositions (e.g. after a hit) cost microseconds.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include "Black_Jack.h"
+
+#define EV_CARD_VALUES 10         //card values: Ace(1), 2, ..., 9, 10 (ten cards)
+#define EV_DEFAULT_ENTRIES (1 << 16)
+
+//An open addressing hash table of fixed size entries. Cleared as a whole when it gets too full to probe fast.
+typedef struct Ev_table {
+	uint8_t* _entries;
+	size_t _entry_size;
+	size_t _mask;             //entries - 1 (entries is a power of 2)
+	size_t _count;
+}Ev_table_t;
+
+//Memoized results: the dealer's outcomes and the player's hands EVs
+typedef struct Ev_cache {
+	Ev_table_t _dealer;
+	Ev_table_t _player;
+	uint64_t _hits;
+	uint64_t _misses;
+	uint64_t _resets;
+}Ev_cache_t;
+
+typedef struct Ev_result {
+	double _stand;            //player's EV per unit bet standing now
+	double _hit;              //hitting now, then playing on the best way
+}Ev_result_t;
+
+//exact_ev_decide() context: the table whose shoe is looked at, and its cache
+typedef struct Ev_player {
+	Ev_cache_t* _cache;
+	Table_t* _table;
+}Ev_player_t;
+
+//Creates a cache of at least 'entries' entries per table (0: EV_DEFAULT_ENTRIES)
+Ev_cache_t* create_ev_cache(size_t entries);
+void clear_ev_cache(Ev_cache_t* cache);
+
+//EV of the player's hand ('hard' sum, Aces counted as 1) against the dealer's up card value (1-10), with the cards
+//still to be drawn given by 'counts' (counts[v - 1]: cards of value v). The dealer's hole card is one of them.
+//Returns: FAIL for invalid arguments, otherwise SUCCESS.
+int exact_ev(Ev_cache_t* cache, const uint8_t* counts, uint8_t hard, bool ace, uint8_t up_value, Ev_result_t* result);
+
+//Same, for the table's round in play: the unseen cards are the shoe cards and the dealer's hole card.
+//(Discards reshuffled in when the shoe runs out during the round are not accounted for.)
+int exact_ev_table(Ev_cache_t* cache, Table_t* table, Ev_result_t* result);
+
+//hit_stand_decision playing the best EV, 'ctx' is an Ev_player_t*
+char exact_ev_decide(Player_t* player, Player_t* dealer, void* ctx);
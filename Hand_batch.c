@@ -0,0 +1,237 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the batch hand evaluator.
+ *              A kernel loads one card slot of 16 (SSE2) or 32 (AVX2) hands at a time, and decodes the cards
+ *              with byte operations: rank = card >> 2, value = min(rank + 1, 10), ace = (rank == 0). Every kernel
+ *              takes a byte of CARDS_COUNT or more (CARD_NONE or not) as an empty slot, so all give the same results.
+ *              Hands left over from the vector width are evaluated by the scalar kernel. The widest kernel the CPU
+ *              supports is picked once, on the first call.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<string.h>
+#include<pthread.h>
+#include "Hand_batch.h"
+
+#if defined(__x86_64__) //SSE2 is the x86-64 baseline (32 bits x86 builds run the scalar kernel)
+#define HAND_BATCH_X86
+#include<immintrin.h>
+#endif
+
+
+#define FAIL -1
+#define SUCCESS 0
+#define BLACK_JACK 21
+
+typedef size_t (*hand_kernel_t)(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result);
+
+//The widest kernel the CPU supports, picked once by select_kernel() (NULL: the scalar kernel only)
+static pthread_once_t kernel_once = PTHREAD_ONCE_INIT;
+static hand_kernel_t kernel_widest = NULL;
+static const char* kernel_widest_name = "scalar";
+
+
+//scalar kernel: evaluates the hands [first, hands). Returns 'hands'
+static size_t kernel_scalar(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result, size_t first) {
+	for (size_t h = first; h < hands; ++h) {
+		uint8_t hard = 0, aces = 0, count = 0;
+
+		for (size_t s = 0; s < max_cards; ++s) {
+			uint8_t card = cards[s * hands + h];
+			if (card >= CARDS_COUNT)
+				continue; //empty slot (as in the vector kernels)
+			hard += card_value[card];
+			aces += card_is_ace[card];
+			count++;
+		}
+		uint8_t soft = aces && hard + 10 <= BLACK_JACK;
+		uint8_t value = hard + (soft ? 10 : 0);
+
+		result->_hard[h] = hard;
+		result->_aces[h] = aces;
+		result->_value[h] = value;
+		result->_flags[h] = (soft ? HAND_SOFT : 0) | (value > BLACK_JACK ? HAND_BUST : 0) |
+		                    (value == BLACK_JACK ? HAND_21 : 0) | (value == BLACK_JACK && count == 2 ? HAND_NATURAL : 0);
+	}
+	return hands;
+}
+
+#ifdef HAND_BATCH_X86
+
+//SSE2 kernel (x86-64 baseline). Returns number of hands evaluated (a multiple of 16)
+static size_t kernel_sse2(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result) {
+	const __m128i last = _mm_set1_epi8(CARDS_COUNT - 1);
+	const __m128i rank_mask = _mm_set1_epi8(0x0F);
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i ten = _mm_set1_epi8(10);
+	const __m128i eleven = _mm_set1_epi8(11);
+	const __m128i twenty_one = _mm_set1_epi8(BLACK_JACK);
+	const __m128i twenty_two = _mm_set1_epi8(BLACK_JACK + 1);
+	const __m128i two = _mm_set1_epi8(2);
+	size_t h = 0;
+
+	for (; h + 16 <= hands; h += 16) {
+		__m128i hard = _mm_setzero_si128(), aces = _mm_setzero_si128(), count = _mm_setzero_si128();
+
+		for (size_t s = 0; s < max_cards; ++s) {
+			__m128i card = _mm_loadu_si128((const __m128i*)(cards + s * hands + h));
+			__m128i valid = _mm_cmpeq_epi8(_mm_min_epu8(card, last), card); //card < CARDS_COUNT, else an empty slot
+			__m128i rank = _mm_and_si128(_mm_srli_epi16(card, 2), rank_mask);
+			__m128i value = _mm_min_epu8(_mm_add_epi8(rank, one), ten);
+			__m128i ace = _mm_and_si128(_mm_cmpeq_epi8(rank, _mm_setzero_si128()), one);
+
+			hard = _mm_add_epi8(hard, _mm_and_si128(value, valid));
+			aces = _mm_add_epi8(aces, _mm_and_si128(ace, valid));
+			count = _mm_add_epi8(count, _mm_and_si128(one, valid));
+		}
+		//soft: an Ace and hard <= 11
+		__m128i has_ace = _mm_andnot_si128(_mm_cmpeq_epi8(aces, _mm_setzero_si128()), _mm_set1_epi8(-1));
+		__m128i low = _mm_cmpeq_epi8(_mm_min_epu8(hard, eleven), hard);
+		__m128i soft = _mm_and_si128(has_ace, low);
+		__m128i value = _mm_add_epi8(hard, _mm_and_si128(soft, ten));
+		__m128i bust = _mm_cmpeq_epi8(_mm_max_epu8(value, twenty_two), value);
+		__m128i is21 = _mm_cmpeq_epi8(value, twenty_one);
+		__m128i natural = _mm_and_si128(is21, _mm_cmpeq_epi8(count, two));
+		__m128i flags = _mm_or_si128(_mm_or_si128(_mm_and_si128(soft, _mm_set1_epi8(HAND_SOFT)), _mm_and_si128(bust, _mm_set1_epi8(HAND_BUST))),
+		                             _mm_or_si128(_mm_and_si128(is21, _mm_set1_epi8(HAND_21)), _mm_and_si128(natural, _mm_set1_epi8(HAND_NATURAL))));
+
+		_mm_storeu_si128((__m128i*)(result->_hard + h), hard);
+		_mm_storeu_si128((__m128i*)(result->_aces + h), aces);
+		_mm_storeu_si128((__m128i*)(result->_value + h), value);
+		_mm_storeu_si128((__m128i*)(result->_flags + h), flags);
+	}
+	return h;
+}
+
+//AVX2 kernel. Returns number of hands evaluated (a multiple of 32)
+__attribute__((target("avx2")))
+static size_t kernel_avx2(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result) {
+	const __m256i last = _mm256_set1_epi8(CARDS_COUNT - 1);
+	const __m256i all = _mm256_set1_epi8(-1);
+	const __m256i rank_mask = _mm256_set1_epi8(0x0F);
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i ten = _mm256_set1_epi8(10);
+	const __m256i eleven = _mm256_set1_epi8(11);
+	const __m256i twenty_one = _mm256_set1_epi8(BLACK_JACK);
+	const __m256i twenty_two = _mm256_set1_epi8(BLACK_JACK + 1);
+	const __m256i two = _mm256_set1_epi8(2);
+	size_t h = 0;
+
+	for (; h + 32 <= hands; h += 32) {
+		__m256i hard = _mm256_setzero_si256(), aces = _mm256_setzero_si256(), count = _mm256_setzero_si256();
+
+		for (size_t s = 0; s < max_cards; ++s) {
+			__m256i card = _mm256_loadu_si256((const __m256i*)(cards + s * hands + h));
+			__m256i valid = _mm256_cmpeq_epi8(_mm256_min_epu8(card, last), card);
+			__m256i rank = _mm256_and_si256(_mm256_srli_epi16(card, 2), rank_mask);
+			__m256i value = _mm256_min_epu8(_mm256_add_epi8(rank, one), ten);
+			__m256i ace = _mm256_and_si256(_mm256_cmpeq_epi8(rank, _mm256_setzero_si256()), one);
+
+			hard = _mm256_add_epi8(hard, _mm256_and_si256(value, valid));
+			aces = _mm256_add_epi8(aces, _mm256_and_si256(ace, valid));
+			count = _mm256_add_epi8(count, _mm256_and_si256(one, valid));
+		}
+		__m256i has_ace = _mm256_andnot_si256(_mm256_cmpeq_epi8(aces, _mm256_setzero_si256()), all);
+		__m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(hard, eleven), hard);
+		__m256i soft = _mm256_and_si256(has_ace, low);
+		__m256i value = _mm256_add_epi8(hard, _mm256_and_si256(soft, ten));
+		__m256i bust = _mm256_cmpeq_epi8(_mm256_max_epu8(value, twenty_two), value);
+		__m256i is21 = _mm256_cmpeq_epi8(value, twenty_one);
+		__m256i natural = _mm256_and_si256(is21, _mm256_cmpeq_epi8(count, two));
+		__m256i flags = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(soft, _mm256_set1_epi8(HAND_SOFT)), _mm256_and_si256(bust, _mm256_set1_epi8(HAND_BUST))),
+		                                _mm256_or_si256(_mm256_and_si256(is21, _mm256_set1_epi8(HAND_21)), _mm256_and_si256(natural, _mm256_set1_epi8(HAND_NATURAL))));
+
+		_mm256_storeu_si256((__m256i*)(result->_hard + h), hard);
+		_mm256_storeu_si256((__m256i*)(result->_aces + h), aces);
+		_mm256_storeu_si256((__m256i*)(result->_value + h), value);
+		_mm256_storeu_si256((__m256i*)(result->_flags + h), flags);
+	}
+	return h;
+}
+
+#endif //HAND_BATCH_X86
+
+//picks the widest kernel the CPU supports (run once, see widest_kernel())
+static void select_kernel(void) {
+#ifdef HAND_BATCH_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		kernel_widest = kernel_avx2;
+		kernel_widest_name = "avx2";
+		return;
+	}
+	kernel_widest = kernel_sse2;
+	kernel_widest_name = "sse2";
+#endif
+}
+
+//the kernel selected on the first call. Returns NULL for the scalar kernel only
+static hand_kernel_t widest_kernel(const char** name) {
+	pthread_once(&kernel_once, select_kernel);
+	*name = kernel_widest_name;
+	return kernel_widest;
+}
+
+static int check_args(const uint8_t* cards, size_t max_cards, Hand_batch_result_t* result) {
+	if (!cards || !result || !result->_hard || !result->_aces || !result->_value || !result->_flags) {
+		fprintf(stderr, "Warning: function[evaluate_hands()]: Null pointer provided\n");
+		return FAIL;
+	}
+	if (max_cards > HAND_BATCH_MAX_CARDS) {
+		fprintf(stderr, "Warning: function[evaluate_hands()]: Argument 'max_cards' = %zu. Cannot be larger than %d\n", max_cards, HAND_BATCH_MAX_CARDS);
+		return FAIL;
+	}
+	return SUCCESS;
+}
+
+int evaluate_hands(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result) {
+	if (check_args(cards, max_cards, result) != SUCCESS)
+		return FAIL;
+
+	const char* name = NULL;
+	hand_kernel_t kernel = widest_kernel(&name);
+	size_t done = kernel ? kernel(cards, hands, max_cards, result) : 0;
+	kernel_scalar(cards, hands, max_cards, result, done); //hands left over from the vector width
+	return SUCCESS;
+}
+
+int evaluate_hands_scalar(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result) {
+	if (check_args(cards, max_cards, result) != SUCCESS)
+		return FAIL;
+
+	kernel_scalar(cards, hands, max_cards, result, 0);
+	return SUCCESS;
+}
+
+int evaluate_hands_kernel(const char* kernel, const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result) {
+	if (check_args(cards, max_cards, result) != SUCCESS)
+		return FAIL;
+
+	const char* widest = NULL;
+	size_t done = 0;
+	widest_kernel(&widest);
+	if (kernel && !strcmp(kernel, "scalar")) {
+		done = 0;
+	}
+#ifdef HAND_BATCH_X86
+	else if (kernel && !strcmp(kernel, "sse2")) {
+		done = kernel_sse2(cards, hands, max_cards, result);
+	}
+	else if (kernel && !strcmp(kernel, "avx2") && !strcmp(widest, "avx2")) {
+		done = kernel_avx2(cards, hands, max_cards, result);
+	}
+#endif
+	else {
+		fprintf(stderr, "Warning: function[evaluate_hands_kernel()]: Kernel '%s' is not run on this CPU\n", kernel ? kernel : "(null)");
+		return FAIL;
+	}
+	kernel_scalar(cards, hands, max_cards, result, done);
+	return SUCCESS;
+}
+
+const char* hand_batch_kernel(void) {
+	const char* name = NULL;
+	widest_kernel(&name);
+	return name;
+}
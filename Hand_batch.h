@@ -0,0 +1,38 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the batch hand evaluator: values of many hands at once, with SSE2/AVX2 kernels
+ *              chosen at runtime by the CPU (and a scalar fallback). Its results agree with calculate_hand_val().
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include"Cards.h"
+
+#define HAND_BATCH_MAX_CARDS 24 //keeps every hard total in a byte
+
+enum hand_flags { HAND_SOFT = 0x01, HAND_BUST = 0x02, HAND_21 = 0x04, HAND_NATURAL = 0x08 /*21 with two cards*/ };
+
+//Batch results, one entry per hand (arrays supplied by the caller, 'hands' bytes each)
+typedef struct Hand_batch_result {
+	uint8_t* _hard;   //cards sum, Aces counted as 1
+	uint8_t* _aces;
+	uint8_t* _value;  //hand value (as calculate_hand_val())
+	uint8_t* _flags;  //hand_flags
+}Hand_batch_result_t;
+
+//Evaluates 'hands' hands packed by card slot: the card in slot s of hand h is cards[s * hands + h]
+//(suit_rank encoding, 0-51), and slots a hand does not use hold CARD_NONE (every kernel takes any byte of CARDS_COUNT
+//or more as an empty slot). 'max_cards' slots, up to HAND_BATCH_MAX_CARDS.
+//Returns: FAIL for invalid arguments, otherwise SUCCESS.
+int evaluate_hands(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result);
+
+//Same, forcing the scalar kernel (reference and fallback)
+int evaluate_hands_scalar(const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result);
+
+//Same, on a named kernel: "avx2", "sse2" or "scalar" (e.g. to check or time each kernel)
+//Returns: FAIL for invalid arguments or a kernel this CPU (or build) does not run, otherwise SUCCESS.
+int evaluate_hands_kernel(const char* kernel, const uint8_t* cards, size_t hands, size_t max_cards, Hand_batch_result_t* result);
+
+//Name of the kernel evaluate_hands() runs on this CPU: "avx2", "sse2" or "scalar"
+const char* hand_batch_kernel(void);
@@ -0,0 +1,395 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the binary hand history.
+ *              File layout (integers little endian):
+ *                header:  "BJHH", version, decks, 2 reserved bytes, then the shoe's capacity, cards left, discards
+ *                         and cut card (4 bytes each), the generator state (RNG_STATE_SIZE bytes) and the shoe cards.
+ *                blocks:  payload bytes (4), rounds (4), then the rounds. A round never spans two blocks.
+ *                round:   flags, player cards count, dealer cards count, the player's cards, the dealer's cards,
+ *                         stake (varint), cash less the previous round's cash (zigzag varint), net win (zigzag varint).
+ *              history_verify() re-encodes every replayed round with the writer's own encoder and compares the bytes.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include "History.h"
+#include "Cards.h"
+
+
+#define HISTORY_MAGIC "BJHH"
+#define HISTORY_VERSION 1
+#define HEADER_SIZE (4 + 4 + 4 * 4 + RNG_STATE_SIZE) //shoe cards follow
+#define BLOCK_HEADER_SIZE 8
+#define VARINT_MAX_LEN 10
+#define MAX_RECORD_SIZE (3 + 2 * HISTORY_MAX_CARDS + 3 * VARINT_MAX_LEN)
+#define REPLAY_HOUSE_CASH (INT32_MAX / 2) //the replayed house never runs out of cash
+
+
+static void history_encode(History_writer_t* writer, Table_t* table);
+static int history_flush(History_writer_t* writer);
+static bool write_all(int fd, const uint8_t* data, size_t size);
+static char history_replay_decide(Player_t* player, Player_t* dealer, void* ctx);
+static void put_u32(uint8_t* out, uint32_t value);
+static uint32_t get_u32(const uint8_t* in);
+static size_t put_varint(uint8_t* out, uint64_t value);
+static bool get_varint(const uint8_t** in, const uint8_t* end, uint64_t* value);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+History_writer_t* create_history_writer(const char* path, Table_t* table) {
+	assert_condition(path && table, "Error: function[create_history_writer()]: Null path or table pointer provided");
+
+	Shoe_t* shoe = table->_deck;
+	size_t header_size = HEADER_SIZE + shoe->_capacity;
+
+	if (shoe->_in_play || table->_player._cards._count || table->_dealer._cards._count) {
+		fprintf(stderr, "Warning: function[create_history_writer()]: Cannot start a log in the middle of a round\n");
+		return NULL;
+	}
+	History_writer_t* writer = (History_writer_t*)calloc(1, sizeof(History_writer_t));
+	assert_condition(writer, "Error: function[create_history_writer()]: Failed allocating memory for new writer");
+	writer->_block = (uint8_t*)malloc(HISTORY_BLOCK_SIZE > header_size ? HISTORY_BLOCK_SIZE : header_size);
+	assert_condition(writer->_block, "Error: function[create_history_writer()]: Failed allocating memory for the block");
+
+	writer->_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (writer->_fd < 0) {
+		fprintf(stderr, "Warning: function[create_history_writer()]: Cannot create %s: %s\n", path, strerror(errno));
+		free(writer->_block);
+		free(writer);
+		return NULL;
+	}
+
+	//the table's snapshot
+	uint8_t* header = writer->_block;
+	memcpy(header, HISTORY_MAGIC, 4);
+	header[4] = HISTORY_VERSION;
+	header[5] = (uint8_t)(shoe->_capacity / CARDS_COUNT);
+	header[6] = header[7] = 0;
+	put_u32(header + 8, (uint32_t)shoe->_capacity);
+	put_u32(header + 12, (uint32_t)shoe->_count);
+	put_u32(header + 16, (uint32_t)shoe->_discards);
+	put_u32(header + 20, (uint32_t)shoe->_cut);
+	rng_save(&table->_rng, header + 24);
+	memcpy(header + HEADER_SIZE, shoe->_cards, shoe->_capacity);
+	if (!write_all(writer->_fd, header, header_size)) {
+		fprintf(stderr, "Warning: function[create_history_writer()]: Cannot write %s: %s\n", path, strerror(errno));
+		close(writer->_fd);
+		free(writer->_block);
+		free(writer);
+		return NULL;
+	}
+
+	writer->_bytes = header_size;
+	writer->_len = BLOCK_HEADER_SIZE;
+	writer->_table = table;
+	table->_history = writer;
+	return writer;
+}
+
+int clear_history_writer(History_writer_t* writer) {
+	if (!writer)
+		return SUCCESS;
+
+	int result = history_flush(writer);
+	if (writer->_table && writer->_table->_history == writer) {
+		writer->_table->_history = NULL;
+	}
+	if (writer->_fd >= 0 && close(writer->_fd) != 0) {
+		result = FAIL;
+	}
+	result = writer->_failed ? FAIL : result;
+	free(writer->_block);
+	free(writer);
+	return result;
+}
+
+void history_round_begin(History_writer_t* writer, Table_t* table) {
+	writer->_stake = table->_player._account._bet;
+	writer->_cash = table->_player._account._cash;
+}
+
+void history_round_end(History_writer_t* writer, Table_t* table) {
+	if (writer->_len + MAX_RECORD_SIZE > HISTORY_BLOCK_SIZE) {
+		history_flush(writer);
+	}
+	history_encode(writer, table);
+	writer->_block_rounds++;
+	writer->_rounds++;
+}
+
+//Appends the round to the block
+static void history_encode(History_writer_t* writer, Table_t* table) {
+	Account_t* account = &table->_player._account;
+	const Card_list_t* hands[2] = { &table->_player._cards, &table->_dealer._cards };
+	uint8_t* out = writer->_block + writer->_len;
+	int64_t net = ((int64_t)account->_cash + account->_bet) - (writer->_cash + writer->_stake);
+	int64_t cash_delta = writer->_cash - writer->_last_cash;
+
+	*out++ = history_round_flags(table);
+	for (int h = 0; h < 2; ++h) {
+		if (hands[h]->_count > HISTORY_MAX_CARDS) {
+			writer->_failed = true; //cannot happen under the game's rules
+		}
+		*out++ = (uint8_t)(hands[h]->_count < HISTORY_MAX_CARDS ? hands[h]->_count : HISTORY_MAX_CARDS);
+	}
+	for (int h = 0; h < 2; ++h) {
+		size_t count = hands[h]->_count < HISTORY_MAX_CARDS ? hands[h]->_count : HISTORY_MAX_CARDS;
+		memcpy(out, card_list_cdata(hands[h]), count);
+		out += count;
+	}
+	out += put_varint(out, writer->_stake);
+	out += put_varint(out, ((uint64_t)cash_delta << 1) ^ (uint64_t)(cash_delta >> 63)); //zigzag: small magnitudes, small varints
+	out += put_varint(out, ((uint64_t)net << 1) ^ (uint64_t)(net >> 63));
+
+	writer->_last_cash = writer->_cash;
+	writer->_len = out - writer->_block;
+}
+
+//Writes the block out (its header first) and starts a new one
+static int history_flush(History_writer_t* writer) {
+	if (writer->_len == BLOCK_HEADER_SIZE)
+		return SUCCESS;
+
+	put_u32(writer->_block, (uint32_t)(writer->_len - BLOCK_HEADER_SIZE));
+	put_u32(writer->_block + 4, writer->_block_rounds);
+	if (writer->_fd >= 0 && !write_all(writer->_fd, writer->_block, writer->_len)) {
+		fprintf(stderr, "Warning: function[history_flush()]: Failed writing %u rounds: %s\n", writer->_block_rounds, strerror(errno));
+		writer->_failed = true;
+	}
+	writer->_bytes += writer->_len;
+	writer->_len = BLOCK_HEADER_SIZE;
+	writer->_block_rounds = 0;
+	return writer->_failed ? FAIL : SUCCESS;
+}
+
+int history_open(History_reader_t* reader, const char* path) {
+	assert_condition(reader && path, "Error: function[history_open()]: Null reader or path pointer provided");
+
+	struct stat info;
+	int fd = open(path, O_RDONLY);
+
+	memset(reader, 0, sizeof(History_reader_t));
+	if (fd < 0 || fstat(fd, &info) != 0) {
+		fprintf(stderr, "Warning: function[history_open()]: Cannot open %s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return FAIL;
+	}
+	if ((size_t)info.st_size >= HEADER_SIZE) {
+		reader->_map = (const uint8_t*)mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd); //the mapping stays
+	if (!reader->_map || reader->_map == MAP_FAILED) {
+		fprintf(stderr, "Warning: function[history_open()]: Cannot map %s\n", path);
+		reader->_map = NULL;
+		return FAIL;
+	}
+	reader->_size = info.st_size;
+	madvise((void*)reader->_map, reader->_size, MADV_SEQUENTIAL);
+
+	reader->_shoe_size = get_u32(reader->_map + 8);
+	if (memcmp(reader->_map, HISTORY_MAGIC, 4) || reader->_map[4] != HISTORY_VERSION ||
+		reader->_shoe_size != (size_t)reader->_map[5] * CARDS_COUNT || HEADER_SIZE + reader->_shoe_size > reader->_size) {
+		fprintf(stderr, "Warning: function[history_open()]: %s is not a hand history log\n", path);
+		history_close(reader);
+		return FAIL;
+	}
+	reader->_decks = reader->_map[5];
+	reader->_snapshot = reader->_map;
+	reader->_pos = reader->_block_end = reader->_map + HEADER_SIZE + reader->_shoe_size;
+	return SUCCESS;
+}
+
+void history_close(History_reader_t* reader) {
+	if (reader && reader->_map) {
+		munmap((void*)reader->_map, reader->_size);
+		reader->_map = NULL;
+	}
+}
+
+int history_next(History_reader_t* reader, History_round_t* round) {
+	assert_condition(reader && round, "Error: function[history_next()]: Null reader or round pointer provided");
+
+	const uint8_t* end = reader->_map + reader->_size;
+	uint64_t stake = 0, cash_delta = 0, net = 0;
+
+	if (reader->_pos == reader->_block_end) { //next block
+		if (reader->_pos == end)
+			return 0;
+		if ((size_t)(end - reader->_pos) < BLOCK_HEADER_SIZE || get_u32(reader->_pos) > (size_t)(end - reader->_pos) - BLOCK_HEADER_SIZE)
+			return FAIL; //a truncated block
+		reader->_block_end = reader->_pos + BLOCK_HEADER_SIZE + get_u32(reader->_pos);
+		reader->_pos += BLOCK_HEADER_SIZE;
+		if (reader->_pos == reader->_block_end)
+			return history_next(reader, round);
+	}
+
+	const uint8_t* in = reader->_record = reader->_pos;
+	end = reader->_block_end;
+	if (end - in < 3)
+		return FAIL;
+	round->_flags = in[0];
+	round->_player_count = in[1];
+	round->_dealer_count = in[2];
+	in += 3;
+	if (round->_player_count > HISTORY_MAX_CARDS || round->_dealer_count > HISTORY_MAX_CARDS ||
+		end - in < round->_player_count + round->_dealer_count)
+		return FAIL;
+	memcpy(round->_player, in, round->_player_count);
+	in += round->_player_count;
+	memcpy(round->_dealer, in, round->_dealer_count);
+	in += round->_dealer_count;
+	if (!get_varint(&in, end, &stake) || !get_varint(&in, end, &cash_delta) || !get_varint(&in, end, &net))
+		return FAIL;
+
+	round->_stake = (uint32_t)stake;
+	round->_cash = reader->_last_cash + (int64_t)((cash_delta >> 1) ^ (0 - (cash_delta & 1)));
+	round->_net = (int64_t)((net >> 1) ^ (0 - (net & 1)));
+	reader->_last_cash = round->_cash;
+	reader->_pos = in;
+	return 1;
+}
+
+int history_verify(const char* path, uint64_t* rounds) {
+	History_reader_t reader;
+	History_round_t round;
+	History_writer_t replay = { 0 }; //encodes the replayed rounds in memory
+	Table_t table;
+	uint64_t verified = 0;
+	uint32_t hits = 0;
+	int next = 0, result = SUCCESS;
+
+	if (history_open(&reader, path) != SUCCESS)
+		return FAIL;
+
+	//a fresh table with the logged shoe and generator
+	const uint8_t* snapshot = reader._snapshot;
+	table_init_seeded(&table, true, 0);
+	table_set_shoe(&table, reader._decks, 1);
+	table._deck->_count = get_u32(snapshot + 12);
+	table._deck->_discards = get_u32(snapshot + 16);
+	table._deck->_cut = get_u32(snapshot + 20);
+	memcpy(table._deck->_cards, snapshot + HEADER_SIZE, reader._shoe_size);
+	if (rng_restore(&table._rng, snapshot + 24) != SUCCESS || table._deck->_count + table._deck->_discards != reader._shoe_size) {
+		fprintf(stderr, "Warning: function[history_verify()]: %s: invalid table snapshot\n", path);
+		result = FAIL;
+	}
+	strcpy(table._player._info._name, "Replay");
+	table._player._info._id = 1;
+	table._decide = history_replay_decide;
+	table._decide_ctx = &hits;
+
+	replay._fd = -1;
+	replay._block = (uint8_t*)malloc(MAX_RECORD_SIZE);
+	assert_condition(replay._block, "Error: function[history_verify()]: Failed allocating memory for the replay");
+	replay._table = &table;
+	table._history = &replay;
+
+	while (result == SUCCESS && (next = history_next(&reader, &round)) == 1) {
+		//the logged stake goes on the table out of the logged cash, and the logged decisions are played
+		table._player._account._cash = (int32_t)(round._cash + round._stake);
+		table._player._account._bet = 0;
+		table._auto_bet = round._stake;
+		table._dealer._account._cash = REPLAY_HOUSE_CASH;
+		hits = round._player_count > 2 ? round._player_count - 2 : 0;
+		replay._len = 0;
+
+		play_round(&table);
+		if (replay._len != (size_t)(reader._pos - reader._record) || memcmp(replay._block, reader._record, replay._len)) {
+			fprintf(stderr, "Warning: function[history_verify()]: %s: round %llu differs from its replay\n", path, (unsigned long long)verified + 1);
+			result = FAIL;
+			break;
+		}
+		verified++;
+	}
+	if (next == FAIL) {
+		fprintf(stderr, "Warning: function[history_verify()]: %s: corrupt log after %llu rounds\n", path, (unsigned long long)verified);
+		result = FAIL;
+	}
+
+	table._history = NULL;
+	table_clear(&table);
+	free(replay._block);
+	history_close(&reader);
+	if (rounds)
+		*rounds = verified;
+	return result;
+}
+
+//the logged decisions: the hits, then a stand
+static char history_replay_decide(Player_t* player, Player_t* dealer, void* ctx) {
+	uint32_t* hits = (uint32_t*)ctx;
+
+	if (*hits) {
+		(*hits)--;
+		return 'H';
+	}
+	return 'S';
+}
+
+static bool write_all(int fd, const uint8_t* data, size_t size) {
+	while (size) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		data += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+static void put_u32(uint8_t* out, uint32_t value) {
+	out[0] = (uint8_t)value;
+	out[1] = (uint8_t)(value >> 8);
+	out[2] = (uint8_t)(value >> 16);
+	out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+	return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+//LEB128: 7 bits per byte, low bits first, the high bit set on all bytes but the last
+static size_t put_varint(uint8_t* out, uint64_t value) {
+	size_t len = 0;
+
+	while (value >= 0x80) {
+		out[len++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[len++] = (uint8_t)value;
+	return len;
+}
+
+static bool get_varint(const uint8_t** in, const uint8_t* end, uint64_t* value) {
+	const uint8_t* pos = *in;
+	uint64_t result = 0;
+
+	for (int shift = 0; pos < end && shift < 64; shift += 7) {
+		uint8_t byte = *pos++;
+		result |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			*value = result;
+			*in = pos;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the binary hand history: an append-only log of the rounds played at a table.
+ *              The file starts with a snapshot of the table's shoe and random generator, then holds blocks of rounds.
+ *              A round is a few bytes: the result as bit flags, the cards in the suit_rank encoding (a byte each,
+ *              in draw order) and the stake, cash and net win as varints. The player's decisions are implied:
+ *              a hit for every card past the first two, then a stand when HISTORY_STOOD is set.
+ *              Rounds are buffered into large blocks (one write() per block), and the reader maps the whole file.
+ *              Since the snapshot is the table's state before the first round, replaying the logged stakes and
+ *              decisions on a fresh table deals the very same cards: history_verify() checks every round that way.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include "Black_Jack.h"
+
+#define HISTORY_BLOCK_SIZE (1 << 20)
+#define HISTORY_MAX_CARDS 32      //cards of a hand (more than any hand can draw before it is over)
+
+//Round flags: the outcome in the 2 low bits (enum round_outcome), then the round results
+enum history_flags {
+	HISTORY_OUTCOME_MASK = 0x03,
+	HISTORY_BLACK_JACK = 0x04,
+	HISTORY_PLAYER_BUST = 0x08,
+	HISTORY_DEALER_BUST = 0x10,
+	HISTORY_STOOD = 0x20      //the player's last decision was a stand (otherwise: the round ended on a hit or a black jack)
+};
+
+//The flags of the table's last round (read when the round is over)
+static inline uint8_t history_round_flags(const Table_t* table) {
+	return (uint8_t)(table->_outcome & HISTORY_OUTCOME_MASK) | (table->_black_jack ? HISTORY_BLACK_JACK : 0) |
+		(table->_player_bust ? HISTORY_PLAYER_BUST : 0) | (table->_dealer_bust ? HISTORY_DEALER_BUST : 0) |
+		(table->_stood ? HISTORY_STOOD : 0);
+}
+
+//A decoded round
+typedef struct History_round {
+	uint8_t _flags;
+	uint8_t _player_count;
+	uint8_t _dealer_count;
+	uint8_t _player[HISTORY_MAX_CARDS];
+	uint8_t _dealer[HISTORY_MAX_CARDS];
+	uint32_t _stake;          //bet on the table when the cards were dealt
+	int64_t _cash;            //player's cash once the stake was on the table
+	int64_t _net;             //player's win (negative: loss)
+}History_round_t;
+
+//Logs the rounds of one table (a writer is not thread safe: one per table)
+typedef struct History_writer {
+	int _fd;
+	Table_t* _table;
+	bool _failed;             //a write failed: the log is incomplete
+	uint64_t _rounds;
+	uint64_t _bytes;          //written to the file so far
+	int64_t _last_cash;       //previous round's _cash (cash is delta coded)
+	uint32_t _stake;          //the round in play (see history_round_begin())
+	int64_t _cash;
+	size_t _len;              //bytes in _block (block header included)
+	uint32_t _block_rounds;
+	uint8_t* _block;
+}History_writer_t;
+
+typedef struct History_reader {
+	const uint8_t* _map;
+	size_t _size;
+	const uint8_t* _pos;      //next round
+	const uint8_t* _record;   //the last decoded round's bytes (up to _pos)
+	const uint8_t* _block_end;
+	int64_t _last_cash;
+	uint8_t _decks;
+	size_t _shoe_size;
+	const uint8_t* _snapshot; //the table's shoe and generator before the first round
+}History_reader_t;
+
+//Creates the log file 'path' (replaced if it exists) and attaches it to the table: its rounds are logged from now on.
+//Must be called between rounds. Returns NULL in case of fail.
+History_writer_t* create_history_writer(const char* path, Table_t* table);
+
+//Writes the buffered rounds out, detaches from the table and closes the file.
+//Returns: FAIL if any round could not be written, otherwise SUCCESS.
+int clear_history_writer(History_writer_t* writer);
+
+//Game engine hooks (Black_Jack.c): once the stake is on the table, and when the round is over (hands not reset yet)
+void history_round_begin(History_writer_t* writer, Table_t* table);
+void history_round_end(History_writer_t* writer, Table_t* table);
+
+//Maps a log file. Returns: FAIL for a missing or invalid file, otherwise SUCCESS.
+int history_open(History_reader_t* reader, const char* path);
+void history_close(History_reader_t* reader);
+
+//Decodes the next round. Returns: 1 a round, 0 end of log, FAIL for a corrupt log.
+int history_next(History_reader_t* reader, History_round_t* round);
+
+//Replays the log on a fresh headless table (the logged stakes, cash and decisions), checking the cards dealt and
+//the results of every round. 'rounds' (optional) returns the rounds verified.
+//Returns: FAIL at the first round that differs (or a corrupt log), otherwise SUCCESS.
+int history_verify(const char* path, uint64_t* rounds);
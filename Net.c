@@ -0,0 +1,143 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the local sockets helpers.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/socket.h>
+#include<sys/un.h>
+#include<sys/resource.h>
+#include<netinet/in.h>
+#include<netinet/tcp.h>
+#include<arpa/inet.h>
+#include "Net.h"
+
+
+#define FAIL -1
+#define SUCCESS 0
+
+#define LISTEN_BACKLOG 4096
+
+
+//A parsed address: one of the two socket address kinds
+typedef struct Net_address {
+	int _family;
+	socklen_t _len;
+	union {
+		struct sockaddr_un _unix;
+		struct sockaddr_in _tcp;
+	};
+}Net_address_t;
+
+
+static int parse_address(const char* address, Net_address_t* parsed);
+
+
+int net_listen(const char* address) {
+	Net_address_t parsed;
+	int one = 1;
+	int fd = FAIL;
+
+	if (parse_address(address, &parsed) != SUCCESS)
+		return FAIL;
+
+	fd = socket(parsed._family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		fprintf(stderr, "Warning: function[net_listen()]: socket(): %s\n", strerror(errno));
+		return FAIL;
+	}
+	if (parsed._family == AF_UNIX) {
+		unlink(parsed._unix.sun_path);
+	}
+	else {
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	}
+	if (bind(fd, (struct sockaddr*)&parsed._unix, parsed._len) != 0 || listen(fd, LISTEN_BACKLOG) != 0) {
+		fprintf(stderr, "Warning: function[net_listen()]: Cannot listen on '%s': %s\n", address, strerror(errno));
+		close(fd);
+		return FAIL;
+	}
+	return fd;
+}
+
+int net_connect(const char* address) {
+	Net_address_t parsed;
+	int one = 1;
+	int fd = FAIL;
+
+	if (parse_address(address, &parsed) != SUCCESS)
+		return FAIL;
+
+	fd = socket(parsed._family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		fprintf(stderr, "Warning: function[net_connect()]: socket(): %s\n", strerror(errno));
+		return FAIL;
+	}
+	if (connect(fd, (struct sockaddr*)&parsed._unix, parsed._len) != 0) {
+		fprintf(stderr, "Warning: function[net_connect()]: Cannot connect to '%s': %s\n", address, strerror(errno));
+		close(fd);
+		return FAIL;
+	}
+	if (parsed._family == AF_INET) {
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); //a request is a single small line
+	}
+	return fd;
+}
+
+int net_set_nonblocking(int fd, bool nonblocking) {
+	int flags = fcntl(fd, F_GETFL, 0);
+
+	if (flags < 0)
+		return FAIL;
+	flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+	return fcntl(fd, F_SETFL, flags) == 0 ? SUCCESS : FAIL;
+}
+
+unsigned long net_raise_files_limit(void) {
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+		return 0;
+	if (limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+		getrlimit(RLIMIT_NOFILE, &limit);
+	}
+	return (unsigned long)limit.rlim_cur;
+}
+
+//"unix:<path>" or "tcp:<port>" (bound to/connecting the loopback address)
+static int parse_address(const char* address, Net_address_t* parsed) {
+	memset(parsed, 0, sizeof(Net_address_t));
+
+	if (address && !strncmp(address, "unix:", 5) && strlen(address + 5) > 0 &&
+		strlen(address + 5) < sizeof(parsed->_unix.sun_path)) {
+		parsed->_family = AF_UNIX;
+		parsed->_unix.sun_family = AF_UNIX;
+		strcpy(parsed->_unix.sun_path, address + 5);
+		parsed->_len = sizeof(struct sockaddr_un);
+		return SUCCESS;
+	}
+	if (address && !strncmp(address, "tcp:", 4)) {
+		char* end = NULL;
+		unsigned long port = strtoul(address + 4, &end, 10);
+
+		if (end != address + 4 && !*end && port > 0 && port <= 0xFFFF) {
+			parsed->_family = AF_INET;
+			parsed->_tcp.sin_family = AF_INET;
+			parsed->_tcp.sin_port = htons((uint16_t)port);
+			parsed->_tcp.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			parsed->_len = sizeof(struct sockaddr_in);
+			return SUCCESS;
+		}
+	}
+	fprintf(stderr, "Warning: function[parse_address()]: Invalid address '%s'. Expected \"unix:<path>\" or \"tcp:<port>\"\n",
+		address ? address : "(null)");
+	return FAIL;
+}
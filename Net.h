@@ -0,0 +1,23 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the local sockets helpers shared by the game server and its load client.
+ *              An address is "unix:<path>" (Unix-domain socket) or "tcp:<port>" (loopback TCP).
+ * Language:  C
+*/
+#include<stdbool.h>
+
+#define NET_DEFAULT_ADDRESS "unix:/tmp/bj_server.sock"
+
+//Creates a non blocking socket listening on 'address' (an existing Unix-domain socket file is replaced).
+//Returns: the socket, or FAIL (-1) in case of fail.
+int net_listen(const char* address);
+
+//Connects a blocking socket to 'address'. Returns: the socket, or FAIL (-1) in case of fail.
+int net_connect(const char* address);
+
+//Sets/clears the O_NONBLOCK flag of 'fd'. Returns: FAIL in case of fail, otherwise SUCCESS.
+int net_set_nonblocking(int fd, bool nonblocking);
+
+//Raises the process open files limit to its hard limit (a socket per session). Returns the new limit.
+unsigned long net_raise_files_limit(void);
@@ -0,0 +1,110 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the game's output layer: formatting goes straight into the render buffer
+ *              (no intermediate strings), and cards names are copied from the pre-formatted card_name[] table.
+ * Language:  C
+*/
+
+#include<stdlib.h>
+#include<string.h>
+#include "Render.h"
+
+
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+Render_t* create_render(enum render_level level, FILE* out) {
+	assert_condition(out, "Error: function[create_render()]: Argument FILE* is NULL");
+
+	if (level == RENDER_SILENT)
+		return NULL;
+
+	Render_t* render = (Render_t*)malloc(sizeof(Render_t));
+	assert_condition(render, "Error: function[create_render()]: Failed allocating memory for new render");
+	render->_level = level;
+	render->_out = out;
+	render->_len = 0;
+	return render;
+}
+
+void clear_render(Render_t* render) {
+	if (!render)
+		return;
+	render_flush(render);
+	free(render);
+}
+
+void render_printf(Render_t* render, const char* format, ...) {
+	va_list args;
+
+	va_start(args, format);
+	render_vprintf(render, format, args);
+	va_end(args);
+}
+
+void render_vprintf(Render_t* render, const char* format, va_list args) {
+	assert_condition(render && format, "Error: function[render_vprintf()]: Null render or format pointer provided");
+
+	va_list retry;
+	size_t room = RENDER_BUFFER_SIZE - render->_len;
+
+	va_copy(retry, args);
+	int len = vsnprintf(render->_buffer + render->_len, room, format, args);
+	if (len < 0) {
+		va_end(retry);
+		return;
+	}
+	if ((size_t)len >= room) { //did not fit: flushing what was there before and formatting again
+		render_flush(render);
+		if ((size_t)len < RENDER_BUFFER_SIZE)
+			vsnprintf(render->_buffer, RENDER_BUFFER_SIZE, format, retry);
+		else
+			vfprintf(render->_out, format, retry); //larger than the whole buffer
+		len = (size_t)len < RENDER_BUFFER_SIZE ? len : 0;
+	}
+	va_end(retry);
+	render->_len += (size_t)len;
+}
+
+void render_text(Render_t* render, const char* text, size_t len) {
+	assert_condition(render && text, "Error: function[render_text()]: Null render or text pointer provided");
+
+	if (len > RENDER_BUFFER_SIZE - render->_len) {
+		render_flush(render);
+		if (len > RENDER_BUFFER_SIZE) {
+			fwrite(text, 1, len, render->_out);
+			return;
+		}
+	}
+	memcpy(render->_buffer + render->_len, text, len);
+	render->_len += len;
+}
+
+void render_card(Render_t* render, uint8_t card) {
+	render_text(render, card_name[card], card_name_len[card]);
+}
+
+void render_cards(Render_t* render, const Card_list_t* cards, size_t start_pos, size_t end_pos) {
+	assert_condition(render && cards, "Error: function[render_cards()]: Null render or cards pointer provided");
+
+	const uint8_t* data = card_list_cdata(cards);
+	end_pos = end_pos < cards->_count ? end_pos : cards->_count;
+	for (size_t pos = start_pos ? start_pos : 1; pos <= end_pos; ++pos) {
+		render_card(render, data[pos - 1]);
+	}
+}
+
+void render_flush(Render_t* render) {
+	if (!render || !render->_len)
+		return;
+	fwrite(render->_buffer, 1, render->_len, render->_out);
+	fflush(render->_out);
+	render->_len = 0;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the game's output layer. Text is appended to a single buffer, written out in one call
+ *              when the round ends or before the game reads input (or when the buffer is full).
+ *              Every message has a verbosity level, and callers test render_on() before formatting anything, so a
+ *              silent table (no Render_t at all) does no formatting work.
+ * Language:  C
+*/
+#include<stdio.h>
+#include<stdarg.h>
+#include<stddef.h>
+#include<stdint.h>
+#include<stdbool.h>
+#include"Cards.h"
+
+#define RENDER_BUFFER_SIZE 8192
+
+enum render_level {
+	RENDER_SILENT,   //nothing
+	RENDER_SUMMARY,  //a line per round: the hands, the result and the cash
+	RENDER_FULL      //the whole interactive game transcript
+};
+
+typedef struct Render {
+	enum render_level _level;
+	FILE* _out;
+	size_t _len;
+	char _buffer[RENDER_BUFFER_SIZE];
+}Render_t;
+
+//Creates a render of the given level, writing to 'out'. Returns NULL for RENDER_SILENT (nothing to render).
+Render_t* create_render(enum render_level level, FILE* out);
+
+//Flushes and frees the render
+void clear_render(Render_t* render);
+
+//true when messages of 'level' are rendered ('render' may be NULL: silent)
+static inline bool render_on(const Render_t* render, enum render_level level) {
+	return render && render->_level >= level;
+}
+
+//Appends formatted text / raw text / a card's pre-formatted name
+void render_printf(Render_t* render, const char* format, ...);
+void render_vprintf(Render_t* render, const char* format, va_list args);
+void render_text(Render_t* render, const char* text, size_t len);
+void render_card(Render_t* render, uint8_t card);
+
+//Appends the names of the cards in positions start_pos - end_pos (range: 1-n) of a hand
+void render_cards(Render_t* render, const Card_list_t* cards, size_t start_pos, size_t end_pos);
+
+//Writes out the buffered text ('render' may be NULL)
+void render_flush(Render_t* render);
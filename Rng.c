@@ -0,0 +1,123 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of a fast seedable random numbers generator.
+ *              xoshiro256** by D. Blackman and S. Vigna, seeded by SplitMix64.
+ *              Bounded numbers by Lemire's multiply-shift with rejection (no modulo bias, rarely a division).
+ * Language:  C
+*/
+
+#include "Rng.h"
+#include "Stats.h"
+
+
+#define FAIL -1
+#define SUCCESS 0
+
+#define GOLDEN_GAMMA 0x9E3779B97F4A7C15ULL
+
+
+static inline uint64_t rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+//SplitMix64 step, used to expand a 64 bits seed into the generator state
+static uint64_t splitmix64(uint64_t* z) {
+	uint64_t r = (*z += GOLDEN_GAMMA);
+	r = (r ^ (r >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	r = (r ^ (r >> 27)) * 0x94D049BB133111EBULL;
+	return r ^ (r >> 31);
+}
+
+void rng_seed(Rng_t* rng, uint64_t seed) {
+	for (int i = 0; i < 4; ++i) {
+		rng->_s[i] = splitmix64(&seed);
+	}
+}
+
+uint64_t rng_next(Rng_t* rng) {
+	uint64_t* s = rng->_s;
+	const uint64_t result = rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+	STATS_COUNT(STATS_RNG_CALLS, 1);
+
+	return result;
+}
+
+void rng_jump(Rng_t* rng) {
+	static const uint64_t jump[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	uint64_t s[4] = { 0 };
+
+	for (int i = 0; i < 4; ++i) {
+		for (int b = 0; b < 64; ++b) {
+			if (jump[i] & (1ULL << b)) {
+				s[0] ^= rng->_s[0];
+				s[1] ^= rng->_s[1];
+				s[2] ^= rng->_s[2];
+				s[3] ^= rng->_s[3];
+			}
+			rng_next(rng);
+		}
+	}
+	for (int i = 0; i < 4; ++i) {
+		rng->_s[i] = s[i];
+	}
+}
+
+uint32_t rng_below(Rng_t* rng, uint32_t bound) {
+	uint64_t m = (rng_next(rng) >> 32) * (uint64_t)bound;
+	uint32_t low = (uint32_t)m;
+
+	if (low < bound) {
+		//rejecting the (2^32 mod bound) values that would make some results more likely
+		uint32_t threshold = (0u - bound) % bound;
+		while (low < threshold) {
+			m = (rng_next(rng) >> 32) * (uint64_t)bound;
+			low = (uint32_t)m;
+		}
+	}
+	return (uint32_t)(m >> 32);
+}
+
+void rng_fill(Rng_t* rng, uint64_t* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = rng_next(rng);
+	}
+}
+
+void rng_fill_below(Rng_t* rng, uint32_t bound, uint32_t* out, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		out[i] = rng_below(rng, bound);
+	}
+}
+
+void rng_save(const Rng_t* rng, uint8_t* state) {
+	for (int i = 0; i < 4; ++i) {
+		for (int b = 0; b < 8; ++b) {
+			state[i * 8 + b] = (uint8_t)(rng->_s[i] >> (8 * b));
+		}
+	}
+}
+
+int rng_restore(Rng_t* rng, const uint8_t* state) {
+	uint64_t s[4] = { 0 };
+
+	for (int i = 0; i < 4; ++i) {
+		for (int b = 0; b < 8; ++b) {
+			s[i] |= (uint64_t)state[i * 8 + b] << (8 * b);
+		}
+	}
+	if (!(s[0] | s[1] | s[2] | s[3])) { //xoshiro never leaves the all zero state
+		return FAIL;
+	}
+	for (int i = 0; i < 4; ++i) {
+		rng->_s[i] = s[i];
+	}
+	return SUCCESS;
+}
@@ -0,0 +1,40 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header file of a fast seedable random numbers generator (xoshiro256**).
+ *              Every table owns its own generator, so tables may run on different threads
+ *              and a given seed always reproduces the same game.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+
+#define RNG_STATE_SIZE 32 //bytes of a saved generator state
+
+//structs
+typedef struct Rng {
+	uint64_t _s[4];
+}Rng_t;
+
+//Seeds the generator (the 256 bits state is expanded from 'seed' by SplitMix64). Same seed -> same sequence.
+void rng_seed(Rng_t* rng, uint64_t seed);
+
+//Advances the generator by 2^128 draws. Calling it k times on copies of one generator gives k
+//non-overlapping independent streams (one per thread/table).
+void rng_jump(Rng_t* rng);
+
+//Returns the next 64 random bits
+uint64_t rng_next(Rng_t* rng);
+
+//Returns a random number in range 0 - (bound-1), without modulo bias. bound must be > 0
+uint32_t rng_below(Rng_t* rng, uint32_t bound);
+
+//Batch draws: fills 'out' with 'count' values (rng_next() / rng_below() results)
+void rng_fill(Rng_t* rng, uint64_t* out, size_t count);
+void rng_fill_below(Rng_t* rng, uint32_t bound, uint32_t* out, size_t count);
+
+//Saves the generator state into 'state' (RNG_STATE_SIZE bytes, little endian), to audit or replay a shuffle
+void rng_save(const Rng_t* rng, uint8_t* state);
+
+//Restores a state saved by rng_save(). Returns: FAIL for an invalid (all zero) state, otherwise SUCCESS.
+int rng_restore(Rng_t* rng, const uint8_t* state);
@@ -0,0 +1,250 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the precompiled rule variants (an engine per FOR_RULES_VARIANTS entry), their
+ *              runtime dispatch table, a basic strategy for all the actions, and the multi-threaded variant sweeps.
+ *              Link with Black_Jack.c compiled with -DBJ_NO_MAIN (and -pthread).
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>//sysconf()
+#include "Rules.h"
+
+#define MAX_THREADS 1024
+#define MAX_DECKS 8
+#define CARD_VALUES 10
+#define HARD_STANDS 17 //basic strategy: hard totals stood on against any up card
+#define SOFT_STANDS 19
+
+
+//A worker of rules_sweep(): its own shoe and generator stream
+typedef struct Rules_worker {
+	pthread_t _thread;
+	const Rules_t* _rules;
+	const Rules_sweep_t* _sweep;
+	Rng_t _rng;
+	uint64_t _rounds;
+	Rules_stats_t _stats;
+}Rules_worker_t;
+
+
+static void* rules_worker_run(void* arg);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+//the engines
+FOR_RULES_VARIANTS(RULES_VARIANT)
+
+#define RULES_ENTRY(name, h17, natural_num, natural_den, doubles, das, max_hands, surrender, insurance, bust_pays) \
+	{ #name, rules_round_##name, h17, natural_num, natural_den, doubles, das, max_hands, surrender, insurance, bust_pays },
+
+const Rules_t rules_variants[RULES_VARIANTS] = { FOR_RULES_VARIANTS(RULES_ENTRY) };
+
+
+//Basic strategy charts. Columns: dealer up card A 2 3 4 5 6 7 8 9 10.
+//H hit, S stand, D double (otherwise hit), d double (otherwise stand), R surrender (otherwise hit), P split.
+static const char* const basic_hard[HARD_STANDS] = { //by hard total (below 9: hit)
+	NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+	"HHDDDDHHHH", //9
+	"HDDDDDDDDH", //10
+	"HDDDDDDDDD", //11
+	"HHHSSSHHHH", //12
+	"HSSSSSHHHH", //13
+	"HSSSSSHHHH", //14
+	"HSSSSSHHHR", //15
+	"RSSSSSHHRR", //16
+};
+static const char* const basic_soft[SOFT_STANDS] = { //by soft total (Ace, Ace: 12)
+	NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+	"HHHHHHHHHH", //12
+	"HHHHDDHHHH", //13
+	"HHHHDDHHHH", //14
+	"HHHDDDHHHH", //15
+	"HHHDDDHHHH", //16
+	"HHDDDDHHHH", //17
+	"HSddddSSHH", //18
+};
+static const char* const basic_pairs[CARD_VALUES + 1] = { //by card value, when splitting is allowed
+	NULL,
+	"PPPPPPPPPP", //Aces
+	"HPPPPPPHHH", //2
+	"HPPPPPPHHH", //3
+	"HHHHPPHHHH", //4
+	NULL,         //5: a hard 10
+	"HPPPPPHHHH", //6
+	"HPPPPPPHHH", //7
+	"PPPPPPPPPP", //8
+	"SPPPPPSPPS", //9
+	NULL,         //10
+};
+
+
+const Rules_t* rules_find(const char* name) {
+	assert_condition(name, "Error: function[rules_find()]: Null name pointer provided");
+
+	for (int v = 0; v < RULES_VARIANTS; ++v) {
+		if (!strcmp(rules_variants[v]._name, name))
+			return &rules_variants[v];
+	}
+	return NULL;
+}
+
+bool rules_bet_exact(const Rules_t* rules, uint32_t bet) {
+	assert_condition(rules, "Error: function[rules_bet_exact()]: Null rules pointer provided");
+
+	if ((uint64_t)bet * rules->_natural_num % rules->_natural_den)
+		return false;
+	return !((rules->_surrender || rules->_insurance) && bet % 2);
+}
+
+int rules_basic_decide(const Rules_round_t* round, const Rules_hand_t* hand, unsigned int allowed, void* ctx) {
+	if (allowed == ACTION_INSURE)
+		return ACTION_STAND; //a losing bet without a count
+
+	uint8_t up = card_value[round->_up_card] - 1;
+	uint8_t value = hand->_hand._value;
+	const char* row = NULL;
+
+	if ((allowed & ACTION_SPLIT) && basic_pairs[card_value[hand->_first]] && basic_pairs[card_value[hand->_first]][up] == 'P')
+		return ACTION_SPLIT;
+	if (hand->_hand._soft)
+		row = value < SOFT_STANDS ? basic_soft[value] : NULL;
+	else
+		row = value < HARD_STANDS ? basic_hard[value] : NULL;
+
+	switch (row ? row[up] : (value >= HARD_STANDS ? 'S' : 'H')) {
+	case 'S':
+		return ACTION_STAND;
+	case 'D':
+		return (allowed & ACTION_DOUBLE) ? ACTION_DOUBLE : ACTION_HIT;
+	case 'd':
+		return (allowed & ACTION_DOUBLE) ? ACTION_DOUBLE : ACTION_STAND;
+	case 'R':
+		return (allowed & ACTION_SURRENDER) ? ACTION_SURRENDER : ACTION_HIT;
+	default:
+		return ACTION_HIT;
+	}
+}
+
+void rules_count_round(const Rules_round_t* round, Rules_stats_t* stats) {
+	stats->_rounds++;
+	stats->_bets += round->_bet;
+	stats->_wagered += round->_wagered;
+	stats->_net += round->_net;
+	stats->_black_jacks += round->_black_jack;
+	stats->_splits += round->_count - 1;
+	stats->_surrenders += round->_surrendered;
+	stats->_insurances += round->_insurance != 0;
+	for (uint8_t h = 0; h < round->_count; ++h) {
+		stats->_doubles += round->_hands[h]._doubled;
+		stats->_player_busts += round->_hands[h]._hand._bust;
+	}
+	stats->_dealer_busts += round->_dealer._hand._bust;
+}
+
+int rules_sweep(const Rules_t* rules, const Rules_sweep_t* sweep, Rules_stats_t* stats) {
+	assert_condition(rules && sweep && stats, "Error: function[rules_sweep()]: Null rules, sweep or stats pointer provided");
+
+	Rules_worker_t* workers = NULL;
+	Rng_t stream;
+	struct timespec start, end;
+	unsigned int threads = sweep->_threads;
+	int result = SUCCESS;
+
+	if (sweep->_decks < 1 || sweep->_decks > MAX_DECKS || sweep->_penetration <= 0 || sweep->_penetration > 1 || !sweep->_bet) {
+		fprintf(stderr, "Warning: function[rules_sweep()]: %u decks, penetration %.2f, bet %u. Must be 1-%d decks, penetration (0-1], bet > 0\n",
+			sweep->_decks, sweep->_penetration, sweep->_bet, MAX_DECKS);
+		return FAIL;
+	}
+	if (!rules_bet_exact(rules, sweep->_bet)) {
+		fprintf(stderr, "Warning: function[rules_sweep()]: bet %u. %s pays a fraction of it (natural %u:%u%s)\n",
+			sweep->_bet, rules->_name, rules->_natural_num, rules->_natural_den,
+			rules->_surrender || rules->_insurance ? ", half bet insurance / surrender" : "");
+		return FAIL;
+	}
+	if (!threads) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned int)cores : 1;
+	}
+	if (threads > MAX_THREADS) {
+		threads = MAX_THREADS;
+	}
+
+	workers = (Rules_worker_t*)calloc(threads, sizeof(Rules_worker_t));
+	assert_condition(workers, "Error: function[rules_sweep()]: Failed allocating memory for workers");
+
+	//rounds split evenly, the remainder goes to the first workers
+	rng_seed(&stream, sweep->_seed);
+	for (unsigned int i = 0; i < threads; ++i) {
+		workers[i]._rules = rules;
+		workers[i]._sweep = sweep;
+		workers[i]._rng = stream;
+		workers[i]._rounds = sweep->_rounds / threads + (i < sweep->_rounds % threads);
+		rng_jump(&stream); //next worker's stream
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (unsigned int i = 0; i < threads; ++i) {
+		if (pthread_create(&workers[i]._thread, NULL, rules_worker_run, &workers[i]) != 0) {
+			fprintf(stderr, "Warning: function[rules_sweep()]: Failed creating worker %u. Running it on this thread\n", i);
+			rules_worker_run(&workers[i]);
+			workers[i]._thread = 0;
+		}
+	}
+	memset(stats, 0, sizeof(Rules_stats_t));
+	for (unsigned int i = 0; i < threads; ++i) {
+		if (workers[i]._thread)
+			pthread_join(workers[i]._thread, NULL);
+
+		const Rules_stats_t* from = &workers[i]._stats;
+		stats->_rounds += from->_rounds;
+		stats->_bets += from->_bets;
+		stats->_wagered += from->_wagered;
+		stats->_net += from->_net;
+		stats->_black_jacks += from->_black_jacks;
+		stats->_doubles += from->_doubles;
+		stats->_splits += from->_splits;
+		stats->_surrenders += from->_surrenders;
+		stats->_insurances += from->_insurances;
+		stats->_player_busts += from->_player_busts;
+		stats->_dealer_busts += from->_dealer_busts;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	stats->_seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	free(workers);
+	return result;
+}
+
+static void* rules_worker_run(void* arg) {
+	Rules_worker_t* worker = (Rules_worker_t*)arg;
+	const Rules_sweep_t* sweep = worker->_sweep;
+	rules_round_engine play = worker->_rules->_play; //resolved once: the rounds run the variant's own engine
+	rules_decision decide = sweep->_decide ? sweep->_decide : rules_basic_decide;
+	Shoe_t* shoe = create_shoe((size_t)sweep->_decks * CARDS_COUNT, &worker->_rng);
+	Rules_round_t round;
+
+	for (uint8_t d = 0; d < sweep->_decks; ++d) {
+		fill_shoe(shoe, card_codes, CARDS_COUNT);
+	}
+	shuffle_shoe(shoe);
+	set_shoe_penetration(shoe, sweep->_penetration);
+
+	for (uint64_t r = 0; r < worker->_rounds; ++r) {
+		play(shoe, sweep->_bet, decide, sweep->_ctx, &round);
+		rules_count_round(&round, &worker->_stats);
+	}
+	clear_shoe(shoe);
+	return NULL;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
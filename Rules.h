@@ -0,0 +1,312 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the blackjack rule sets.
+ *              HOUSE_*: the table game's own rules (Black_Jack.c, and the strategy and exact EV computed for them).
+ *              Casino variants: RULES_VARIANT(name, ...) instantiates a round engine, rules_round_<name>(), whose every
+ *              rule is a compile time constant: the generic round (rules_round_body()) is forced inline into it with
+ *              its rules as literal arguments, so the rule checks fold away and no rule flag is tested per hand.
+ *              The FOR_RULES_VARIANTS set is precompiled in Rules.c, and dispatched at runtime through rules_variants[]
+ *              (one indirect call per round). A variant round deals from a Shoe_t and supports doubling, splitting
+ *              (split Aces get one card each), late surrender, insurance, and a dealer hitting or standing on soft 17.
+ *              The dealer peeks: a dealer natural ends the round before the player acts.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stdbool.h>
+#include<string.h>
+#include "Black_Jack.h"
+#include "Shoe.h"
+#include "Cards.h"
+
+//The table game's rules
+#define BLACK_JACK 21
+#define HOUSE_DEALER_STANDS 17       //the dealer draws below it (and while not ahead of the player)
+#define HOUSE_NATURAL_PAYS 1.5       //a natural on the initial deal
+#define HOUSE_DEALER_BUST_PAYS 2.0   //times the bet
+//(a hit reaching 21 wins 1 at once, the dealer's 21 wins, and no double, split, surrender or insurance)
+
+#define RULES_MAX_HANDS 4            //hands of a round, splits included
+#define RULES_INLINE inline __attribute__((always_inline))
+
+enum rules_double { RULES_DOUBLE_NONE, RULES_DOUBLE_ANY, RULES_DOUBLE_9_11, RULES_DOUBLE_10_11 /*hard totals*/ };
+
+//The player's actions (bits of a decision's 'allowed' mask)
+enum rules_action { ACTION_HIT = 1, ACTION_STAND = 2, ACTION_DOUBLE = 4, ACTION_SPLIT = 8, ACTION_SURRENDER = 16, ACTION_INSURE = 32 };
+
+//The precompiled variants: name, dealer hits soft 17, natural pays num:den, doubles, double after split,
+//max hands (1: no split), late surrender, insurance, dealer bust pays (times the stake)
+#define FOR_RULES_VARIANTS(X) \
+	X(vegas_strip,    true,  3, 2, RULES_DOUBLE_ANY,   true,  4, true,  true,  1) \
+	X(downtown,       true,  3, 2, RULES_DOUBLE_ANY,   true,  4, false, true,  1) \
+	X(reno,           true,  3, 2, RULES_DOUBLE_10_11, false, 4, false, true,  1) \
+	X(european,       false, 3, 2, RULES_DOUBLE_9_11,  false, 2, false, true,  1) \
+	X(six_to_five,    true,  6, 5, RULES_DOUBLE_ANY,   true,  4, false, true,  1) \
+	X(no_options,     false, 3, 2, RULES_DOUBLE_NONE,  false, 1, false, false, 1) \
+	X(house_payouts,  false, 3, 2, RULES_DOUBLE_NONE,  false, 1, false, false, 2)
+
+#define RULES_ENUM(name, ...) VARIANT_##name,
+enum rules_variant { FOR_RULES_VARIANTS(RULES_ENUM) RULES_VARIANTS };
+
+//STRUCTS
+typedef struct Rules_hand {
+	Hand_t _hand;
+	uint8_t _cards;     //cards count
+	uint8_t _first;     //first and last cards (suit_rank): a two cards hand is a pair when both have the same value
+	uint8_t _last;
+	bool _split;        //the hand comes from a split
+	bool _doubled;
+	uint32_t _stake;
+}Rules_hand_t;
+
+typedef struct Rules_round {
+	Rules_hand_t _hands[RULES_MAX_HANDS];
+	Rules_hand_t _dealer;
+	uint8_t _count;          //hands played: more than 1 after splits
+	uint8_t _up_card;        //the dealer's up card (suit_rank)
+	bool _black_jack;        //the player's natural
+	bool _dealer_black_jack;
+	bool _surrendered;
+	uint32_t _bet;           //the initial stake
+	uint32_t _insurance;     //the insurance stake (0: not taken)
+	uint64_t _wagered;       //all the stakes: initial, doubles, splits and insurance
+	int64_t _net;            //the player's net win
+}Rules_round_t;
+
+//Decision source of a variant round. Returns one of the actions set in 'allowed' (any other: stand).
+//Insurance is offered first, alone ('allowed' == ACTION_INSURE): any other reply declines it.
+typedef int (*rules_decision)(const Rules_round_t* round, const Rules_hand_t* hand, unsigned int allowed, void* ctx);
+
+//A variant's round engine: plays a round of 'bet' from the shoe (reshuffled first when the cut card is out), and
+//discards its cards. 'round' gets the whole round. Returns: the player's net win.
+//Payouts are integers: 'bet' must pass rules_bet_exact(), otherwise the fractional payouts are truncated.
+typedef int64_t (*rules_round_engine)(Shoe_t* shoe, uint32_t bet, rules_decision decide, void* ctx, Rules_round_t* round);
+
+typedef struct Rules {
+	const char* _name;
+	rules_round_engine _play;
+	bool _h17;
+	uint8_t _natural_num;
+	uint8_t _natural_den;
+	enum rules_double _double;
+	bool _double_after_split;
+	uint8_t _max_hands;
+	bool _surrender;
+	bool _insurance;
+	uint8_t _dealer_bust_pays;
+}Rules_t;
+
+//Results of many variant rounds
+typedef struct Rules_stats {
+	uint64_t _rounds;
+	uint64_t _bets;          //initial stakes
+	uint64_t _wagered;       //all the stakes
+	int64_t _net;
+	uint64_t _black_jacks;
+	uint64_t _doubles;
+	uint64_t _splits;
+	uint64_t _surrenders;
+	uint64_t _insurances;
+	uint64_t _player_busts;  //hands
+	uint64_t _dealer_busts;
+	double _seconds;
+}Rules_stats_t;
+
+//A sweep: the same rounds count, shoe and decisions for every variant
+typedef struct Rules_sweep {
+	uint64_t _rounds;
+	unsigned int _threads;   //0: all the online cores
+	uint64_t _seed;          //same seed -> same shoes order for every variant
+	uint8_t _decks;          //1-8
+	double _penetration;     //(0-1]
+	uint32_t _bet;
+	rules_decision _decide;  //NULL: rules_basic_decide()
+	void* _ctx;
+}Rules_sweep_t;
+
+//The precompiled variants, in enum rules_variant order
+extern const Rules_t rules_variants[RULES_VARIANTS];
+
+//Returns the variant of the given name, NULL if there is none
+const Rules_t* rules_find(const char* name);
+
+//Returns: true- the variant settles every payout of 'bet' exactly (the natural's num:den, half bet insurance and
+//surrender), false- some payout has a fraction
+bool rules_bet_exact(const Rules_t* rules, uint32_t bet);
+
+//The runtime dispatcher: plays a round of the given variant
+static inline int64_t rules_play_round(const Rules_t* rules, Shoe_t* shoe, uint32_t bet, rules_decision decide, void* ctx, Rules_round_t* round) {
+	return rules->_play(shoe, bet, decide, ctx, round);
+}
+
+//Basic strategy decisions (multi-deck, dealer stands on soft 17, double after split), as a rules_decision
+//('ctx' unused). Insurance is declined.
+int rules_basic_decide(const Rules_round_t* round, const Rules_hand_t* hand, unsigned int allowed, void* ctx);
+
+//Adds the round to the stats
+void rules_count_round(const Rules_round_t* round, Rules_stats_t* stats);
+
+//Plays the sweep's rounds of a variant on its threads (each with its own shoe and generator stream).
+//Returns: FAIL for invalid arguments, otherwise SUCCESS.
+int rules_sweep(const Rules_t* rules, const Rules_sweep_t* sweep, Rules_stats_t* stats);
+
+
+//The generic round. Upper case arguments are the rules: literals in every RULES_VARIANT() instantiation.
+static RULES_INLINE uint8_t rules_deal(Shoe_t* shoe, Rules_hand_t* hand, size_t* drawn) {
+	uint8_t card = 0;
+
+	*drawn += shoe_draw(shoe, &card) == SUCCESS; //cannot fail: a round holds far fewer cards than a deck
+	hand_add_card(&hand->_hand, card);
+	hand->_last = card;
+	hand->_cards++;
+	return card;
+}
+
+//Plays the player's hand 'h'. Returns: false- the player surrendered
+static RULES_INLINE bool rules_play_hand(Shoe_t* shoe, Rules_round_t* round, uint8_t h, rules_decision decide, void* ctx, size_t* drawn,
+	const enum rules_double DOUBLE, const bool DAS, const uint8_t MAX_HANDS, const bool SURRENDER) {
+
+	Rules_hand_t* hand = &round->_hands[h];
+
+	if (hand->_cards == 1) { //a split hand gets its second card when it is played
+		rules_deal(shoe, hand, drawn);
+		if (card_is_ace[hand->_first])
+			return true; //split Aces get one card each
+	}
+	while (hand->_hand._value < BLACK_JACK) {
+		unsigned int allowed = ACTION_HIT | ACTION_STAND;
+		uint8_t value = hand->_hand._value;
+		bool hard = !hand->_hand._soft;
+
+		if (hand->_cards == 2) {
+			if ((DOUBLE == RULES_DOUBLE_ANY || (DOUBLE == RULES_DOUBLE_9_11 && hard && value >= 9 && value <= 11) ||
+				(DOUBLE == RULES_DOUBLE_10_11 && hard && value >= 10 && value <= 11)) && (DAS || !hand->_split))
+				allowed |= ACTION_DOUBLE;
+			if (MAX_HANDS > 1 && round->_count < MAX_HANDS && card_value[hand->_first] == card_value[hand->_last])
+				allowed |= ACTION_SPLIT;
+			if (SURRENDER && round->_count == 1)
+				allowed |= ACTION_SURRENDER;
+		}
+		int action = decide(round, hand, allowed, ctx);
+		if (!(action & allowed))
+			action = ACTION_STAND;
+
+		switch (action) {
+		case ACTION_HIT:
+			rules_deal(shoe, hand, drawn);
+			break;
+		case ACTION_DOUBLE:
+			hand->_doubled = true;
+			round->_wagered += hand->_stake;
+			hand->_stake *= 2;
+			rules_deal(shoe, hand, drawn);
+			return true;
+		case ACTION_SPLIT: {
+			//the second card starts a new hand, the first one stays and gets a new second card
+			Rules_hand_t* split = &round->_hands[round->_count++];
+			memset(split, 0, sizeof(Rules_hand_t));
+			split->_first = split->_last = hand->_last;
+			split->_cards = 1;
+			split->_split = hand->_split = true;
+			split->_stake = round->_bet;
+			hand_add_card(&split->_hand, split->_first);
+			round->_wagered += round->_bet;
+
+			hand_reset(&hand->_hand);
+			hand_add_card(&hand->_hand, hand->_first);
+			hand->_cards = 1;
+			rules_deal(shoe, hand, drawn);
+			if (card_is_ace[hand->_first])
+				return true;
+			break;
+		}
+		case ACTION_SURRENDER:
+			round->_surrendered = true;
+			return false;
+		default: //stand
+			return true;
+		}
+	}
+	return true;
+}
+
+static RULES_INLINE int64_t rules_round_body(Shoe_t* shoe, uint32_t bet, rules_decision decide, void* ctx, Rules_round_t* round,
+	const bool H17, const uint8_t NATURAL_NUM, const uint8_t NATURAL_DEN, const enum rules_double DOUBLE, const bool DAS,
+	const uint8_t MAX_HANDS, const bool SURRENDER, const bool INSURANCE, const uint8_t DEALER_BUST_PAYS) {
+
+	Rules_hand_t* dealer = &round->_dealer;
+	size_t drawn = 0;
+
+	memset(round, 0, sizeof(Rules_round_t));
+	round->_bet = bet;
+	round->_wagered = bet;
+	round->_count = 1;
+	round->_hands[0]._stake = bet;
+	if (shoe_cut_card_out(shoe)) {
+		shoe_reshuffle(shoe);
+	}
+
+	//initial deal: player, dealer up card, player, dealer hole card
+	round->_hands[0]._first = rules_deal(shoe, &round->_hands[0], &drawn);
+	round->_up_card = rules_deal(shoe, dealer, &drawn);
+	rules_deal(shoe, &round->_hands[0], &drawn);
+	rules_deal(shoe, dealer, &drawn);
+
+	if (INSURANCE && card_is_ace[round->_up_card] && decide(round, &round->_hands[0], ACTION_INSURE, ctx) == ACTION_INSURE) {
+		round->_insurance = bet / 2;
+		round->_wagered += round->_insurance;
+	}
+	round->_black_jack = round->_hands[0]._hand._value == BLACK_JACK;
+	round->_dealer_black_jack = dealer->_hand._value == BLACK_JACK;
+	if (round->_insurance) { //pays 2:1
+		round->_net += round->_dealer_black_jack ? 2 * (int64_t)round->_insurance : -(int64_t)round->_insurance;
+	}
+
+	if (round->_black_jack || round->_dealer_black_jack) { //the dealer peeked: no one acts
+		if (!round->_dealer_black_jack)
+			round->_net += (int64_t)bet * NATURAL_NUM / NATURAL_DEN;
+		else if (!round->_black_jack)
+			round->_net -= bet;
+	}
+	else {
+		bool surrendered = false;
+		for (uint8_t h = 0; h < round->_count && !surrendered; ++h) { //splits add hands while playing
+			surrendered = !rules_play_hand(shoe, round, h, decide, ctx, &drawn, DOUBLE, DAS, MAX_HANDS, SURRENDER);
+		}
+
+		if (surrendered) {
+			round->_net -= bet / 2;
+		}
+		else {
+			bool live = false;
+			for (uint8_t h = 0; h < round->_count; ++h) {
+				live |= !round->_hands[h]._hand._bust;
+			}
+			while (live && (dealer->_hand._value < HOUSE_DEALER_STANDS || (H17 && dealer->_hand._value == HOUSE_DEALER_STANDS && dealer->_hand._soft))) {
+				rules_deal(shoe, dealer, &drawn);
+			}
+
+			for (uint8_t h = 0; h < round->_count; ++h) {
+				const Hand_t* hand = &round->_hands[h]._hand;
+				int64_t stake = round->_hands[h]._stake;
+
+				if (hand->_bust)
+					round->_net -= stake;
+				else if (dealer->_hand._bust)
+					round->_net += stake * DEALER_BUST_PAYS;
+				else if (hand->_value != dealer->_hand._value)
+					round->_net += hand->_value > dealer->_hand._value ? stake : -stake;
+			}
+		}
+	}
+	shoe_discard(shoe, drawn);
+	return round->_net;
+}
+
+//Instantiates the variant's engine: int64_t rules_round_<name>() (a rules_round_engine)
+#define RULES_VARIANT(name, h17, natural_num, natural_den, doubles, das, max_hands, surrender, insurance, bust_pays)  \
+typedef char rules_##name##_hands_check[(max_hands) >= 1 && (max_hands) <= RULES_MAX_HANDS ? 1 : -1];               \
+int64_t rules_round_##name(Shoe_t* shoe, uint32_t bet, rules_decision decide, void* ctx, Rules_round_t* round) {      \
+	return rules_round_body(shoe, bet, decide, ctx, round, h17, natural_num, natural_den, doubles, das, max_hands,     \
+		surrender, insurance, bust_pays);                                                                              \
+}
@@ -19,22 +19,6 @@
 void assert_condition(bool isValid, const char* errorMsg);
 
 
-List* create_list() {
-	//calloc ssures all pointers are set to NULL and var to 0 in a new list
-	List* list = (List*)calloc(1, sizeof(List));
-	assert_condition(list, "Error: function[create_list()]: Failed allocating memory for new list");
-	return list;
-}
-
-Node_t* create_node(void* data) {
-
-	Node_t* newNode = (Node_t*)calloc(1, sizeof(Node_t));
-	assert_condition(newNode, "Error: function[create_node()]: Failed allocating memory for new node");
-	newNode->_data = data;
-	newNode->_next = NULL;
-	return newNode;
-}
-
 //The given node is added at the head of the list
 void push(List* list, Node_t* n) {
 	assert_condition(list, "Error: function[push()]: Argument List* is NULL");
@@ -95,6 +79,7 @@ Node_t* remove_from_back(List* list) {
 	list->_pTail = itr;
 	itr = itr->_next;
 	list->_pTail->_next = NULL;
+	list->_count--;
 
 	return itr;
 }
@@ -104,6 +89,7 @@ Node_t* remove_at(List* list, size_t pos) {
 		fprintf(stderr, "Warning: function[remove_at()]: Argument 'pos' = %zu. Cannot be larger than list nodes count = %zu. Null returned\n.", pos, list->_count);
 		return NULL;
 	}
+	if (!pos) { return NULL; } //positions start at 1
 
 	Node_t* current = list->_pHead;
 	Node_t* prev = NULL;
@@ -167,7 +153,7 @@ int insert(List* list, Node_t* n, size_t pos) {
 		fprintf(stderr, "Warning: function[insert()]: Argument 'pos' = %zu. Cannot be larger than list nodes count = %zu. Null returned\n.", pos, list->_count);
 		return FAIL;
 	}
-	if (list->_count == 0) {
+	if (list->_count == 0 || pos <= 1) {
 		push(list, n);
 		return SUCCESS;
 	}
@@ -183,12 +169,149 @@ int insert(List* list, Node_t* n, size_t pos) {
 	return SUCCESS;
 }
 
+int splice(List* list, size_t pos, List* src) {
+	assert_condition(list, "Error: function[splice()]: Argument List* is NULL");
+	assert_condition(src, "Error: function[splice()]: Argument List* src is NULL");
+
+	if (list == src || list->_pool != src->_pool) {
+		fprintf(stderr, "Warning: function[splice()]: Cannot splice a list into itself or into a list of another nodes pool\n");
+		return FAIL;
+	}
+	if (pos > list->_count + 1) {
+		fprintf(stderr, "Warning: function[splice()]: Argument 'pos' = %zu. Cannot be larger than list nodes count + 1 = %zu\n", pos, list->_count + 1);
+		return FAIL;
+	}
+	if (src->_count == 0) {
+		return SUCCESS;
+	}
+
+	if (pos <= 1) {
+		src->_pTail->_next = list->_pHead;
+		list->_pHead = src->_pHead;
+		if (list->_count == 0) { list->_pTail = src->_pTail; }
+	}
+	else if (pos == list->_count + 1) { //only the tail is followed
+		list->_pTail->_next = src->_pHead;
+		list->_pTail = src->_pTail;
+	}
+	else {
+		Node_t* prev = find(list, pos - 1);
+		src->_pTail->_next = prev->_next;
+		prev->_next = src->_pHead;
+	}
+	list->_count += src->_count;
+	src->_pHead = src->_pTail = NULL;
+	src->_count = 0;
+	return SUCCESS;
+}
+
+int concat(List* list, List* src) {
+	assert_condition(list, "Error: function[concat()]: Argument List* is NULL");
+	return splice(list, list->_count + 1, src);
+}
+
+size_t extract_range(List* list, size_t start_pos, size_t end_pos, List* out) {
+	assert_condition(list, "Error: function[extract_range()]: Argument List* is NULL");
+	assert_condition(out, "Error: function[extract_range()]: Argument List* out is NULL");
+
+	List_cursor_t cursor;
+	if (list == out || list->_pool != out->_pool || !cursor_begin(&cursor, list, start_pos) || end_pos < start_pos || end_pos > list->_count) {
+		fprintf(stderr, "Warning: function[extract_range()]: Range %zu-%zu of a %zu nodes list cannot be moved to the given list\n", start_pos, end_pos, list->_count);
+		return 0;
+	}
+
+	Node_t* first = cursor._node;
+	Node_t* last = first;
+	size_t moved = end_pos - start_pos + 1;
+	for (size_t i = 1; i < moved; ++i) {
+		last = last->_next;
+	}
+
+	//unlinking first - last
+	if (cursor._prev) { cursor._prev->_next = last->_next; }
+	else { list->_pHead = last->_next; }
+	if (list->_pTail == last) { list->_pTail = cursor._prev; }
+	list->_count -= moved;
+
+	//and linking them at the back of 'out'
+	last->_next = NULL;
+	if (out->_count) { out->_pTail->_next = first; }
+	else { out->_pHead = first; }
+	out->_pTail = last;
+	out->_count += moved;
+	return moved;
+}
+
+void add_array_to_back(List* list, void* const* data, size_t count) {
+	assert_condition(list, "Error: function[add_array_to_back()]: Argument List* is NULL");
+	assert_condition(data || !count, "Error: function[add_array_to_back()]: Argument data array is NULL");
+	if (!count)
+		return;
+
+	//the new nodes are chained first, then linked to the list at once
+	Node_t* first = list_create_node(list, data[0]);
+	Node_t* last = first;
+	for (size_t i = 1; i < count; ++i) {
+		last->_next = list_create_node(list, data[i]);
+		last = last->_next;
+	}
+	last->_next = NULL;
+
+	if (list->_count) { list->_pTail->_next = first; }
+	else { list->_pHead = first; }
+	list->_pTail = last;
+	list->_count += count;
+}
+
+Node_t* cursor_begin(List_cursor_t* cursor, List* list, size_t pos) {
+	assert_condition(cursor, "Error: function[cursor_begin()]: Argument List_cursor_t* is NULL");
+	assert_condition(list, "Error: function[cursor_begin()]: Argument List* is NULL");
+
+	cursor->_list = list;
+	cursor->_prev = NULL;
+	cursor->_node = pos && pos <= list->_count ? list->_pHead : NULL;
+	cursor->_pos = 1;
+	while (cursor->_node && cursor->_pos < pos) {
+		cursor->_prev = cursor->_node;
+		cursor->_node = cursor->_node->_next;
+		cursor->_pos++;
+	}
+	return cursor->_node;
+}
+
+Node_t* cursor_next(List_cursor_t* cursor) {
+	assert_condition(cursor, "Error: function[cursor_next()]: Argument List_cursor_t* is NULL");
+	if (!cursor->_node)
+		return NULL;
+
+	cursor->_prev = cursor->_node;
+	cursor->_node = cursor->_node->_next;
+	cursor->_pos++;
+	return cursor->_node;
+}
+
+Node_t* cursor_remove(List_cursor_t* cursor) {
+	assert_condition(cursor, "Error: function[cursor_remove()]: Argument List_cursor_t* is NULL");
+
+	Node_t* n = cursor->_node;
+	List* list = cursor->_list;
+	if (!n)
+		return NULL;
+
+	if (cursor->_prev) { cursor->_prev->_next = n->_next; }
+	else { list->_pHead = n->_next; }
+	if (list->_pTail == n) { list->_pTail = cursor->_prev; }
+	list->_count--;
+
+	cursor->_node = n->_next; //takes the removed node's position
+	n->_next = NULL;
+	return n;
+}
+
 void clear_list(List* list) {
 
 	//The data pointed to by void* in node_t was not allocated by SLL and therefor is not freed.
-	while (list->_count) {
-		free(pop(list));
-	}
+	list_free_nodes(list);
 }
 
 void print_list(List* list, void(*print_data)(void *data)) {
@@ -219,9 +342,10 @@ Node_t* find(List* list, size_t pos) {
 
 void print_list_by_range(List* list, size_t start_pos, size_t end_pos, void(*print_data)(void* data)) {
 	assert_condition(list, "Error: function[print_list_by_range()]: Argument List* is NULL");
-	Node_t* start = find(list, start_pos);
-	Node_t* end = find(list, end_pos);
-	for (Node_t* itr = start ; itr != end->_next; itr = itr->_next) {
+
+	//a single walk: to the start node, then on up to the end position
+	List_cursor_t cursor;
+	for (Node_t* itr = cursor_begin(&cursor, list, start_pos); itr && cursor._pos <= end_pos; itr = cursor_next(&cursor)) {
 		print_data(itr->_data);
 	}
 }
@@ -232,18 +356,7 @@ void for_each(List* list, void *result, void(*calculate)(void* data, void* resul
 	}
 }
 
-void assert_condition(bool isValid, const char *errorMsg) { 
-	if (!errorMsg) {
-		fprintf(stderr, "%s", "Error: function[assert_condition()]: pointer provided to argument 'errorMsg' is Null. exitting");
-		exit(EXIT_FAILURE);
-	}
-	if (!isValid) {
-		if (errorMsg) {
-			fprintf(stderr, "%s", errorMsg);
-		}
-		exit(EXIT_FAILURE);
-	}
-}
+
 
 
 void print_int(void *val) {
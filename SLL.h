@@ -4,28 +4,89 @@
  * Author: Noga Avraham
  * Description: Header file of a generelized void* data storing Single Linked List. 
                 [Real-Time Group C course project]
+ *              Two implementations share this interface, chosen at build time:
+ *                SLL.c - singly linked (default).
+ *                DLL.c - doubly linked, built with -DLIST_DOUBLY_LINKED: O(1) tail removal, and positional
+ *                        operations walk from the closer end.
+ *              Both are linked with SLL_alloc.c (lists/nodes allocation and the nodes pool).
  * Language:  C
  * Date: July 2021
 */
+#include<stddef.h>
+#include<stdbool.h>
 
 typedef struct Node_t Node_t;
 typedef struct List List;
+typedef struct Node_pool Node_pool_t;
+typedef struct Node_slab Node_slab_t;
+typedef struct Sll_alloc_stats Sll_alloc_stats_t;
+typedef struct List_cursor List_cursor_t;
 //structs
 struct Node_t {
 	void* _data;
 	Node_t* _next;
+#ifdef LIST_DOUBLY_LINKED
+	Node_t* _prev;
+#endif
 };
 
 struct List {
 	Node_t* _pHead;
 	Node_t* _pTail; //Adding tail to simplify add() function(i.e- no iterations from head to last node)
 	size_t _count;
+	Node_pool_t* _pool; //optional. When set, the list nodes are taken from and returned to this pool
+};
+
+//Nodes pool: nodes are cut from contiguous slabs. Taking and returning a node is O(1) and makes no heap
+//calls, and reset_node_pool() returns all the nodes at once. A pool is not thread safe (use one per thread/table).
+struct Node_pool {
+	Node_t* _free;        //returned nodes, chained by _next
+	Node_slab_t* _slabs;  //all the pool slabs. The first one is the one nodes are cut from
+	size_t _slab_nodes;   //nodes per slab
+	size_t _cut;          //nodes already cut from the first slab
+	size_t _in_use;
+};
+
+//Heap calls made by the SLL on the calling thread (lists, nodes and slabs)
+struct Sll_alloc_stats {
+	size_t _mallocs;
+	size_t _frees;
+};
+
+//A single walk over a list. It keeps the node before the current one, so the current node is removed in O(1).
+struct List_cursor {
+	List* _list;
+	Node_t* _prev;  //NULL: the current node is the head
+	Node_t* _node;  //the current node (NULL: past the end of the list)
+	size_t _pos;    //position of _node
 };
 
 //creation and initialization:
 List* create_list();
 Node_t* create_node(void* data);
 
+//Creates a list whose nodes are managed by 'pool'
+List* create_pooled_list(Node_pool_t* pool);
+
+//Creates / frees a node the way the list manages its nodes (from its pool, or from the heap)
+Node_t* list_create_node(List* list, void* data);
+void list_free_node(List* list, Node_t* n);
+//Frees all the list nodes the way the list manages them, leaving it empty. O(1) for a pooled list.
+void list_free_nodes(List* list);
+
+//Nodes pool handlers:
+//Creates a pool with 'slab_nodes' nodes per slab. The first slab is allocated here.
+Node_pool_t* create_node_pool(size_t slab_nodes);
+Node_t* pool_create_node(Node_pool_t* pool, void* data);
+void pool_free_node(Node_pool_t* pool, Node_t* n);
+//Returns all the pool nodes at once (nodes still held by lists become invalid). Slabs are kept for reuse.
+void reset_node_pool(Node_pool_t* pool);
+//Frees the pool and all its slabs
+void clear_node_pool(Node_pool_t* pool);
+
+//Returns the heap calls counters of the calling thread
+void sll_alloc_stats(Sll_alloc_stats_t* stats);
+
 //List head handlers:
 void push(List* list, Node_t* n);
 Node_t* pop(List* list);
@@ -49,6 +110,27 @@ Node_t* find(List* list, size_t pos);
 //performs action on every node in the list, according to the supplied 'calculate' callback function pointer.
 void for_each(List* list, void* result, void(*calculate)(void* data, void* result));
 
+//Bulk handlers: the nodes move between lists, no node is created or freed.
+//Both lists must manage their nodes the same way (the same pool, or both the heap). Returns: FAIL otherwise.
+//Moves all the nodes of 'src' to the back of 'list' in O(1). 'src' is left empty.
+int concat(List* list, List* src);
+//Moves all the nodes of 'src' before the given position of 'list' (range: 1-n+1, n+1: the back). 'src' is left empty.
+int splice(List* list, size_t pos, List* src);
+//Moves the nodes of positions start_pos - end_pos (range: 1-n) to the back of 'out', in a single walk.
+//Returns: the number of nodes moved (0 for an invalid range).
+size_t extract_range(List* list, size_t start_pos, size_t end_pos, List* out);
+
+//Adds a node for every data pointer of the array, in order, to the back of the list
+void add_array_to_back(List* list, void* const* data, size_t count);
+
+//Cursor handlers. The cursor is valid as long as the list is changed through it only.
+//starts at the given position (range: 1-n). Returns the node there, NULL if out of range
+Node_t* cursor_begin(List_cursor_t* cursor, List* list, size_t pos);
+//moves to the next node. Returns it, NULL past the end of the list
+Node_t* cursor_next(List_cursor_t* cursor);
+//unlinks and returns the current node (NULL past the end). The cursor moves to the node that followed it
+Node_t* cursor_remove(List_cursor_t* cursor);
+
 //printing functions:
 //prints the list nodes according to the supplied 'print_data' callback function pointer
 void print_list(List* list, void(*print_data)(void* data));
@@ -0,0 +1,193 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the lists and nodes allocation: heap or nodes pool.
+ *              Shared by the singly (SLL.c) and doubly (DLL.c) linked implementations of SLL.h.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include "SLL.h"
+#include "Stats.h"
+
+
+//Slab of pool nodes. The nodes follow the slab header in the same allocation (a flexible array member)
+struct Node_slab {
+	Node_slab_t* _next;
+	Node_t _nodes[];
+};
+
+//heap calls counters, per thread
+static __thread Sll_alloc_stats_t alloc_stats = { 0 };
+
+void assert_condition(bool isValid, const char* errorMsg);
+
+
+List* create_list() {
+	//calloc ssures all pointers are set to NULL and var to 0 in a new list
+	List* list = (List*)calloc(1, sizeof(List));
+	assert_condition(list, "Error: function[create_list()]: Failed allocating memory for new list");
+	alloc_stats._mallocs++;
+	STATS_COUNT(STATS_LIST_ALLOCS, 1);
+	return list;
+}
+
+List* create_pooled_list(Node_pool_t* pool) {
+	assert_condition(pool, "Error: function[create_pooled_list()]: Argument Node_pool_t* is NULL");
+	List* list = create_list();
+	list->_pool = pool;
+	return list;
+}
+
+Node_t* create_node(void* data) {
+
+	Node_t* newNode = (Node_t*)calloc(1, sizeof(Node_t));
+	assert_condition(newNode, "Error: function[create_node()]: Failed allocating memory for new node");
+	alloc_stats._mallocs++;
+	STATS_COUNT(STATS_LIST_ALLOCS, 1);
+	newNode->_data = data;
+	newNode->_next = NULL;
+#ifdef LIST_DOUBLY_LINKED
+	newNode->_prev = NULL;
+#endif
+	return newNode;
+}
+
+Node_t* list_create_node(List* list, void* data) {
+	assert_condition(list, "Error: function[list_create_node()]: Argument List* is NULL");
+	return list->_pool ? pool_create_node(list->_pool, data) : create_node(data);
+}
+
+void list_free_node(List* list, Node_t* n) {
+	assert_condition(list, "Error: function[list_free_node()]: Argument List* is NULL");
+	if (!n)
+		return;
+	if (list->_pool) {
+		pool_free_node(list->_pool, n);
+	}
+	else {
+		free(n);
+		alloc_stats._frees++;
+	}
+}
+
+void list_free_nodes(List* list) {
+	assert_condition(list, "Error: function[list_free_nodes()]: Argument List* is NULL");
+	if (!list->_count)
+		return;
+
+	if (list->_pool) { //the whole chain goes onto the pool free list at once
+		list->_pTail->_next = list->_pool->_free;
+		list->_pool->_free = list->_pHead;
+		list->_pool->_in_use -= list->_count;
+	}
+	else {
+		for (Node_t* itr = list->_pHead; itr; ) {
+			Node_t* next = itr->_next;
+			free(itr);
+			alloc_stats._frees++;
+			itr = next;
+		}
+	}
+	list->_pHead = list->_pTail = NULL;
+	list->_count = 0;
+}
+
+Node_pool_t* create_node_pool(size_t slab_nodes) {
+	//calloc ssures all pointers are set to NULL and vars to 0 in a new pool
+	Node_pool_t* pool = (Node_pool_t*)calloc(1, sizeof(Node_pool_t));
+	assert_condition(pool, "Error: function[create_node_pool()]: Failed allocating memory for new pool");
+	alloc_stats._mallocs++;
+	STATS_COUNT(STATS_LIST_ALLOCS, 1);
+
+	pool->_slab_nodes = slab_nodes ? slab_nodes : 1;
+	pool->_cut = pool->_slab_nodes; //no slab to cut from yet
+	pool_free_node(pool, pool_create_node(pool, NULL)); //allocates the first slab
+	pool->_in_use = 0;
+	return pool;
+}
+
+Node_t* pool_create_node(Node_pool_t* pool, void* data) {
+	assert_condition(pool, "Error: function[pool_create_node()]: Argument Node_pool_t* is NULL");
+
+	Node_t* newNode = pool->_free;
+
+	if (newNode) {
+		pool->_free = newNode->_next;
+	}
+	else {
+		if (pool->_cut == pool->_slab_nodes) { //first slab used up: adding a new first slab
+			Node_slab_t* slab = (Node_slab_t*)malloc(sizeof(Node_slab_t) + pool->_slab_nodes * sizeof(Node_t));
+			assert_condition(slab, "Error: function[pool_create_node()]: Failed allocating memory for new slab");
+			alloc_stats._mallocs++;
+			STATS_COUNT(STATS_LIST_ALLOCS, 1);
+			slab->_next = pool->_slabs;
+			pool->_slabs = slab;
+			pool->_cut = 0;
+		}
+		newNode = &pool->_slabs->_nodes[pool->_cut++];
+	}
+	pool->_in_use++;
+	newNode->_data = data;
+	newNode->_next = NULL;
+#ifdef LIST_DOUBLY_LINKED
+	newNode->_prev = NULL;
+#endif
+	return newNode;
+}
+
+void pool_free_node(Node_pool_t* pool, Node_t* n) {
+	assert_condition(pool, "Error: function[pool_free_node()]: Argument Node_pool_t* is NULL");
+	if (!n)
+		return;
+	n->_next = pool->_free;
+	pool->_free = n;
+	pool->_in_use--;
+}
+
+void reset_node_pool(Node_pool_t* pool) {
+	assert_condition(pool, "Error: function[reset_node_pool()]: Argument Node_pool_t* is NULL");
+
+	//all slabs but the first are chained into the free nodes list, then the first slab is cut over again
+	pool->_free = NULL;
+	for (Node_slab_t* slab = pool->_slabs ? pool->_slabs->_next : NULL; slab; slab = slab->_next) {
+		for (size_t i = 0; i < pool->_slab_nodes; ++i) {
+			slab->_nodes[i]._next = pool->_free;
+			pool->_free = &slab->_nodes[i];
+		}
+	}
+	pool->_cut = pool->_slabs ? 0 : pool->_slab_nodes;
+	pool->_in_use = 0;
+}
+
+void clear_node_pool(Node_pool_t* pool) {
+	if (!pool)
+		return;
+	Node_slab_t* slab = pool->_slabs;
+	while (slab) {
+		Node_slab_t* next = slab->_next;
+		free(slab);
+		alloc_stats._frees++;
+		slab = next;
+	}
+	free(pool);
+	alloc_stats._frees++;
+}
+
+void sll_alloc_stats(Sll_alloc_stats_t* stats) {
+	assert_condition(stats, "Error: function[sll_alloc_stats()]: Argument Sll_alloc_stats_t* is NULL");
+	*stats = alloc_stats;
+}
+
+void assert_condition(bool isValid, const char *errorMsg) {
+	if (!errorMsg) {
+		fprintf(stderr, "%s", "Error: function[assert_condition()]: pointer provided to argument 'errorMsg' is Null. exitting");
+		exit(EXIT_FAILURE);
+	}
+	if (!isValid) {
+		if (errorMsg) {
+			fprintf(stderr, "%s", errorMsg);
+		}
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,596 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the "Black Jack" game server.
+ *              All the loops wait on the one listening socket (EPOLLEXCLUSIVE: a connection wakes a single loop),
+ *              and a session stays on the loop that accepted it, so its table is only touched by one thread.
+ *              Rounds are played by round_begin()/round_turn() of Black_Jack.c, resumed with the player's
+ *              decision (the request line that was just read) as the table's pending answer.
+ *              Link with Black_Jack.c compiled with -DBJ_NO_MAIN (and -pthread).
+ * Language:  C
+*/
+
+#define _GNU_SOURCE //accept4()
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdarg.h>
+#include<stddef.h>//offsetof()
+#include<errno.h>
+#include<pthread.h>
+#include<unistd.h>
+#include<sys/epoll.h>
+#include<sys/eventfd.h>
+#include<sys/socket.h>
+#include<sys/random.h>//getrandom()
+#include<sys/file.h>//flock()
+#include<fcntl.h>
+#include<inttypes.h>
+#include "Server.h"
+#include "Net.h"
+#include "Snapshot.h"
+
+
+#define SESSION_IN_SIZE 256    //a request line is a few bytes, longer lines are a protocol error
+#define SESSION_OUT_SIZE 1024  //replies not written yet (the client did not read them)
+#define REPLY_MAX_LEN 64
+#define MAX_EVENTS 256
+#define SNAPSHOT_PATH_LEN 4096
+
+enum session_resume_result { RESUME_DONE, RESUME_NO_SESSION, RESUME_IN_USE };
+
+
+//A connection playing its own table
+typedef struct Session {
+	struct Session* _prev;   //the loop's open sessions list
+	struct Session* _next;
+	int _fd;
+	uint32_t _events;        //epoll events registered
+	bool _in_round;
+	bool _quit;              //closed by a "Q" request
+	uint64_t _key;           //the session's snapshot name
+	int _snapshot_fd;        //-1: not saved yet. Holds the snapshot's lock (flock()): a key is resumed by one session.
+	uint64_t _saves;         //sequence of the next save (see snapshot_write_slot())
+	Table_t _table;
+	size_t _in_len;
+	size_t _out_len;
+	char _in[SESSION_IN_SIZE];
+	char _out[SESSION_OUT_SIZE];
+}Session_t;
+
+//An event loop thread
+typedef struct Server_loop {
+	pthread_t _thread;
+	int _epoll;
+	int _listen;
+	const Server_config_t* _config;
+	Rng_t _rng;              //seeds of the loop's sessions tables
+	Session_t* _sessions;    //open sessions
+	uint64_t _open;
+	int _result;
+	Server_stats_t _stats;
+}Server_loop_t;
+
+
+static int stop_event = -1;
+static char listen_tag, stop_tag; //epoll tags of the listening socket and the stop event (sessions are tagged by pointer)
+
+
+static void* loop_run(void* arg);
+static void loop_accept(Server_loop_t* loop);
+static void session_close(Server_loop_t* loop, Session_t* session);
+static bool session_read(Server_loop_t* loop, Session_t* session);
+static bool session_write(Session_t* session);
+static void session_update_events(Server_loop_t* loop, Session_t* session);
+static bool session_request(Server_loop_t* loop, Session_t* session, char* line);
+static void session_reply(Server_loop_t* loop, Session_t* session, const char* format, ...);
+static void session_round_reply(Server_loop_t* loop, Session_t* session, int step);
+static void session_save(Server_loop_t* loop, Session_t* session);
+static int session_resume(Server_loop_t* loop, Session_t* session, uint64_t key);
+static bool session_new_key(uint64_t* key);
+static void snapshot_path(const Server_config_t* config, uint64_t key, char* path);
+
+
+int server_run(const Server_config_t* config, Server_stats_t* stats) {
+	if (!config || !stats) {
+		fprintf(stderr, "Warning: function[server_run()]: Null config or stats pointer provided\n");
+		return FAIL;
+	}
+
+	Server_loop_t* loops = NULL;
+	Rng_t stream;
+	unsigned int count = config->_loops;
+	int result = SUCCESS;
+	int listen_fd = net_listen(config->_address ? config->_address : NET_DEFAULT_ADDRESS);
+
+	if (listen_fd < 0)
+		return FAIL;
+	stop_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (stop_event < 0) {
+		fprintf(stderr, "Warning: function[server_run()]: eventfd(): %s\n", strerror(errno));
+		close(listen_fd);
+		return FAIL;
+	}
+	if (!count) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		count = cores > 0 ? (unsigned int)cores : 1;
+	}
+	if (count > SERVER_MAX_LOOPS) {
+		count = SERVER_MAX_LOOPS;
+	}
+
+	loops = (Server_loop_t*)calloc(count, sizeof(Server_loop_t));
+	if (!loops) {
+		fprintf(stderr, "Warning: function[server_run()]: Failed allocating memory for loops\n");
+		close(listen_fd);
+		close(stop_event);
+		return FAIL;
+	}
+
+	rng_seed(&stream, config->_seed);
+	for (unsigned int i = 0; i < count; ++i) {
+		struct epoll_event listen_ev = { EPOLLIN | EPOLLEXCLUSIVE, { .ptr = &listen_tag } };
+		struct epoll_event stop_ev = { EPOLLIN, { .ptr = &stop_tag } };
+
+		loops[i]._config = config;
+		loops[i]._listen = listen_fd;
+		loops[i]._rng = stream;
+		rng_jump(&stream); //next loop's stream
+		loops[i]._epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (loops[i]._epoll < 0 ||
+			epoll_ctl(loops[i]._epoll, EPOLL_CTL_ADD, listen_fd, &listen_ev) != 0 ||
+			epoll_ctl(loops[i]._epoll, EPOLL_CTL_ADD, stop_event, &stop_ev) != 0) {
+			fprintf(stderr, "Warning: function[server_run()]: Failed creating event loop %u: %s\n", i, strerror(errno));
+			result = FAIL;
+			count = i + 1;
+			break;
+		}
+	}
+
+	for (unsigned int i = 1; result == SUCCESS && i < count; ++i) {
+		if (pthread_create(&loops[i]._thread, NULL, loop_run, &loops[i]) != 0) {
+			fprintf(stderr, "Warning: function[server_run()]: Failed creating loop thread %u\n", i);
+			loops[i]._thread = 0;
+		}
+	}
+	if (result == SUCCESS) {
+		loop_run(&loops[0]); //the calling thread is loop 0
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (i && loops[i]._thread) {
+			pthread_join(loops[i]._thread, NULL);
+		}
+		if (loops[i]._result != SUCCESS) {
+			result = FAIL;
+		}
+		stats->_sessions += loops[i]._stats._sessions;
+		stats->_peak_sessions += loops[i]._stats._peak_sessions;
+		stats->_requests += loops[i]._stats._requests;
+		stats->_rounds += loops[i]._stats._rounds;
+		stats->_errors += loops[i]._stats._errors;
+		if (loops[i]._epoll >= 0) {
+			close(loops[i]._epoll);
+		}
+	}
+
+	free(loops);
+	close(listen_fd);
+	close(stop_event);
+	stop_event = -1;
+	return result;
+}
+
+void server_stop(void) {
+	uint64_t one = 1;
+
+	if (stop_event >= 0) {
+		//the event is never read back, so it stays readable for every loop
+		if (write(stop_event, &one, sizeof(one)) < 0) {}
+	}
+}
+
+//Serves the loop's sessions until the stop event. Open sessions are closed on the way out.
+static void* loop_run(void* arg) {
+	Server_loop_t* loop = (Server_loop_t*)arg;
+	struct epoll_event events[MAX_EVENTS];
+	bool running = true;
+
+	while (running) {
+		int ready = epoll_wait(loop->_epoll, events, MAX_EVENTS, -1);
+
+		if (ready < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "Warning: function[loop_run()]: epoll_wait(): %s\n", strerror(errno));
+			loop->_result = FAIL;
+			break;
+		}
+		for (int i = 0; i < ready; ++i) {
+			void* tag = events[i].data.ptr;
+
+			if (tag == &stop_tag) {
+				running = false;
+			}
+			else if (tag == &listen_tag) {
+				loop_accept(loop);
+			}
+			else {
+				Session_t* session = (Session_t*)tag;
+				bool open = !(events[i].events & (EPOLLERR | EPOLLHUP));
+
+				if (open && (events[i].events & EPOLLIN))
+					open = session_read(loop, session);
+				if (open && session->_out_len)
+					open = session_write(session);
+				if (open)
+					session_update_events(loop, session);
+				else
+					session_close(loop, session);
+			}
+		}
+	}
+
+	while (loop->_sessions) {
+		session_close(loop, loop->_sessions);
+	}
+	return NULL;
+}
+
+static void loop_accept(Server_loop_t* loop) {
+	const Server_config_t* config = loop->_config;
+
+	for (;;) {
+		int fd = accept4(loop->_listen, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+		if (fd < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				fprintf(stderr, "Warning: function[loop_accept()]: accept4(): %s\n", strerror(errno));
+			return;  //EAGAIN: another loop took it, or no more pending connections
+		}
+
+		Session_t* session = (Session_t*)malloc(sizeof(Session_t));
+		if (!session) {
+			fprintf(stderr, "Warning: function[loop_accept()]: Failed allocating memory for a session\n");
+			close(fd);
+			continue;
+		}
+		memset(session, 0, offsetof(Session_t, _in));
+		if (!session_new_key(&session->_key)) {
+			fprintf(stderr, "Warning: function[loop_accept()]: No random source for a session key: %s\n", strerror(errno));
+			free(session);
+			close(fd);
+			continue;
+		}
+		session->_fd = fd;
+		session->_snapshot_fd = -1;
+		table_init_seeded(&session->_table, true, rng_next(&loop->_rng));
+		if (config->_decks) {
+			table_set_shoe(&session->_table, config->_decks, config->_penetration);
+		}
+		strcpy(session->_table._player._info._name, "Player");
+		session->_table._player._info._id = fd;
+		session->_table._player._account._cash = SERVER_BANKROLL;
+
+		struct epoll_event ev = { EPOLLIN, { .ptr = session } };
+		if (epoll_ctl(loop->_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+			fprintf(stderr, "Warning: function[loop_accept()]: epoll_ctl(): %s\n", strerror(errno));
+			table_clear(&session->_table);
+			free(session);
+			close(fd);
+			continue;
+		}
+		session->_events = EPOLLIN;
+		session->_next = loop->_sessions;
+		if (loop->_sessions) {
+			loop->_sessions->_prev = session;
+		}
+		loop->_sessions = session;
+		loop->_stats._sessions++;
+		if (++loop->_open > loop->_stats._peak_sessions) {
+			loop->_stats._peak_sessions = loop->_open;
+		}
+	}
+}
+
+static void session_close(Server_loop_t* loop, Session_t* session) {
+	if (session->_prev)
+		session->_prev->_next = session->_next;
+	else
+		loop->_sessions = session->_next;
+	if (session->_next) {
+		session->_next->_prev = session->_prev;
+	}
+	epoll_ctl(loop->_epoll, EPOLL_CTL_DEL, session->_fd, NULL);
+	close(session->_fd);
+	if (session->_snapshot_fd >= 0) { //kept for a resume, unless the player quit
+		char path[SNAPSHOT_PATH_LEN];
+		close(session->_snapshot_fd);
+		snapshot_path(loop->_config, session->_key, path);
+		if (session->_quit)
+			unlink(path);
+	}
+	table_clear(&session->_table);
+	free(session);
+	loop->_open--;
+}
+
+//Reads and serves the complete request lines. Stops while the replies are backed up.
+//Returns: false- the session should be closed.
+static bool session_read(Server_loop_t* loop, Session_t* session) {
+	while (session->_out_len <= SESSION_OUT_SIZE - REPLY_MAX_LEN) {
+		char* line = session->_in;
+		char* end = (char*)memchr(session->_in, '\n', session->_in_len);
+
+		if (end) { //serving a buffered line first
+			*end = '\0';
+			if (!session_request(loop, session, line))
+				return false;
+			session->_in_len -= (size_t)(end + 1 - line);
+			memmove(session->_in, end + 1, session->_in_len);
+			continue;
+		}
+		if (session->_in_len == SESSION_IN_SIZE) //a line that cannot be a request
+			return false;
+
+		ssize_t got = read(session->_fd, session->_in + session->_in_len, SESSION_IN_SIZE - session->_in_len);
+		if (got > 0) {
+			session->_in_len += (size_t)got;
+		}
+		else if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return true;
+		}
+		else if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		else {
+			return false; //closed by the client, or failed
+		}
+	}
+	return true;
+}
+
+//Writes the pending replies. Returns: false- the session should be closed.
+static bool session_write(Session_t* session) {
+	size_t sent = 0;
+
+	while (sent < session->_out_len) {
+		ssize_t put = send(session->_fd, session->_out + sent, session->_out_len - sent, MSG_NOSIGNAL);
+
+		if (put > 0) {
+			sent += (size_t)put;
+		}
+		else if (put < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (put < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}
+		else {
+			return false;
+		}
+	}
+	session->_out_len -= sent;
+	memmove(session->_out, session->_out + sent, session->_out_len);
+	return true;
+}
+
+//Reads while there is room for replies, waits for writing while replies are pending
+static void session_update_events(Server_loop_t* loop, Session_t* session) {
+	uint32_t events = 0;
+
+	if (session->_out_len <= SESSION_OUT_SIZE - REPLY_MAX_LEN)
+		events |= EPOLLIN;
+	if (session->_out_len)
+		events |= EPOLLOUT;
+
+	if (events != session->_events) {
+		struct epoll_event ev = { events, { .ptr = session } };
+		epoll_ctl(loop->_epoll, EPOLL_CTL_MOD, session->_fd, &ev);
+		session->_events = events;
+	}
+}
+
+//Serves a single request line. Returns: false- the session should be closed.
+static bool session_request(Server_loop_t* loop, Session_t* session, char* line) {
+	Table_t* table = &session->_table;
+	Account_t* account = &table->_player._account;
+	Account_t* house = &table->_dealer._account;
+	size_t len = strcspn(line, "\r");
+
+	line[len] = '\0';
+	loop->_stats._requests++;
+
+	switch (line[0]) {
+	case 'B': {
+		char* end = NULL;
+		unsigned long bet = strtoul(line + 1, &end, 10);
+
+		if (session->_in_round) {
+			session_reply(loop, session, "X round in play\n");
+			break;
+		}
+		if (end == line + 1 || *end || !bet || bet > SERVER_BANKROLL) {
+			session_reply(loop, session, "X bet must be 1-%d\n", SERVER_BANKROLL);
+			break;
+		}
+		//refilling the player and the house the same way the simulation re-buys
+		if (account->_cash + (int64_t)account->_bet < (int64_t)bet) {
+			account->_cash = SERVER_BANKROLL;
+			account->_bet = 0;
+		}
+		if (house->_cash < SERVER_BANKROLL) {
+			house->_cash += SERVER_BANKROLL;
+		}
+		table->_auto_bet = (uint32_t)bet;
+		session_round_reply(loop, session, round_begin(table));
+		break;
+	}
+	case 'H':
+	case 'S':
+		if (!session->_in_round || line[1]) {
+			session_reply(loop, session, session->_in_round ? "X bad request\n" : "X no round in play\n");
+			break;
+		}
+		table->_action = line[0]; //the decision round_turn() takes
+		session_round_reply(loop, session, round_turn(table));
+		break;
+	case 'Q':
+		session->_quit = true;
+		return false;
+	case 'K':
+		session_reply(loop, session, "K %016" PRIx64 "\n", session->_key);
+		break;
+	case 'C': {
+		char* end = NULL;
+		uint64_t key = strtoull(line + 1, &end, 16);
+
+		if (session->_in_round) {
+			session_reply(loop, session, "X round in play\n");
+			break;
+		}
+		if (end == line + 1 || *end || !loop->_config->_snapshots) {
+			session_reply(loop, session, loop->_config->_snapshots ? "X bad key\n" : "X no snapshots\n");
+			break;
+		}
+		int resumed = session_resume(loop, session, key);
+		if (resumed != RESUME_DONE) {
+			if (resumed == RESUME_IN_USE)
+				session_reply(loop, session, "X session in use\n");
+			else
+				session_reply(loop, session, "X no session %016" PRIx64 "\n", key);
+			break;
+		}
+		if (session->_in_round)
+			session_reply(loop, session, "T %u %u\n", table->_player._hand._value, dealer_up_card(table));
+		else
+			session_reply(loop, session, "C %d\n", account->_cash);
+		break;
+	}
+	default:
+		session_reply(loop, session, "X bad request\n");
+		break;
+	}
+	return true;
+}
+
+static void session_round_reply(Server_loop_t* loop, Session_t* session, int step) {
+	Table_t* table = &session->_table;
+	static const char outcome_code[] = { '-', 'W', 'L', 'P' }; //enum round_outcome order
+
+	session->_in_round = (step == ROUND_PLAYER_TURN);
+	if (step == ROUND_PLAYER_TURN) {
+		session_reply(loop, session, "T %u %u\n", table->_player._hand._value, dealer_up_card(table));
+	}
+	else if (table->_outcome == OUTCOME_NONE) {
+		session_reply(loop, session, "X round failed\n");
+	}
+	else {
+		loop->_stats._rounds++;
+		session_reply(loop, session, "R %c %d\n", outcome_code[table->_outcome], table->_player._account._cash);
+	}
+	session_save(loop, session);
+}
+
+//Queues a reply line. Counts the "X" error replies.
+static void session_reply(Server_loop_t* loop, Session_t* session, const char* format, ...) {
+	va_list args;
+
+	if (format[0] == 'X') {
+		loop->_stats._errors++;
+	}
+	va_start(args, format);
+	int len = vsnprintf(session->_out + session->_out_len, SESSION_OUT_SIZE - session->_out_len, format, args);
+	va_end(args);
+	if (len > 0) {
+		session->_out_len += (size_t)len;
+	}
+}
+
+//Saves the session's table to the slot its last save did not write (a single write), so a crash in the middle of it
+//leaves the last save whole. Nothing without a snapshots directory.
+static void session_save(Server_loop_t* loop, Session_t* session) {
+	Table_snapshot_t snapshot;
+
+	if (!loop->_config->_snapshots)
+		return;
+	if (session->_snapshot_fd < 0) {
+		char path[SNAPSHOT_PATH_LEN];
+		snapshot_path(loop->_config, session->_key, path);
+		session->_snapshot_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (session->_snapshot_fd < 0) {
+			fprintf(stderr, "Warning: function[session_save()]: Cannot create %s: %s\n", path, strerror(errno));
+			return;
+		}
+		if (flock(session->_snapshot_fd, LOCK_EX | LOCK_NB) != 0) {
+			fprintf(stderr, "Warning: function[session_save()]: Cannot lock %s: %s\n", path, strerror(errno));
+			close(session->_snapshot_fd);
+			session->_snapshot_fd = -1;
+			return;
+		}
+	}
+	table_snapshot(&session->_table, &snapshot);
+	if (snapshot_write_slot(session->_snapshot_fd, &snapshot, session->_saves) != SUCCESS) { //retried on the same slot
+		fprintf(stderr, "Warning: function[session_save()]: Failed saving session %016" PRIx64 "\n", session->_key);
+		return;
+	}
+	session->_saves++;
+}
+
+//Puts the session in the state saved under 'key', and takes that key over. A key another open session holds (it
+//has the snapshot locked) is refused. Returns: RESUME_DONE, RESUME_NO_SESSION or RESUME_IN_USE.
+static int session_resume(Server_loop_t* loop, Session_t* session, uint64_t key) {
+	char path[SNAPSHOT_PATH_LEN];
+	Table_snapshot_t snapshot;
+	bool own = key == session->_key && session->_snapshot_fd >= 0; //locked by this session already
+	uint64_t saves = 0;
+	int fd = -1;
+
+	snapshot_path(loop->_config, key, path);
+	if (!own) {
+		fd = open(path, O_RDWR | O_CLOEXEC);
+		if (fd < 0)
+			return RESUME_NO_SESSION;
+		if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+			int busy = errno == EWOULDBLOCK;
+			close(fd);
+			return busy ? RESUME_IN_USE : RESUME_NO_SESSION;
+		}
+	}
+	if (snapshot_read_slots(own ? session->_snapshot_fd : fd, &snapshot, &saves) != SUCCESS ||
+		table_restore(&session->_table, &snapshot) != SUCCESS) {
+		if (fd >= 0)
+			close(fd);
+		return RESUME_NO_SESSION;
+	}
+
+	if (!own) {
+		if (session->_snapshot_fd >= 0) { //the session's own state is gone
+			close(session->_snapshot_fd);
+			snapshot_path(loop->_config, session->_key, path);
+			unlink(path);
+		}
+		session->_snapshot_fd = fd;
+	}
+	session->_key = key;
+	session->_saves = saves + 1; //the next save goes to the other slot
+	session->_in_round = snapshot_in_round(&snapshot);
+	return RESUME_DONE;
+}
+
+//A key from the kernel's random source: a key is the only credential of a resume, so it must not be guessable from
+//the server's start or from other sessions keys. Returns: false- no random source.
+static bool session_new_key(uint64_t* key) {
+	if (getrandom(key, sizeof(*key), 0) == (ssize_t)sizeof(*key))
+		return true;
+
+	int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+	bool got = fd >= 0 && read(fd, key, sizeof(*key)) == (ssize_t)sizeof(*key);
+	if (fd >= 0) {
+		close(fd);
+	}
+	return got;
+}
+
+static void snapshot_path(const Server_config_t* config, uint64_t key, char* path) {
+	snprintf(path, SNAPSHOT_PATH_LEN, "%s/%016" PRIx64, config->_snapshots, key);
+}
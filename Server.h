@@ -0,0 +1,52 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the "Black Jack" game server: many independent tables in one process.
+ *              Every connection is a session playing its own headless table. Sessions are served by
+ *              epoll event loops (one per thread), so a waiting player never blocks the others.
+ *
+ *              Protocol: text lines, a single reply line to every request line.
+ *                  "B <bet>"  start a round     -> "T <hand value> <dealer up card>" player's turn,
+ *                                                  or "R <W|L|P> <cash>" round over (Win/Lose/Push)
+ *                  "H" / "S"  hit / stand       -> "T ..." or "R ..."
+ *                  "Q"        quit (the server closes the connection)
+ *                  "K"        session key       -> "K <key>" (16 hex digits, from the kernel's random source)
+ *                  "C <key>"  resume the session saved under the key, between rounds (e.g. after a server crash)
+ *                                               -> "T ..." its round in play, or "C <cash>"
+ *                                                  ("X session in use" while another connection holds the key)
+ *                  errors                       -> "X <reason>"
+ *              Cards are in the suit_rank encoding (see Cards.h).
+ *              With a snapshots directory, a session's table is saved to "<directory>/<key>" (see Snapshot.h) after
+ *              every round step, and removed when the session quits. The file has two slots written in turns (see
+ *              snapshot_write_slot()), so a crash in the middle of a save leaves the previous one to resume from.
+ * Language:  C
+*/
+#include<stdint.h>
+#include "Black_Jack.h"
+
+#define SERVER_BANKROLL 1000000 //a session's cash at start, and whenever it cannot cover its bet
+#define SERVER_MAX_LOOPS 256
+
+typedef struct Server_config {
+	const char* _address;    //see Net.h (NULL: NET_DEFAULT_ADDRESS)
+	unsigned int _loops;     //event loop threads (0: all the online cores)
+	uint64_t _seed;          //seeds the sessions tables
+	uint8_t _decks;          //0: the game's default shoe
+	double _penetration;
+	const char* _snapshots;  //not NULL: the sessions snapshots directory (crash recovery)
+}Server_config_t;
+
+typedef struct Server_stats {
+	uint64_t _sessions;      //connections accepted
+	uint64_t _peak_sessions; //most sessions open at once (sum of the loops peaks)
+	uint64_t _requests;
+	uint64_t _rounds;
+	uint64_t _errors;        //"X" replies
+}Server_stats_t;
+
+//Serves sessions until server_stop() is called. The loops results are added to 'stats'.
+//Returns: FAIL in case of fail, otherwise SUCCESS.
+int server_run(const Server_config_t* config, Server_stats_t* stats);
+
+//Stops a running server_run(). Async signal safe.
+void server_stop(void);
@@ -0,0 +1,167 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of an array based cards Shoe.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>//memcpy
+#include<stdbool.h>
+#include "Shoe.h"
+#include "Cards.h"
+#include "Stats.h"
+
+
+#define FAIL -1
+#define SUCCESS 0
+
+
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+Shoe_t* create_shoe(size_t capacity, Rng_t* rng) {
+	//calloc ssures all pointers are set to NULL and vars to 0 in a new shoe
+	Shoe_t* shoe = (Shoe_t*)calloc(1, sizeof(Shoe_t));
+	assert_condition(rng, "Error: function[create_shoe()]: Argument Rng_t* is NULL");
+	assert_condition(shoe, "Error: function[create_shoe()]: Failed allocating memory for new shoe");
+
+	shoe->_cards = (uint8_t*)calloc(capacity, sizeof(uint8_t));
+	assert_condition(shoe->_cards, "Error: function[create_shoe()]: Failed allocating memory for shoe cards");
+	shoe->_capacity = capacity;
+	shoe->_rng = rng;
+	return shoe;
+}
+
+size_t fill_shoe(Shoe_t* shoe, const uint8_t* cards, size_t count) {
+	assert_condition(shoe, "Error: function[fill_shoe()]: Argument Shoe_t* is NULL");
+	assert_condition(cards, "Error: function[fill_shoe()]: Argument cards* is NULL");
+	assert_condition(!shoe->_in_play && !shoe->_discards, "Error: function[fill_shoe()]: Only a shoe with no cards drawn can be filled");
+
+	if (count > shoe->_capacity - shoe->_count) {
+		count = shoe->_capacity - shoe->_count;
+	}
+	memcpy(shoe->_cards + shoe->_count, cards, count);
+	shoe->_count += count;
+	return count;
+}
+
+void shuffle_shoe(Shoe_t* shoe) {
+	assert_condition(shoe, "Error: function[shuffle_shoe()]: Argument Shoe_t* is NULL");
+
+	uint8_t tmp = 0;
+	for (size_t i = shoe->_count; i > 1; --i) {
+		size_t j = rng_below(shoe->_rng, (uint32_t)i);
+		tmp = shoe->_cards[i - 1];
+		shoe->_cards[i - 1] = shoe->_cards[j];
+		shoe->_cards[j] = tmp;
+	}
+}
+
+void set_shoe_penetration(Shoe_t* shoe, double penetration) {
+	assert_condition(shoe, "Error: function[set_shoe_penetration()]: Argument Shoe_t* is NULL");
+
+	if (penetration <= 0 || penetration > 1) {
+		fprintf(stderr, "Warning: function[set_shoe_penetration()]: Argument 'penetration' = %.2f. Must be in range (0-1]. Penetration not changed\n.", penetration);
+		return;
+	}
+	shoe->_cut = shoe->_capacity - (size_t)(penetration * shoe->_capacity);
+}
+
+void set_shoe_observer(Shoe_t* shoe, shoe_observer observer, void* ctx) {
+	assert_condition(shoe, "Error: function[set_shoe_observer()]: Argument Shoe_t* is NULL");
+
+	shoe->_observer = observer;
+	shoe->_observer_ctx = ctx;
+}
+
+int shoe_draw(Shoe_t* shoe, uint8_t* card) {
+	assert_condition(shoe, "Error: function[shoe_draw()]: Argument Shoe_t* is NULL");
+	assert_condition(card, "Error: function[shoe_draw()]: Argument card* is NULL");
+
+	if (shoe->_count == 0) {
+		shoe_reshuffle(shoe); //ran out of cards in the middle of a round
+		if (shoe->_count == 0)
+			return FAIL;
+	}
+	//the drawn card swaps places with the last card in the shoe, which then moves to the cards in play
+	size_t pos = rng_below(shoe->_rng, (uint32_t)shoe->_count);
+	size_t last = --shoe->_count;
+
+	*card = shoe->_cards[pos];
+	shoe->_cards[pos] = shoe->_cards[last];
+	shoe->_cards[last] = *card;
+	shoe->_in_play++;
+	if (shoe->_observer) {
+		shoe->_observer(shoe->_observer_ctx, shoe, SHOE_DRAW, *card);
+	}
+	return SUCCESS;
+}
+
+void shoe_discard(Shoe_t* shoe, size_t count) {
+	assert_condition(shoe, "Error: function[shoe_discard()]: Argument Shoe_t* is NULL");
+	assert_condition(count <= shoe->_in_play, "Error: function[shoe_discard()]: Discarding more cards than in play");
+
+	//the discards follow the cards in play, so only the counters move
+	shoe->_in_play -= count;
+	shoe->_discards += count;
+}
+
+bool shoe_cut_card_out(Shoe_t* shoe) {
+	assert_condition(shoe, "Error: function[shoe_cut_card_out()]: Argument Shoe_t* is NULL");
+	return shoe->_count <= shoe->_cut;
+}
+
+//reverses the cards in [from, to)
+static void reverse_cards(uint8_t* cards, size_t from, size_t to) {
+	uint8_t tmp = 0;
+	while (from + 1 < to) {
+		tmp = cards[from];
+		cards[from++] = cards[--to];
+		cards[to] = tmp;
+	}
+}
+
+void shoe_reshuffle(Shoe_t* shoe) {
+	assert_condition(shoe, "Error: function[shoe_reshuffle()]: Argument Shoe_t* is NULL");
+
+	if (shoe->_in_play && shoe->_discards) {
+		//rotating the cards in play behind the discards, so the discards follow the cards left in the shoe
+		size_t start = shoe->_count;
+		size_t discards_start = start + shoe->_in_play;
+		reverse_cards(shoe->_cards, start, discards_start);
+		reverse_cards(shoe->_cards, discards_start, shoe->_capacity);
+		reverse_cards(shoe->_cards, start, shoe->_capacity);
+	}
+	//draws are random, so the discards need no shuffling of their own
+	shoe->_count += shoe->_discards;
+	shoe->_discards = 0;
+	shoe->_shuffles++;
+	STATS_COUNT(STATS_SHUFFLES, 1);
+	if (shoe->_observer) {
+		shoe->_observer(shoe->_observer_ctx, shoe, SHOE_RESHUFFLE, CARD_NONE);
+	}
+}
+
+size_t shoe_available(Shoe_t* shoe) {
+	assert_condition(shoe, "Error: function[shoe_available()]: Argument Shoe_t* is NULL");
+	return shoe->_count + shoe->_discards;
+}
+
+void clear_shoe(Shoe_t* shoe) {
+	if (!shoe)
+		return;
+	free(shoe->_cards);
+	free(shoe);
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!errorMsg) {
+		fprintf(stderr, "%s", "Error: function[assert_condition()]: pointer provided to argument 'errorMsg' is Null. exitting");
+		exit(EXIT_FAILURE);
+	}
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
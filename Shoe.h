@@ -0,0 +1,70 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header file of an array based cards Shoe of 1-8 decks. Cards are kept as single bytes in the
+ *              game's suit_rank encoding, so drawing and discarding a card are O(1).
+ *              A cut card sets the shoe penetration: the shoe is reshuffled only once the cut card came out.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include"Rng.h"
+
+//Cards movements reported to the shoe's observer
+enum shoe_event { SHOE_DRAW /*'card' left the shoe*/, SHOE_RESHUFFLE /*the discards are back in the shoe*/ };
+
+struct Shoe;
+//Called on every shoe_event ('card' is CARD_NONE on a reshuffle). Must not draw from the shoe.
+typedef void (*shoe_observer)(void* ctx, const struct Shoe* shoe, enum shoe_event event, uint8_t card);
+
+//structs
+//Cards layout: [0, _count) cards left in the shoe. Then [_count, _count + _in_play) cards drawn and still in play,
+//then [_count + _in_play, _capacity) the discards. Drawing picks a random card out of the shoe, so the shoe
+//never needs a full reshuffle: reshuffling just moves the discards back into it.
+typedef struct Shoe {
+	uint8_t* _cards;
+	size_t _count;
+	size_t _capacity;
+	size_t _in_play;   //cards drawn and not discarded yet
+	size_t _discards;
+	size_t _cut;       //the cut card comes out when no more than _cut cards are left in the shoe
+	uint64_t _shuffles;
+	Rng_t* _rng;       //shuffles and draws randomness (owned by the caller)
+	shoe_observer _observer; //optional
+	void* _observer_ctx;
+}Shoe_t;
+
+//creation and initialization:
+//Creates an empty shoe with room for 'capacity' cards, drawing its randomness from 'rng'
+Shoe_t* create_shoe(size_t capacity, Rng_t* rng);
+
+//Fills the shoe with the given cards (up to its capacity). Returns number of cards added.
+size_t fill_shoe(Shoe_t* shoe, const uint8_t* cards, size_t count);
+
+//Fisher-Yates shuffle of the cards left in the shoe
+void shuffle_shoe(Shoe_t* shoe);
+
+//Places the cut card: 'penetration' (0-1] is the part of the shoe dealt before it is reshuffled
+void set_shoe_penetration(Shoe_t* shoe, double penetration);
+
+//Sets the shoe's observer (NULL: none)
+void set_shoe_observer(Shoe_t* shoe, shoe_observer observer, void* ctx);
+
+//Draws a random card out of the shoe (a single lazy Fisher-Yates step: O(1)). If the shoe is empty, the discards
+//are reshuffled into it first. Returns the card in 'card'. Returns: FAIL if no card is left, otherwise SUCCESS.
+int shoe_draw(Shoe_t* shoe, uint8_t* card);
+
+//Moves 'count' cards in play to the discards (the hands of a finished round)
+void shoe_discard(Shoe_t* shoe, size_t count);
+
+//Returns true once the cut card came out
+bool shoe_cut_card_out(Shoe_t* shoe);
+
+//Reshuffles the discards back into the shoe. Cards still in play stay out. O(1) when no card is in play.
+void shoe_reshuffle(Shoe_t* shoe);
+
+//Number of cards the shoe can still deal (left in the shoe or in the discards)
+size_t shoe_available(Shoe_t* shoe);
+
+void clear_shoe(Shoe_t* shoe);
@@ -0,0 +1,330 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the headless "Black Jack" simulation.
+ *              The rounds are played by play_round() of Black_Jack.c on a headless table.
+ *              Link with Black_Jack.c compiled with -DBJ_NO_MAIN (and -pthread).
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>//sysconf()
+#include "Simulation.h"
+#include "Exact_ev.h"
+#include "SLL.h" //allocation stats
+
+#define DEFAULT_HIT_BELOW 17
+#define MAX_THREADS 1024
+#define MAX_PATH_LEN 4096
+
+
+//Bets by the count: _bet_spread of Sim_config_t
+typedef struct Sim_ramp {
+	const Count_t* _count;
+	enum count_system _system;
+	uint8_t _spread;
+}Sim_ramp_t;
+
+//A worker of simulate_parallel(): its own table, rounds share and results
+typedef struct Sim_worker {
+	pthread_t _thread;
+	Table_t _table;
+	Ev_player_t _ev_player;  //_exact_ev decisions: the worker's own cache
+	Count_t _count;          //_bet_spread: the worker's shoe count
+	History_writer_t* _history; //config _history: the worker's log
+	Column_writer_t* _columns;  //config _columns: the worker's export
+	size_t _rounds;
+	Sim_ramp_t _ramp;
+	int _result;
+	Sim_stats_t _stats;
+}Sim_worker_t;
+
+
+static void sim_table_init(Table_t* table, uint32_t bet, hit_stand_decision decide, void* ctx, const Rng_t* rng);
+static int sim_run(Table_t* table, size_t rounds, const Sim_ramp_t* ramp, Sim_stats_t* stats);
+static void sim_count_round(const Table_t* table, uint32_t stake, int64_t equity, Sim_stats_t* stats);
+static void* sim_worker_run(void* arg);
+static void assert_condition(bool isValid, const char* errorMsg, bool isFatal);
+
+
+char sim_hit_below(Player_t* player, Player_t* dealer, void* ctx) {
+	uint32_t hit_below = ctx ? (uint32_t)(uintptr_t)ctx : DEFAULT_HIT_BELOW;
+	return player->_hand._value < hit_below ? 'H' : 'S';
+}
+
+int simulate(size_t rounds, uint32_t bet, hit_stand_decision decide, void* ctx, Sim_stats_t* stats) {
+	return simulate_seeded(rounds, bet, decide, ctx, (uint64_t)time(NULL), stats);
+}
+
+int simulate_seeded(size_t rounds, uint32_t bet, hit_stand_decision decide, void* ctx, uint64_t seed, Sim_stats_t* stats) {
+	assert_condition(stats, "Error: function[simulate_seeded()]: pointer provided to argument 'stats' is Null. exitting", true);
+
+	Table_t table;
+	Rng_t rng;
+	int result = FAIL;
+
+	if (!bet || bet > SIM_BANKROLL) {
+		fprintf(stderr, "Warning: function[simulate_seeded()]: Argument 'bet' = %u. Must be in range 1-%d\n", bet, SIM_BANKROLL);
+		return FAIL;
+	}
+
+	rng_seed(&rng, seed);
+	sim_table_init(&table, bet, decide, ctx, &rng);
+	result = sim_run(&table, rounds, NULL, stats);
+	table_clear(&table);
+	return result;
+}
+
+int simulate_parallel(const Sim_config_t* config, Sim_stats_t* stats) {
+	assert_condition(config && stats, "Error: function[simulate_parallel()]: Null config or stats pointer provided. exitting", true);
+
+	Sim_worker_t* workers = NULL;
+	Rng_t stream;
+	int result = SUCCESS;
+	const size_t rounds = config->_rounds;
+	const uint32_t bet = config->_bet;
+	unsigned int threads = config->_threads;
+
+	if (!bet || (uint64_t)bet * (config->_bet_spread > 1 ? config->_bet_spread : 1) > SIM_BANKROLL) {
+		fprintf(stderr, "Warning: function[simulate_parallel()]: Bet %u (spread %u). Must be in range 1-%d\n", bet, config->_bet_spread, SIM_BANKROLL);
+		return FAIL;
+	}
+	if (config->_bet_spread > 1 && config->_count_system >= COUNT_SYSTEMS) {
+		fprintf(stderr, "Warning: function[simulate_parallel()]: Invalid count system %d\n", config->_count_system);
+		return FAIL;
+	}
+	if (!threads) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned int)cores : 1;
+	}
+	if (threads > MAX_THREADS) {
+		threads = MAX_THREADS;
+	}
+
+	workers = (Sim_worker_t*)calloc(threads, sizeof(Sim_worker_t));
+	assert_condition(workers, "Error: function[simulate_parallel()]: Failed allocating memory for workers", true);
+
+	//tables are initialized here, before any worker starts. Rounds split evenly, the remainder goes to the first workers.
+	rng_seed(&stream, config->_seed);
+	if (config->_from) {
+		stream = config->_from->_rng;
+	}
+	for (unsigned int i = 0; i < threads; ++i) {
+		sim_table_init(&workers[i]._table, bet, config->_decide, config->_ctx, &stream);
+		rng_jump(&stream); //next worker's stream
+		if (config->_exact_ev) {
+			workers[i]._ev_player._cache = create_ev_cache(0);
+			workers[i]._ev_player._table = &workers[i]._table;
+			workers[i]._table._decide = exact_ev_decide;
+			workers[i]._table._decide_ctx = &workers[i]._ev_player;
+		}
+		if (config->_from) { //a branch: the snapshot's state, the worker's own stream
+			Rng_t branch = workers[i]._table._rng;
+			if (table_restore(&workers[i]._table, config->_from) != SUCCESS) {
+				result = FAIL;
+			}
+			workers[i]._table._rng = branch;
+			workers[i]._table._auto_bet = bet;
+		}
+		else if (config->_decks && table_set_shoe(&workers[i]._table, config->_decks, config->_penetration) != SUCCESS) {
+			result = FAIL;
+		}
+		if (config->_bet_spread > 1) {
+			count_attach(&workers[i]._count, workers[i]._table._deck);
+			workers[i]._ramp._count = &workers[i]._count;
+			workers[i]._ramp._system = config->_count_system;
+			workers[i]._ramp._spread = config->_bet_spread;
+		}
+		if (config->_history && result == SUCCESS) { //the log snapshot is the shoe the worker starts with
+			char path[MAX_PATH_LEN];
+			snprintf(path, sizeof(path), "%s.%u", config->_history, i);
+			workers[i]._history = create_history_writer(path, &workers[i]._table);
+			result = workers[i]._history ? result : FAIL;
+		}
+		if (config->_columns && result == SUCCESS) {
+			char path[MAX_PATH_LEN];
+			snprintf(path, sizeof(path), "%s.%u", config->_columns, i);
+			workers[i]._columns = create_column_writer(path, &workers[i]._table);
+			result = workers[i]._columns ? result : FAIL;
+		}
+		workers[i]._rounds = rounds / threads + (i < rounds % threads ? 1 : 0);
+	}
+	if (result != SUCCESS) {
+		for (unsigned int i = 0; i < threads; ++i) {
+			clear_history_writer(workers[i]._history);
+			clear_column_writer(workers[i]._columns);
+			table_clear(&workers[i]._table);
+			clear_ev_cache(workers[i]._ev_player._cache);
+		}
+		free(workers);
+		return FAIL;
+	}
+	for (unsigned int i = 1; i < threads; ++i) {
+		if (pthread_create(&workers[i]._thread, NULL, sim_worker_run, &workers[i]) != 0) {
+			fprintf(stderr, "Warning: function[simulate_parallel()]: Failed creating worker %u. Running it inline\n", i);
+			sim_worker_run(&workers[i]);
+			workers[i]._thread = 0;
+		}
+	}
+	sim_worker_run(&workers[0]); //the calling thread is worker 0
+
+	//merging in workers order
+	for (unsigned int i = 0; i < threads; ++i) {
+		if (i && workers[i]._thread) {
+			pthread_join(workers[i]._thread, NULL);
+		}
+		if (workers[i]._result != SUCCESS) {
+			result = FAIL;
+		}
+		if (clear_history_writer(workers[i]._history) != SUCCESS) {
+			fprintf(stderr, "Warning: function[simulate_parallel()]: History log of worker %u is incomplete\n", i);
+			result = FAIL;
+		}
+		if (clear_column_writer(workers[i]._columns) != SUCCESS) {
+			fprintf(stderr, "Warning: function[simulate_parallel()]: Columns export of worker %u is incomplete\n", i);
+			result = FAIL;
+		}
+		sim_stats_merge(stats, &workers[i]._stats);
+		table_clear(&workers[i]._table);
+		clear_ev_cache(workers[i]._ev_player._cache);
+	}
+
+	free(workers);
+	return result;
+}
+
+void sim_stats_merge(Sim_stats_t* to, const Sim_stats_t* from) {
+	assert_condition(to && from, "Error: function[sim_stats_merge()]: Null stats pointer provided. exitting", true);
+
+	to->_rounds += from->_rounds;
+	to->_player_wins += from->_player_wins;
+	to->_dealer_wins += from->_dealer_wins;
+	to->_ties += from->_ties;
+	to->_black_jacks += from->_black_jacks;
+	to->_player_busts += from->_player_busts;
+	to->_dealer_busts += from->_dealer_busts;
+	to->_rebuys += from->_rebuys;
+	to->_wagered += from->_wagered;
+	to->_net += from->_net;
+	to->_heap_allocs += from->_heap_allocs;
+	to->_shuffles += from->_shuffles;
+}
+
+double sim_player_edge(const Sim_stats_t* stats) {
+	return stats->_wagered ? (double)stats->_net / (double)stats->_wagered : 0.0;
+}
+
+static void sim_table_init(Table_t* table, uint32_t bet, hit_stand_decision decide, void* ctx, const Rng_t* rng) {
+	table_init_rng(table, true, rng);
+	strcpy(table->_player._info._name, "Simulator");
+	table->_player._info._id = 1;
+	table->_player._account._cash = SIM_BANKROLL;
+	table->_auto_bet = bet;
+	table->_decide = decide ? decide : sim_hit_below;
+	table->_decide_ctx = decide ? ctx : NULL;
+}
+
+static void* sim_worker_run(void* arg) {
+	Sim_worker_t* worker = (Sim_worker_t*)arg;
+	worker->_result = sim_run(&worker->_table, worker->_rounds, worker->_ramp._count ? &worker->_ramp : NULL, &worker->_stats);
+	return NULL;
+}
+
+//Units bet by the count: 1 unit up to a count of 1, then a unit more per count point, up to the spread
+static uint32_t sim_ramp_units(const Sim_ramp_t* ramp) {
+	double count = ramp->_system == COUNT_KO ? (double)ramp->_count->_running[COUNT_KO] : count_true(ramp->_count, ramp->_system);
+
+	if (count < 2)
+		return 1;
+	return count >= ramp->_spread ? ramp->_spread : (uint32_t)count;
+}
+
+//plays 'rounds' rounds on an initialized headless table. 'ramp' (optional) sizes the bets by the count.
+static int sim_run(Table_t* table, size_t rounds, const Sim_ramp_t* ramp, Sim_stats_t* stats) {
+	Account_t* account = &table->_player._account;
+	Account_t* house = &table->_dealer._account;
+	const int32_t house_cash = house->_cash;
+	const uint32_t unit = table->_auto_bet;
+	uint32_t bet = unit;
+	int64_t equity = 0;
+	const uint64_t shuffles = table->_deck->_shuffles;
+	bool pending = table->_player._cards._count > 0; //a table restored in the middle of a round finishes it first
+	Sll_alloc_stats_t allocs_start, allocs_end;
+	const uint64_t typed_allocs = typed_list_allocs;
+
+	sll_alloc_stats(&allocs_start);
+
+	for (size_t i = 0; i < rounds; ++i) {
+		if (pending) {
+			equity = (int64_t)account->_cash + account->_bet;
+			uint32_t stake = account->_bet;
+			int step = ROUND_PLAYER_TURN;
+			while (step == ROUND_PLAYER_TURN) {
+				step = round_turn(table);
+			}
+			pending = false;
+			sim_count_round(table, stake, equity, stats);
+			continue;
+		}
+		if (ramp) { //the cut card out: this round's deal reshuffles, so it is a fresh shoe's bet
+			bet = unit * (shoe_cut_card_out(table->_deck) ? 1 : sim_ramp_units(ramp));
+			table->_auto_bet = bet;
+		}
+		//re-buy when the player cannot cover the bet. The house budget is refilled the same way.
+		if (account->_cash + (int64_t)account->_bet < bet) {
+			account->_cash = SIM_BANKROLL;
+			account->_bet = 0;
+			stats->_rebuys++;
+		}
+		if (house->_cash < (int64_t)house_cash / 2) {
+			house->_cash = house_cash;
+		}
+
+		equity = (int64_t)account->_cash + account->_bet;
+		uint32_t stake = account->_bet > bet ? account->_bet : bet; //a push leaves the last bet on the table
+		if (!play_round(table) && table->_outcome == OUTCOME_NONE) {
+			fprintf(stderr, "Warning: function[sim_run()]: round %zu was not played\n", i);
+			return FAIL;
+		}
+		sim_count_round(table, stake, equity, stats);
+	}
+	sll_alloc_stats(&allocs_end);
+	stats->_heap_allocs += allocs_end._mallocs - allocs_start._mallocs + (typed_list_allocs - typed_allocs);
+	stats->_shuffles += table->_deck->_shuffles - shuffles;
+	return SUCCESS;
+}
+
+//adds a played round to the stats. 'equity': the player's cash and bet when the round started.
+static void sim_count_round(const Table_t* table, uint32_t stake, int64_t equity, Sim_stats_t* stats) {
+	const Account_t* account = &table->_player._account;
+
+	stats->_rounds++;
+	stats->_wagered += stake;
+	stats->_net += (int64_t)account->_cash + account->_bet - equity;
+	stats->_black_jacks += table->_black_jack;
+	stats->_player_busts += table->_player_bust;
+	stats->_dealer_busts += table->_dealer_bust;
+	switch (table->_outcome) {
+	case OUTCOME_PLAYER_WIN: stats->_player_wins++; break;
+	case OUTCOME_DEALER_WIN: stats->_dealer_wins++; break;
+	default: stats->_ties++; break;
+	}
+}
+
+static void assert_condition(bool isValid, const char* errorMsg, bool isFatal) {
+
+	if (!errorMsg) {
+		fprintf(stderr, "%s", "Error: function[assert_condition()]: pointer provided to argument 'errorMsg' is Null. exitting");
+		exit(EXIT_FAILURE);
+	}
+
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		if (isFatal) {
+			exit(EXIT_FAILURE);
+		}
+	}
+}
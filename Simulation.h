@@ -0,0 +1,74 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the headless "Black Jack" simulation. Runs the game phases of Black_Jack.c
+ *              with a decision callback instead of the terminal, and collects the rounds results.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include "Black_Jack.h"
+#include "Count.h"
+#include "History.h"
+#include "Columns.h"
+#include "Snapshot.h"
+
+#define SIM_BANKROLL 1000000 //player's cash at start and on every re-buy
+
+typedef struct Sim_stats {
+	uint64_t _rounds;
+	uint64_t _player_wins;
+	uint64_t _dealer_wins;
+	uint64_t _ties;
+	uint64_t _black_jacks;
+	uint64_t _player_busts;
+	uint64_t _dealer_busts;
+	uint64_t _rebuys;        //times the player's bankroll was refilled
+	uint64_t _wagered;       //sum of bets played
+	int64_t _net;            //player's net win (negative: house wins)
+	uint64_t _heap_allocs;   //list heap allocations made while playing the rounds (SLL and typed lists blocks)
+	uint64_t _shuffles;      //shoe reshuffles (cut card came out)
+}Sim_stats_t;
+
+//simulate_parallel() settings
+typedef struct Sim_config {
+	size_t _rounds;
+	unsigned int _threads;       //0: all the online cores
+	uint64_t _seed;
+	uint32_t _bet;
+	uint8_t _decks;              //0: the game's default shoe
+	double _penetration;         //part of the shoe dealt before reshuffling (with _decks)
+	hit_stand_decision _decide;  //NULL: sim_hit_below()
+	void* _ctx;
+	bool _exact_ev;              //plays the best exact EV decision of the shoe in play instead (see Exact_ev.h)
+	uint8_t _bet_spread;         //>1: every round bets _bet times the count (1-_bet_spread), see Count.h
+	enum count_system _count_system; //with _bet_spread: true count, or running count for the unbalanced KO
+	const char* _history;        //not NULL: worker i logs its rounds to "<_history>.<i>" (see History.h)
+	const char* _columns;        //not NULL: worker i exports its rounds to "<_columns>.<i>" (see Columns.h)
+	const Table_snapshot_t* _from; //not NULL: every worker is a branch of this table state (instead of _seed and
+	                             //_decks): worker 0 goes on with its generator, worker i with it jumped i times.
+	                             //A round in play is finished first (counted in _rounds).
+}Sim_config_t;
+
+//Strategy used when no decision callback is supplied: hit while the hand value is below 'ctx' (uintptr_t), default 17.
+char sim_hit_below(Player_t* player, Player_t* dealer, void* ctx);
+
+//Plays 'rounds' rounds of 'bet' each, asking 'decide' (with 'ctx') on every Hit or Stand phase.
+//Results are added to 'stats' (not zeroed, so several runs may be accumulated).
+//Returns: FAIL in case of fail, otherwise SUCCESS.
+int simulate(size_t rounds, uint32_t bet, hit_stand_decision decide, void* ctx, Sim_stats_t* stats);
+
+//Same as simulate() with the table seeded by 'seed' (same seed and same decisions -> same results).
+int simulate_seeded(size_t rounds, uint32_t bet, hit_stand_decision decide, void* ctx, uint64_t seed, Sim_stats_t* stats);
+
+//Splits the configured rounds between worker threads. Every worker plays its own table and shoe, its generator
+//jumped to its own stream of the seed (see rng_jump()), and the workers results are merged into 'stats'.
+//The same config always gives the same results. The decision callback must be thread safe.
+//Returns: FAIL in case of fail, otherwise SUCCESS.
+int simulate_parallel(const Sim_config_t* config, Sim_stats_t* stats);
+
+//Adds 'from' results to 'to'
+void sim_stats_merge(Sim_stats_t* to, const Sim_stats_t* from);
+
+//Player's expected return per unit bet (house edge is its negation)
+double sim_player_edge(const Sim_stats_t* stats);
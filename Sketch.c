@@ -0,0 +1,100 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the streaming quantile sketch.
+ *              A value's bucket is taken from its bits: below 2^SKETCH_SUB_BITS the value itself, otherwise its
+ *              power of 2 (the highest bit) and the SKETCH_SUB_BITS bits after it.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdbool.h>
+#include "Sketch.h"
+
+#define SUB_BUCKETS (1u << SKETCH_SUB_BITS)
+
+
+static inline uint32_t bucket_index(uint32_t value);
+static inline double bucket_middle(uint32_t index);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+void sketch_reset(Sketch_t* sketch) {
+	assert_condition(sketch, "Error: function[sketch_reset()]: Null sketch pointer provided");
+
+	memset(sketch, 0, sizeof(Sketch_t));
+}
+
+void sketch_add(Sketch_t* sketch, uint32_t value) {
+	if (!sketch->_count || value < sketch->_min) {
+		sketch->_min = value;
+	}
+	if (value > sketch->_max) {
+		sketch->_max = value;
+	}
+	sketch->_count++;
+	sketch->_buckets[bucket_index(value)]++;
+}
+
+void sketch_merge(Sketch_t* to, const Sketch_t* from) {
+	assert_condition(to && from, "Error: function[sketch_merge()]: Null sketch pointer provided");
+
+	if (!from->_count)
+		return;
+	if (!to->_count || from->_min < to->_min) {
+		to->_min = from->_min;
+	}
+	if (from->_max > to->_max) {
+		to->_max = from->_max;
+	}
+	to->_count += from->_count;
+	for (uint32_t b = 0; b < SKETCH_BUCKETS; ++b) {
+		to->_buckets[b] += from->_buckets[b];
+	}
+}
+
+double sketch_quantile(const Sketch_t* sketch, double quantile) {
+	assert_condition(sketch, "Error: function[sketch_quantile()]: Null sketch pointer provided");
+
+	if (!sketch->_count)
+		return 0.0;
+
+	uint64_t rank = (uint64_t)(quantile * sketch->_count);
+	uint64_t seen = 0;
+	rank = rank < sketch->_count ? rank : sketch->_count - 1;
+	for (uint32_t b = 0; b < SKETCH_BUCKETS; ++b) {
+		seen += sketch->_buckets[b];
+		if (seen > rank) {
+			double middle = bucket_middle(b);
+			return middle < sketch->_min ? sketch->_min : middle > sketch->_max ? sketch->_max : middle;
+		}
+	}
+	return sketch->_max;
+}
+
+static inline uint32_t bucket_index(uint32_t value) {
+	if (value < SUB_BUCKETS)
+		return value;
+
+	uint32_t power = 31 - (uint32_t)__builtin_clz(value); //>= SKETCH_SUB_BITS
+	uint32_t sub = (value >> (power - SKETCH_SUB_BITS)) & (SUB_BUCKETS - 1);
+	return ((power - SKETCH_SUB_BITS + 1) << SKETCH_SUB_BITS) + sub;
+}
+
+//The middle of the bucket's values range
+static inline double bucket_middle(uint32_t index) {
+	if (index < SUB_BUCKETS)
+		return index;
+
+	uint32_t shift = (index >> SKETCH_SUB_BITS) - 1;
+	double low = (double)((uint64_t)(SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift);
+	return low + (double)((uint64_t)1 << shift) / 2;
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
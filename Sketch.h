@@ -0,0 +1,35 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the streaming quantile sketch: the quantiles of a stream of values without keeping them.
+ *              Values are counted in log-linear buckets: values below 2^SKETCH_SUB_BITS exactly, larger ones in
+ *              2^SKETCH_SUB_BITS buckets per power of 2 (a relative error under 1/2^(SKETCH_SUB_BITS+1)).
+ *              A sketch is a flat array of counters: adding a value is O(1), and sketches of different threads
+ *              are merged by adding them up.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+
+#define SKETCH_SUB_BITS 7
+#define SKETCH_BUCKETS ((32 - SKETCH_SUB_BITS + 1) << SKETCH_SUB_BITS) //32 bits values
+
+typedef struct Sketch {
+	uint64_t _count;
+	uint32_t _min;
+	uint32_t _max;
+	uint64_t _buckets[SKETCH_BUCKETS];
+}Sketch_t;
+
+//Empties the sketch (a zeroed Sketch_t is empty too)
+void sketch_reset(Sketch_t* sketch);
+
+//Counts a value
+void sketch_add(Sketch_t* sketch, uint32_t value);
+
+//Adds the values counted by 'from' to 'to'
+void sketch_merge(Sketch_t* to, const Sketch_t* from);
+
+//The value under which 'quantile' (0-1) of the values are (the middle of its bucket, within the min and max).
+//Returns 0 for an empty sketch.
+double sketch_quantile(const Sketch_t* sketch, double quantile);
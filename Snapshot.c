@@ -0,0 +1,379 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the table snapshots.
+ *              Encoding (integers little endian):
+ *                "BJSN", encoded size (4), version, player cards count, dealer cards count, result flags, outcome,
+ *                player name (MAX_NAME_LEN), player id, player cash and bet, dealer cash and bet (4 bytes each),
+ *                generator state (RNG_STATE_SIZE), shoe capacity, cards left, in play, discards and cut card
+ *                (4 bytes each), shuffles (8), auto bet, moves counter (4 each), the shoe cards, the player's
+ *                cards, the dealer's cards, then an FNV-1a checksum (4) of all the bytes before it.
+ *              Slotted files: slot k at offset k * SLOT_SIZE: "BJSL", save sequence (8), FNV-1a checksum (4) of these,
+ *                then the encoded snapshot.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<inttypes.h>
+#include "Snapshot.h"
+
+
+#define SNAPSHOT_MAGIC "BJSN"
+#define SNAPSHOT_VERSION 1
+#define FIXED_SIZE (4 + 4 + 5 + MAX_NAME_LEN + 5 * 4 + RNG_STATE_SIZE + 5 * 4 + 8 + 2 * 4) //the cards follow
+#define CHECKSUM_SIZE 4
+#define SLOT_MAGIC "BJSL"
+#define SLOT_HEADER (4 + 8 + CHECKSUM_SIZE)
+#define SLOT_SIZE (SLOT_HEADER + SNAPSHOT_ENCODED_SIZE)
+#define SLOTS 2
+
+enum snapshot_flags { FLAG_BLACK_JACK = 0x01, FLAG_PLAYER_BUST = 0x02, FLAG_DEALER_BUST = 0x04, FLAG_STOOD = 0x08 };
+
+
+static bool snapshot_valid(const Table_snapshot_t* snapshot);
+static void restore_hand(Player_t* player, const uint8_t* cards, uint8_t count);
+static uint32_t checksum(const uint8_t* data, size_t size);
+static uint8_t* put_u32(uint8_t* out, uint32_t value);
+static uint32_t get_u32(const uint8_t** in);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+void table_snapshot(const Table_t* table, Table_snapshot_t* snapshot) {
+	assert_condition(table && snapshot, "Error: function[table_snapshot()]: Null table or snapshot pointer provided");
+
+	const Shoe_t* shoe = table->_deck;
+	const Card_list_t* hands[2] = { &table->_player._cards, &table->_dealer._cards };
+	uint8_t* cards[2] = { snapshot->_player_cards, snapshot->_dealer_cards };
+	uint8_t* counts[2] = { &snapshot->_player_count, &snapshot->_dealer_count };
+
+	assert_condition(shoe->_capacity <= SNAPSHOT_SHOE_SIZE, "Error: function[table_snapshot()]: Shoe larger than a snapshot");
+	snapshot->_player_info = table->_player._info;
+	snapshot->_player_account = table->_player._account;
+	snapshot->_dealer_account = table->_dealer._account;
+	for (int h = 0; h < 2; ++h) {
+		uint8_t count = (uint8_t)(hands[h]->_count < SNAPSHOT_HAND_CARDS ? hands[h]->_count : SNAPSHOT_HAND_CARDS);
+		memcpy(cards[h], card_list_cdata(hands[h]), count);
+		*counts[h] = count;
+	}
+	snapshot->_rng = table->_rng;
+	snapshot->_shoe_capacity = (uint32_t)shoe->_capacity;
+	snapshot->_shoe_count = (uint32_t)shoe->_count;
+	snapshot->_shoe_in_play = (uint32_t)shoe->_in_play;
+	snapshot->_shoe_discards = (uint32_t)shoe->_discards;
+	snapshot->_shoe_cut = (uint32_t)shoe->_cut;
+	snapshot->_shoe_shuffles = shoe->_shuffles;
+	memcpy(snapshot->_shoe, shoe->_cards, shoe->_capacity);
+	snapshot->_auto_bet = table->_auto_bet;
+	snapshot->_moves_counter = table->_moves_counter;
+	snapshot->_outcome = (uint8_t)table->_outcome;
+	snapshot->_black_jack = table->_black_jack;
+	snapshot->_player_bust = table->_player_bust;
+	snapshot->_dealer_bust = table->_dealer_bust;
+	snapshot->_stood = table->_stood;
+}
+
+int table_restore(Table_t* table, const Table_snapshot_t* snapshot) {
+	assert_condition(table && snapshot, "Error: function[table_restore()]: Null table or snapshot pointer provided");
+
+	if (!snapshot_valid(snapshot)) {
+		fprintf(stderr, "Warning: function[table_restore()]: Invalid snapshot\n");
+		return FAIL;
+	}
+
+	if (table->_deck->_capacity != snapshot->_shoe_capacity) { //a shoe of another size: the observer moves to the new one
+		Shoe_t* shoe = create_shoe(snapshot->_shoe_capacity, &table->_rng);
+		set_shoe_observer(shoe, table->_deck->_observer, table->_deck->_observer_ctx);
+		clear_shoe(table->_deck);
+		table->_deck = shoe;
+	}
+	memcpy(table->_deck->_cards, snapshot->_shoe, snapshot->_shoe_capacity);
+	table->_deck->_count = snapshot->_shoe_count;
+	table->_deck->_in_play = snapshot->_shoe_in_play;
+	table->_deck->_discards = snapshot->_shoe_discards;
+	table->_deck->_cut = snapshot->_shoe_cut;
+	table->_deck->_shuffles = snapshot->_shoe_shuffles;
+
+	table->_player._info = snapshot->_player_info;
+	table->_player._account = snapshot->_player_account;
+	table->_dealer._account = snapshot->_dealer_account;
+	restore_hand(&table->_player, snapshot->_player_cards, snapshot->_player_count);
+	restore_hand(&table->_dealer, snapshot->_dealer_cards, snapshot->_dealer_count);
+
+	table->_rng = snapshot->_rng;
+	table->_auto_bet = snapshot->_auto_bet;
+	table->_moves_counter = snapshot->_moves_counter;
+	table->_outcome = (enum round_outcome)snapshot->_outcome;
+	table->_black_jack = snapshot->_black_jack;
+	table->_player_bust = snapshot->_player_bust;
+	table->_dealer_bust = snapshot->_dealer_bust;
+	table->_stood = snapshot->_stood;
+	return SUCCESS;
+}
+
+bool snapshot_in_round(const Table_snapshot_t* snapshot) {
+	assert_condition(snapshot, "Error: function[snapshot_in_round()]: Null snapshot pointer provided");
+	return snapshot->_player_count > 0;
+}
+
+size_t snapshot_encode(const Table_snapshot_t* snapshot, uint8_t* out, size_t size) {
+	assert_condition(snapshot && out, "Error: function[snapshot_encode()]: Null snapshot or out pointer provided");
+
+	size_t total = FIXED_SIZE + snapshot->_shoe_capacity + snapshot->_player_count + snapshot->_dealer_count + CHECKSUM_SIZE;
+	uint8_t* pos = out;
+
+	if (size < total || snapshot->_shoe_capacity > SNAPSHOT_SHOE_SIZE ||
+		snapshot->_player_count > SNAPSHOT_HAND_CARDS || snapshot->_dealer_count > SNAPSHOT_HAND_CARDS)
+		return 0;
+
+	memcpy(pos, SNAPSHOT_MAGIC, 4);
+	pos = put_u32(pos + 4, (uint32_t)total);
+	*pos++ = SNAPSHOT_VERSION;
+	*pos++ = snapshot->_player_count;
+	*pos++ = snapshot->_dealer_count;
+	*pos++ = (snapshot->_black_jack ? FLAG_BLACK_JACK : 0) | (snapshot->_player_bust ? FLAG_PLAYER_BUST : 0) |
+		(snapshot->_dealer_bust ? FLAG_DEALER_BUST : 0) | (snapshot->_stood ? FLAG_STOOD : 0);
+	*pos++ = snapshot->_outcome;
+	memcpy(pos, snapshot->_player_info._name, MAX_NAME_LEN);
+	pos = put_u32(pos + MAX_NAME_LEN, (uint32_t)snapshot->_player_info._id);
+	pos = put_u32(pos, (uint32_t)snapshot->_player_account._cash);
+	pos = put_u32(pos, snapshot->_player_account._bet);
+	pos = put_u32(pos, (uint32_t)snapshot->_dealer_account._cash);
+	pos = put_u32(pos, snapshot->_dealer_account._bet);
+	rng_save(&snapshot->_rng, pos);
+	pos = put_u32(pos + RNG_STATE_SIZE, snapshot->_shoe_capacity);
+	pos = put_u32(pos, snapshot->_shoe_count);
+	pos = put_u32(pos, snapshot->_shoe_in_play);
+	pos = put_u32(pos, snapshot->_shoe_discards);
+	pos = put_u32(pos, snapshot->_shoe_cut);
+	pos = put_u32(pos, (uint32_t)snapshot->_shoe_shuffles);
+	pos = put_u32(pos, (uint32_t)(snapshot->_shoe_shuffles >> 32));
+	pos = put_u32(pos, snapshot->_auto_bet);
+	pos = put_u32(pos, snapshot->_moves_counter);
+	memcpy(pos, snapshot->_shoe, snapshot->_shoe_capacity);
+	pos += snapshot->_shoe_capacity;
+	memcpy(pos, snapshot->_player_cards, snapshot->_player_count);
+	pos += snapshot->_player_count;
+	memcpy(pos, snapshot->_dealer_cards, snapshot->_dealer_count);
+	pos += snapshot->_dealer_count;
+	put_u32(pos, checksum(out, (size_t)(pos - out)));
+	return total;
+}
+
+int snapshot_decode(Table_snapshot_t* snapshot, const uint8_t* in, size_t size) {
+	assert_condition(snapshot && in, "Error: function[snapshot_decode()]: Null snapshot or in pointer provided");
+
+	const uint8_t* pos = in + 4;
+	uint32_t total = 0, value = 0;
+	uint8_t flags;
+
+	if (size < FIXED_SIZE + CHECKSUM_SIZE || memcmp(in, SNAPSHOT_MAGIC, 4))
+		return FAIL;
+	total = get_u32(&pos);
+	if (total > size || total < FIXED_SIZE + CHECKSUM_SIZE || in[8] != SNAPSHOT_VERSION)
+		return FAIL;
+	pos = in + total - CHECKSUM_SIZE;
+	if (get_u32(&pos) != checksum(in, total - CHECKSUM_SIZE))
+		return FAIL; //a torn or damaged snapshot
+
+	memset(snapshot, 0, sizeof(Table_snapshot_t));
+	pos = in + 9;
+	snapshot->_player_count = *pos++;
+	snapshot->_dealer_count = *pos++;
+	flags = *pos++;
+	snapshot->_black_jack = flags & FLAG_BLACK_JACK;
+	snapshot->_player_bust = flags & FLAG_PLAYER_BUST;
+	snapshot->_dealer_bust = flags & FLAG_DEALER_BUST;
+	snapshot->_stood = flags & FLAG_STOOD;
+	snapshot->_outcome = *pos++;
+	memcpy(snapshot->_player_info._name, pos, MAX_NAME_LEN);
+	snapshot->_player_info._name[MAX_NAME_LEN - 1] = '\0';
+	pos += MAX_NAME_LEN;
+	snapshot->_player_info._id = (int32_t)get_u32(&pos);
+	snapshot->_player_account._cash = (int32_t)get_u32(&pos);
+	snapshot->_player_account._bet = get_u32(&pos);
+	snapshot->_dealer_account._cash = (int32_t)get_u32(&pos);
+	snapshot->_dealer_account._bet = get_u32(&pos);
+	if (rng_restore(&snapshot->_rng, pos) != SUCCESS)
+		return FAIL;
+	pos += RNG_STATE_SIZE;
+	snapshot->_shoe_capacity = get_u32(&pos);
+	snapshot->_shoe_count = get_u32(&pos);
+	snapshot->_shoe_in_play = get_u32(&pos);
+	snapshot->_shoe_discards = get_u32(&pos);
+	snapshot->_shoe_cut = get_u32(&pos);
+	value = get_u32(&pos);
+	snapshot->_shoe_shuffles = value | ((uint64_t)get_u32(&pos) << 32);
+	snapshot->_auto_bet = get_u32(&pos);
+	snapshot->_moves_counter = get_u32(&pos);
+
+	if (snapshot->_shoe_capacity > SNAPSHOT_SHOE_SIZE || snapshot->_player_count > SNAPSHOT_HAND_CARDS ||
+		snapshot->_dealer_count > SNAPSHOT_HAND_CARDS ||
+		FIXED_SIZE + snapshot->_shoe_capacity + snapshot->_player_count + snapshot->_dealer_count + CHECKSUM_SIZE != total)
+		return FAIL;
+	memcpy(snapshot->_shoe, pos, snapshot->_shoe_capacity);
+	pos += snapshot->_shoe_capacity;
+	memcpy(snapshot->_player_cards, pos, snapshot->_player_count);
+	pos += snapshot->_player_count;
+	memcpy(snapshot->_dealer_cards, pos, snapshot->_dealer_count);
+	return snapshot_valid(snapshot) ? SUCCESS : FAIL;
+}
+
+int snapshot_save(const char* path, const Table_snapshot_t* snapshot) {
+	assert_condition(path && snapshot, "Error: function[snapshot_save()]: Null path or snapshot pointer provided");
+
+	uint8_t encoded[SNAPSHOT_ENCODED_SIZE];
+	size_t size = snapshot_encode(snapshot, encoded, sizeof(encoded));
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (fd < 0 || !size || write(fd, encoded, size) != (ssize_t)size) {
+		fprintf(stderr, "Warning: function[snapshot_save()]: Cannot write %s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return FAIL;
+	}
+	return close(fd) == 0 ? SUCCESS : FAIL;
+}
+
+int snapshot_load(const char* path, Table_snapshot_t* snapshot) {
+	assert_condition(path && snapshot, "Error: function[snapshot_load()]: Null path or snapshot pointer provided");
+
+	uint8_t encoded[SNAPSHOT_ENCODED_SIZE];
+	int fd = open(path, O_RDONLY);
+	ssize_t size = fd >= 0 ? read(fd, encoded, sizeof(encoded)) : -1;
+	int result = FAIL;
+
+	if (size < 0) {
+		fprintf(stderr, "Warning: function[snapshot_load()]: Cannot read %s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return FAIL;
+	}
+	if (size >= 4 && !memcmp(encoded, SNAPSHOT_MAGIC, 4))
+		result = snapshot_decode(snapshot, encoded, (size_t)size);
+	else
+		result = snapshot_read_slots(fd, snapshot, NULL); //a slotted file (its first slot may be torn)
+	close(fd);
+	if (result != SUCCESS) {
+		fprintf(stderr, "Warning: function[snapshot_load()]: %s is not a valid snapshot\n", path);
+		return FAIL;
+	}
+	return SUCCESS;
+}
+
+int snapshot_write_slot(int fd, const Table_snapshot_t* snapshot, uint64_t sequence) {
+	assert_condition(snapshot, "Error: function[snapshot_write_slot()]: Null snapshot pointer provided");
+
+	uint8_t slot[SLOT_SIZE];
+	size_t size = snapshot_encode(snapshot, slot + SLOT_HEADER, SNAPSHOT_ENCODED_SIZE);
+
+	memcpy(slot, SLOT_MAGIC, 4);
+	uint8_t* pos = put_u32(put_u32(slot + 4, (uint32_t)sequence), (uint32_t)(sequence >> 32));
+	put_u32(pos, checksum(slot, SLOT_HEADER - CHECKSUM_SIZE));
+	size += SLOT_HEADER;
+	if (size == SLOT_HEADER || pwrite(fd, slot, size, (off_t)(sequence % SLOTS) * SLOT_SIZE) != (ssize_t)size) {
+		fprintf(stderr, "Warning: function[snapshot_write_slot()]: Failed writing save %" PRIu64 ": %s\n", sequence, strerror(errno));
+		return FAIL;
+	}
+	return SUCCESS;
+}
+
+int snapshot_read_slots(int fd, Table_snapshot_t* snapshot, uint64_t* sequence) {
+	assert_condition(snapshot, "Error: function[snapshot_read_slots()]: Null snapshot pointer provided");
+
+	uint8_t slot[SLOT_SIZE];
+	Table_snapshot_t decoded;
+	uint64_t newest = 0;
+	bool found = false;
+
+	for (int s = 0; s < SLOTS; ++s) {
+		ssize_t size = pread(fd, slot, sizeof(slot), (off_t)s * SLOT_SIZE);
+		const uint8_t* pos = slot + 4;
+
+		if (size < SLOT_HEADER || memcmp(slot, SLOT_MAGIC, 4))
+			continue; //never written
+		uint64_t saved = get_u32(&pos);
+		saved |= (uint64_t)get_u32(&pos) << 32;
+		if (get_u32(&pos) != checksum(slot, SLOT_HEADER - CHECKSUM_SIZE) || saved % SLOTS != (uint64_t)s || (found && saved < newest))
+			continue;
+		if (snapshot_decode(&decoded, slot + SLOT_HEADER, (size_t)size - SLOT_HEADER) != SUCCESS)
+			continue; //torn by a crash in the middle of its save
+		memcpy(snapshot, &decoded, sizeof(Table_snapshot_t));
+		newest = saved;
+		found = true;
+	}
+	if (found && sequence) {
+		*sequence = newest;
+	}
+	return found ? SUCCESS : FAIL;
+}
+
+//The shoe layout adds up, the hands are the cards in play, and every card code is valid
+static bool snapshot_valid(const Table_snapshot_t* snapshot) {
+	const uint64_t* rng_state = snapshot->_rng._s;
+
+	if (!snapshot->_shoe_capacity || snapshot->_shoe_capacity > SNAPSHOT_SHOE_SIZE || snapshot->_shoe_capacity % CARDS_COUNT ||
+		(uint64_t)snapshot->_shoe_count + snapshot->_shoe_in_play + snapshot->_shoe_discards != snapshot->_shoe_capacity ||
+		snapshot->_shoe_cut > snapshot->_shoe_capacity || snapshot->_player_count > SNAPSHOT_HAND_CARDS ||
+		snapshot->_dealer_count > SNAPSHOT_HAND_CARDS ||
+		(uint32_t)snapshot->_player_count + snapshot->_dealer_count != snapshot->_shoe_in_play ||
+		snapshot->_outcome > OUTCOME_TIE || !(rng_state[0] | rng_state[1] | rng_state[2] | rng_state[3]))
+		return false;
+	for (uint32_t i = 0; i < snapshot->_shoe_capacity; ++i) {
+		if (snapshot->_shoe[i] >= CARDS_COUNT)
+			return false;
+	}
+	for (uint8_t i = 0; i < snapshot->_player_count; ++i) {
+		if (snapshot->_player_cards[i] >= CARDS_COUNT)
+			return false;
+	}
+	for (uint8_t i = 0; i < snapshot->_dealer_count; ++i) {
+		if (snapshot->_dealer_cards[i] >= CARDS_COUNT)
+			return false;
+	}
+	return true;
+}
+
+//Replaces the hand's cards
+static void restore_hand(Player_t* player, const uint8_t* cards, uint8_t count) {
+	card_list_reset(&player->_cards);
+	hand_reset(&player->_hand);
+	for (uint8_t i = 0; i < count; ++i) {
+		card_list_add_to_back(&player->_cards, cards[i]);
+		hand_add_card(&player->_hand, cards[i]);
+	}
+}
+
+//FNV-1a
+static uint32_t checksum(const uint8_t* data, size_t size) {
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static uint8_t* put_u32(uint8_t* out, uint32_t value) {
+	out[0] = (uint8_t)value;
+	out[1] = (uint8_t)(value >> 8);
+	out[2] = (uint8_t)(value >> 16);
+	out[3] = (uint8_t)(value >> 24);
+	return out + 4;
+}
+
+static uint32_t get_u32(const uint8_t** in) {
+	const uint8_t* p = *in;
+	*in += 4;
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the table snapshots: the whole state of a game table, between rounds or in the middle of
+ *              one (accounts, hands, the exact shoe order, the random generator and the round's progress).
+ *              A snapshot is a flat struct: taking, copying and restoring one costs a few hundred bytes of copying,
+ *              so a single state can be forked into many tables. Encoded snapshots (a compact, checksummed byte
+ *              string) survive a crash: the game server keeps one per session, and simulations may start from them.
+ *              The table's own settings are not part of the state: decision source, output and logs stay as they are.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include "Black_Jack.h"
+#include "Cards.h"
+
+#define SNAPSHOT_MAX_DECKS 8
+#define SNAPSHOT_SHOE_SIZE (SNAPSHOT_MAX_DECKS * CARDS_COUNT)
+#define SNAPSHOT_HAND_CARDS 32
+#define SNAPSHOT_ENCODED_SIZE 1024 //room for any encoded snapshot
+
+typedef struct Table_snapshot {
+	Person_t _player_info;
+	Account_t _player_account;
+	Account_t _dealer_account;
+	uint8_t _player_count;
+	uint8_t _dealer_count;
+	uint8_t _player_cards[SNAPSHOT_HAND_CARDS];   //suit_rank encoding, in draw order
+	uint8_t _dealer_cards[SNAPSHOT_HAND_CARDS];
+	Rng_t _rng;
+	uint32_t _shoe_capacity;
+	uint32_t _shoe_count;
+	uint32_t _shoe_in_play;
+	uint32_t _shoe_discards;
+	uint32_t _shoe_cut;
+	uint64_t _shoe_shuffles;
+	uint8_t _shoe[SNAPSHOT_SHOE_SIZE];            //_shoe_capacity cards (see Shoe_t layout)
+	uint32_t _auto_bet;
+	uint32_t _moves_counter;
+	uint8_t _outcome;                             //last round results
+	bool _black_jack;
+	bool _player_bust;
+	bool _dealer_bust;
+	bool _stood;
+}Table_snapshot_t;
+
+//Takes the table's state (between rounds, or while the player's turn is pending)
+void table_snapshot(const Table_t* table, Table_snapshot_t* snapshot);
+
+//Puts the table (initialized by table_init()) in the snapshot's state. A shoe observer stays attached but must
+//be attached again to see the restored shoe (e.g. count_attach()). A round in play goes on with round_turn().
+//Returns: FAIL for an invalid snapshot (the table is left unchanged), otherwise SUCCESS.
+int table_restore(Table_t* table, const Table_snapshot_t* snapshot);
+
+//true when the snapshot was taken in the middle of a round
+bool snapshot_in_round(const Table_snapshot_t* snapshot);
+
+//Encodes the snapshot into 'out' (SNAPSHOT_ENCODED_SIZE bytes are always enough).
+//Returns: the encoded size, 0 if 'size' is too small.
+size_t snapshot_encode(const Table_snapshot_t* snapshot, uint8_t* out, size_t size);
+
+//Decodes an encoded snapshot (bytes past its end are ignored).
+//Returns: FAIL for a truncated or corrupt snapshot, otherwise SUCCESS.
+int snapshot_decode(Table_snapshot_t* snapshot, const uint8_t* in, size_t size);
+
+//Encoded snapshot files. Returns: FAIL in case of fail, otherwise SUCCESS.
+int snapshot_save(const char* path, const Table_snapshot_t* snapshot);
+int snapshot_load(const char* path, Table_snapshot_t* snapshot);
+
+//Slotted snapshot files (the game server's sessions): two slots written in turns, each holding a save's sequence
+//number and its encoded snapshot. A save (a single write) never overwrites the newest whole snapshot, so a crash in the
+//middle of one leaves the previous one. snapshot_load() reads both plain and slotted files.
+//snapshot_write_slot() writes save 'sequence' to slot sequence % 2 of the open file.
+//snapshot_read_slots() loads the valid slot of the higher sequence ('sequence', optional, is set to it).
+//Returns: FAIL in case of fail (no valid slot), otherwise SUCCESS.
+int snapshot_write_slot(int fd, const Table_snapshot_t* snapshot, uint64_t sequence);
+int snapshot_read_slots(int fd, Table_snapshot_t* snapshot, uint64_t* sequence);
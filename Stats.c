@@ -0,0 +1,242 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the hot path instrumentation.
+ *              A thread's block is allocated on its first count and registered once. When the thread ends, the
+ *              block (and its counts) stays registered and is handed to the next new thread, so the blocks do not
+ *              grow with the threads started over time, only with the threads running at once.
+ *              Phases are timed by CLOCK_MONOTONIC on entry and exit: two clock reads per phase.
+ * Language:  C
+*/
+
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include "Stats.h"
+
+#define STATS_MAX_DEPTH 8 //nested phases
+
+
+//A thread's block: its counts, and the phases it is in (innermost last)
+typedef struct Stats_block {
+	Stats_t _stats;
+	struct Stats_block* _next; //all the registered blocks
+	bool _free;                //its thread ended: the block is handed to the next new thread
+	size_t _depth;
+	struct {
+		enum stats_phase _phase;
+		uint64_t _exclusive_ns; //time spent in the phase itself, not in its nested phases
+		uint64_t _resumed_ns;   //when the phase last entered or got back from a nested phase
+	}_frames[STATS_MAX_DEPTH];
+}Stats_block_t;
+
+static const char* const counter_names[STATS_COUNTERS] = { "rounds", "cards_drawn", "shuffles", "rng_calls", "list_allocs" };
+static const char* const phase_names[STATS_PHASES] = { "bet", "deal", "black_jack", "hit_stand", "dealer_draw", "reset" };
+
+static Stats_block_t* blocks = NULL;
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef BJ_STATS
+__thread Stats_t* stats_local = NULL;
+static pthread_key_t thread_end_key;
+static pthread_once_t thread_end_once = PTHREAD_ONCE_INIT;
+#endif
+
+
+static uint64_t stats_load(const uint64_t* counter);
+static void assert_condition(bool isValid, const char* errorMsg);
+
+
+#ifdef BJ_STATS
+static uint64_t now_ns(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+//the block's thread ended
+static void stats_release(void* block) {
+	pthread_mutex_lock(&blocks_lock);
+	((Stats_block_t*)block)->_free = true;
+	pthread_mutex_unlock(&blocks_lock);
+}
+
+static void stats_key_create(void) {
+	pthread_key_create(&thread_end_key, stats_release);
+}
+
+Stats_t* stats_register(void) {
+	Stats_block_t* block = NULL;
+
+	pthread_once(&thread_end_once, stats_key_create);
+	pthread_mutex_lock(&blocks_lock);
+	for (block = blocks; block && !block->_free; block = block->_next);
+	if (block) {
+		block->_free = false;
+		block->_depth = 0;
+	}
+	else {
+		block = (Stats_block_t*)calloc(1, sizeof(Stats_block_t));
+		assert_condition(block, "Error: function[stats_register()]: Failed allocating memory for stats block");
+		block->_next = blocks;
+		blocks = block;
+	}
+	pthread_mutex_unlock(&blocks_lock);
+
+	pthread_setspecific(thread_end_key, block);
+	stats_local = &block->_stats; //_stats is the block's first member
+	return stats_local;
+}
+
+void stats_phase_enter(enum stats_phase phase) {
+	Stats_block_t* block = (Stats_block_t*)stats_thread();
+	uint64_t now = now_ns();
+
+	if (block->_depth) { //pausing the outer phase
+		block->_frames[block->_depth - 1]._exclusive_ns += now - block->_frames[block->_depth - 1]._resumed_ns;
+	}
+	if (block->_depth < STATS_MAX_DEPTH) {
+		block->_frames[block->_depth]._phase = phase;
+		block->_frames[block->_depth]._exclusive_ns = 0;
+		block->_frames[block->_depth]._resumed_ns = now;
+	}
+	block->_depth++;
+}
+
+void stats_phase_exit(void) {
+	Stats_block_t* block = (Stats_block_t*)stats_thread();
+	uint64_t now = now_ns();
+
+	if (!block->_depth)
+		return;
+	if (--block->_depth < STATS_MAX_DEPTH) {
+		Stats_histogram_t* histogram = &block->_stats._phases[block->_frames[block->_depth]._phase];
+		uint64_t ns = block->_frames[block->_depth]._exclusive_ns + (now - block->_frames[block->_depth]._resumed_ns);
+		size_t bucket = ns ? 64 - __builtin_clzll(ns) : 0;
+
+		stats_add(&histogram->_calls, 1);
+		stats_add(&histogram->_total_ns, ns);
+		if (ns > histogram->_max_ns)
+			__atomic_store_n(&histogram->_max_ns, ns, __ATOMIC_RELAXED);
+		stats_add(&histogram->_buckets[bucket < STATS_BUCKETS ? bucket : STATS_BUCKETS - 1], 1);
+	}
+	if (block->_depth && block->_depth <= STATS_MAX_DEPTH) { //resuming the outer phase
+		block->_frames[block->_depth - 1]._resumed_ns = now;
+	}
+}
+#endif
+
+bool stats_enabled(void) {
+#ifdef BJ_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void stats_collect(Stats_t* stats) {
+	assert_condition(stats, "Error: function[stats_collect()]: Argument Stats_t* is NULL");
+
+	memset(stats, 0, sizeof(Stats_t));
+	pthread_mutex_lock(&blocks_lock);
+	for (Stats_block_t* block = blocks; block; block = block->_next) {
+		for (int c = 0; c < STATS_COUNTERS; ++c) {
+			stats->_counters[c] += stats_load(&block->_stats._counters[c]);
+		}
+		for (int p = 0; p < STATS_PHASES; ++p) {
+			const Stats_histogram_t* from = &block->_stats._phases[p];
+			Stats_histogram_t* to = &stats->_phases[p];
+			uint64_t max_ns = stats_load(&from->_max_ns);
+
+			to->_calls += stats_load(&from->_calls);
+			to->_total_ns += stats_load(&from->_total_ns);
+			to->_max_ns = max_ns > to->_max_ns ? max_ns : to->_max_ns;
+			for (int b = 0; b < STATS_BUCKETS; ++b) {
+				to->_buckets[b] += stats_load(&from->_buckets[b]);
+			}
+		}
+	}
+	pthread_mutex_unlock(&blocks_lock);
+}
+
+uint64_t stats_quantile_ns(const Stats_histogram_t* histogram, double quantile) {
+	assert_condition(histogram, "Error: function[stats_quantile_ns()]: Argument Stats_histogram_t* is NULL");
+
+	uint64_t calls = 0;
+	uint64_t rank = (uint64_t)(quantile * histogram->_calls);
+
+	for (int b = 0; b < STATS_BUCKETS; ++b) {
+		calls += histogram->_buckets[b];
+		if (calls > rank || (calls && calls == histogram->_calls)) {
+			uint64_t upper = b ? 1ULL << b : 0;
+			return upper < histogram->_max_ns ? upper : histogram->_max_ns;
+		}
+	}
+	return histogram->_max_ns;
+}
+
+void stats_dump(FILE* out, const Stats_t* stats, enum stats_format format) {
+	assert_condition(out && stats, "Error: function[stats_dump()]: Null out or stats pointer provided");
+
+	if (format == STATS_JSON) {
+		fprintf(out, "{\"enabled\":%s,\"counters\":{", stats_enabled() ? "true" : "false");
+		for (int c = 0; c < STATS_COUNTERS; ++c) {
+			fprintf(out, "%s\"%s\":%llu", c ? "," : "", counter_names[c], (unsigned long long)stats->_counters[c]);
+		}
+		fprintf(out, "},\"phases\":{");
+		for (int p = 0; p < STATS_PHASES; ++p) {
+			const Stats_histogram_t* h = &stats->_phases[p];
+			fprintf(out, "%s\"%s\":{\"calls\":%llu,\"total_ns\":%llu,\"max_ns\":%llu,\"p50_ns\":%llu,\"p99_ns\":%llu,\"buckets\":[",
+				p ? "," : "", phase_names[p], (unsigned long long)h->_calls, (unsigned long long)h->_total_ns,
+				(unsigned long long)h->_max_ns, (unsigned long long)stats_quantile_ns(h, 0.5), (unsigned long long)stats_quantile_ns(h, 0.99));
+			for (int b = 0; b < STATS_BUCKETS; ++b) {
+				fprintf(out, "%s%llu", b ? "," : "", (unsigned long long)h->_buckets[b]);
+			}
+			fprintf(out, "]}");
+		}
+		fprintf(out, "}}\n");
+		return;
+	}
+
+	uint64_t rounds = stats->_counters[STATS_ROUNDS];
+	uint64_t total_ns = 0;
+
+	if (!stats_enabled()) {
+		fprintf(out, "stats: not compiled in (build with -DBJ_STATS)\n");
+		return;
+	}
+	for (int c = 0; c < STATS_COUNTERS; ++c) {
+		fprintf(out, "%-14s %llu\n", counter_names[c], (unsigned long long)stats->_counters[c]);
+	}
+	for (int p = 0; p < STATS_PHASES; ++p) {
+		total_ns += stats->_phases[p]._total_ns;
+	}
+	fprintf(out, "%-14s %12s %12s %9s %9s %9s %10s %6s\n", "phase", "calls", "total ms", "mean ns", "p50 ns", "p99 ns", "max ns", "time");
+	for (int p = 0; p < STATS_PHASES; ++p) {
+		const Stats_histogram_t* h = &stats->_phases[p];
+		fprintf(out, "%-14s %12llu %12.3f %9.1f %9llu %9llu %10llu %5.1f%%\n", phase_names[p], (unsigned long long)h->_calls,
+			h->_total_ns / 1e6, h->_calls ? (double)h->_total_ns / h->_calls : 0.0, (unsigned long long)stats_quantile_ns(h, 0.5),
+			(unsigned long long)stats_quantile_ns(h, 0.99), (unsigned long long)h->_max_ns, total_ns ? 100.0 * h->_total_ns / total_ns : 0.0);
+	}
+	fprintf(out, "%-14s %.1f\n", "ns/round", rounds ? (double)total_ns / rounds : 0.0);
+}
+
+const char* stats_counter_name(enum stats_counter counter) {
+	return counter < STATS_COUNTERS ? counter_names[counter] : "?";
+}
+
+const char* stats_phase_name(enum stats_phase phase) {
+	return phase < STATS_PHASES ? phase_names[phase] : "?";
+}
+
+static uint64_t stats_load(const uint64_t* counter) {
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void assert_condition(bool isValid, const char* errorMsg) {
+	if (!isValid) {
+		fprintf(stderr, "%s", errorMsg);
+		exit(EXIT_FAILURE);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the game's hot path instrumentation: counters (rounds, cards drawn, reshuffles, random
+ *              numbers, list heap allocations) and latency histograms of every game phase, read at runtime as a stats
+ *              dump (text or JSON). Compiled in with -DBJ_STATS only: otherwise the STATS_ macros expand to the bare
+ *              calls, and stats_collect() returns zeros.
+ *              Every thread counts into its own block (no locks, no shared cache lines). stats_collect() sums them.
+ * Language:  C
+*/
+#include<stdio.h>
+#include<stdint.h>
+#include<stdbool.h>
+
+#define STATS_BUCKETS 40 //phase latencies: bucket 0 is 0 ns, bucket b holds [2^(b-1), 2^b) ns
+
+enum stats_counter { STATS_ROUNDS, STATS_CARDS_DRAWN, STATS_SHUFFLES, STATS_RNG_CALLS, STATS_LIST_ALLOCS, STATS_COUNTERS };
+
+//Game phases (see "Black Jack Game Phases- Implementation description.txt")
+enum stats_phase { PHASE_BET, PHASE_DEAL, PHASE_BLACK_JACK, PHASE_HIT_STAND, PHASE_DEALER_DRAW, PHASE_RESET, STATS_PHASES };
+
+enum stats_format { STATS_TEXT, STATS_JSON };
+
+//Latencies of a phase. Times are exclusive: a phase run inside another one (the dealer draw inside the hit or
+//stand, the reset inside both) is not counted in the outer phase's time, so the phases add up to the round.
+typedef struct Stats_histogram {
+	uint64_t _calls;
+	uint64_t _total_ns;
+	uint64_t _max_ns;
+	uint64_t _buckets[STATS_BUCKETS];
+}Stats_histogram_t;
+
+typedef struct Stats {
+	uint64_t _counters[STATS_COUNTERS];
+	Stats_histogram_t _phases[STATS_PHASES];
+}Stats_t;
+
+
+#ifdef BJ_STATS
+extern __thread Stats_t* stats_local; //the calling thread's block (NULL until its first count)
+
+//Registers the calling thread's block
+Stats_t* stats_register(void);
+
+static inline Stats_t* stats_thread(void) {
+	return stats_local ? stats_local : stats_register();
+}
+
+//Only the owner thread writes its block: a plain add, stored atomically for stats_collect() readers
+static inline void stats_add(uint64_t* counter, uint64_t n) {
+	__atomic_store_n(counter, *counter + n, __ATOMIC_RELAXED);
+}
+
+void stats_phase_enter(enum stats_phase phase);
+void stats_phase_exit(void);
+
+#define STATS_COUNT(counter, n) stats_add(&stats_thread()->_counters[counter], (n))
+//Times the call as the given phase, and evaluates to its result
+#define STATS_TIMED(phase, call) __extension__({ stats_phase_enter(phase); __typeof__(call) stats_result_ = (call); stats_phase_exit(); stats_result_; })
+#else
+#define STATS_COUNT(counter, n) ((void)0)
+#define STATS_TIMED(phase, call) (call)
+#endif
+
+//true when built with -DBJ_STATS
+bool stats_enabled(void);
+
+//Sums the blocks of all the threads (ended threads included) into 'stats'
+void stats_collect(Stats_t* stats);
+
+//Latency (ns) under which 'quantile' (0-1) of the phase calls ran: the upper bound of its histogram bucket
+uint64_t stats_quantile_ns(const Stats_histogram_t* histogram, double quantile);
+
+//Writes the stats as a table (STATS_TEXT) or as a single line JSON object (STATS_JSON)
+void stats_dump(FILE* out, const Stats_t* stats, enum stats_format format);
+
+const char* stats_counter_name(enum stats_counter counter);
+const char* stats_phase_name(enum stats_phase phase);
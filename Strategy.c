@@ -0,0 +1,287 @@
+/*
+ * Author: Noga Avraham
+ * Description: .cpp Implementation of the basic strategy generator, chart file and decision callback.
+ *              For a dealer up card, the dealer's result depends on the value the player stands on
+ *              (the dealer draws until it beats it), so the stand EV is computed for every stand value (4-20)
+ *              by a memoized recursion over the dealer's hands. The player's hands are then solved from the
+ *              highest hard sum down: EV = max(stand EV, sum over the next card of the EV after the hit).
+ *              Every up card column is independent: the columns are split between threads.
+ *              Link with -pthread.
+ * Language:  C
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<pthread.h>
+#include<unistd.h>//sysconf()
+#include "Strategy.h"
+#include "Cards.h"
+#include "Rules.h"
+
+
+#define MIN_VALUE 4         //lowest hand value (2 + 2)
+#define MAX_HARD 32         //hard sums reachable before a hand is over, with room
+#define SOFT_MIN 12         //lowest soft value (Ace + Ace)
+#define CHART_LINE_LEN 128
+
+//A column of the strategy: the dealer's up card and what is computed for it
+typedef struct Strategy_column {
+	uint8_t _up;                      //up card value 1-10
+	double _p[STRATEGY_UP_CARDS + 1]; //next card value probabilities, [1] Ace ... [10] ten cards
+	double _stand[BLACK_JACK];        //EV of standing on value v (MIN_VALUE-20)
+	double _ev[MAX_HARD][2];          //EV of the player's hand [hard sum][has an Ace], playing the strategy
+	uint32_t _hit[2];                 //decisions (see Strategy_t)
+}Strategy_column_t;
+
+typedef struct Strategy_worker {
+	pthread_t _thread;
+	Strategy_column_t* _columns;
+	unsigned int _first;
+	unsigned int _step;
+}Strategy_worker_t;
+
+
+static void* solve_columns(void* arg);
+static void solve_column(Strategy_column_t* column);
+static double dealer_ev(const Strategy_column_t* column, int stand_value, int hard, bool ace, double memo[MAX_HARD][2], bool known[MAX_HARD][2]);
+static void shoe_probabilities(uint8_t decks, uint8_t up, double* p);
+
+
+static inline int hand_value(int hard, bool ace) {
+	return (ace && hard + 10 <= BLACK_JACK) ? hard + 10 : hard;
+}
+
+int strategy_generate(Strategy_t* strategy, uint8_t decks, unsigned int threads, double* ev) {
+	Strategy_column_t columns[STRATEGY_UP_CARDS];
+	Strategy_worker_t workers[STRATEGY_UP_CARDS];
+	double p_full[STRATEGY_UP_CARDS + 1];
+
+	if (!strategy || decks > STRATEGY_MAX_DECKS) {
+		fprintf(stderr, "Warning: function[strategy_generate()]: Null strategy or 'decks' = %u (0-%d)\n", decks, STRATEGY_MAX_DECKS);
+		return FAIL;
+	}
+	if (!threads) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cores > 0 ? (unsigned int)cores : 1;
+	}
+	if (threads > STRATEGY_UP_CARDS) {
+		threads = STRATEGY_UP_CARDS;
+	}
+
+	for (uint8_t up = 1; up <= STRATEGY_UP_CARDS; ++up) {
+		memset(&columns[up - 1], 0, sizeof(Strategy_column_t));
+		columns[up - 1]._up = up;
+		shoe_probabilities(decks, up, columns[up - 1]._p);
+	}
+	for (unsigned int i = 0; i < threads; ++i) {
+		workers[i]._columns = columns;
+		workers[i]._first = i;
+		workers[i]._step = threads;
+	}
+	for (unsigned int i = 1; i < threads; ++i) {
+		if (pthread_create(&workers[i]._thread, NULL, solve_columns, &workers[i]) != 0) {
+			solve_columns(&workers[i]); //running it inline
+			workers[i]._thread = 0;
+		}
+	}
+	solve_columns(&workers[0]);
+	for (unsigned int i = 1; i < threads; ++i) {
+		if (workers[i]._thread)
+			pthread_join(workers[i]._thread, NULL);
+	}
+
+	for (uint8_t up = 1; up <= STRATEGY_UP_CARDS; ++up) {
+		strategy->_hit[0][up - 1] = columns[up - 1]._hit[0];
+		strategy->_hit[1][up - 1] = columns[up - 1]._hit[1];
+	}
+
+	//the round's EV: dealer up card, then the player's two cards (a natural pays at once)
+	if (ev) {
+		*ev = 0;
+		shoe_probabilities(decks, 0, p_full);
+		for (int up = 1; up <= STRATEGY_UP_CARDS; ++up) {
+			const Strategy_column_t* column = &columns[up - 1];
+
+			for (int c1 = 1; c1 <= STRATEGY_UP_CARDS; ++c1) {
+				for (int c2 = 1; c2 <= STRATEGY_UP_CARDS; ++c2) {
+					int hard = c1 + c2;
+					bool ace = (c1 == 1 || c2 == 1);
+					double hand = hand_value(hard, ace) == BLACK_JACK ? HOUSE_NATURAL_PAYS : column->_ev[hard][ace];
+					*ev += p_full[up] * column->_p[c1] * column->_p[c2] * hand;
+				}
+			}
+		}
+	}
+	return SUCCESS;
+}
+
+static void* solve_columns(void* arg) {
+	Strategy_worker_t* worker = (Strategy_worker_t*)arg;
+
+	for (unsigned int i = worker->_first; i < STRATEGY_UP_CARDS; i += worker->_step) {
+		solve_column(&worker->_columns[i]);
+	}
+	return NULL;
+}
+
+static void solve_column(Strategy_column_t* column) {
+	double memo[MAX_HARD][2];
+	bool known[MAX_HARD][2];
+
+	//standing: the dealer's hole card, then its draws
+	for (int v = MIN_VALUE; v < BLACK_JACK; ++v) {
+		memset(known, 0, sizeof(known));
+		column->_stand[v] = 0;
+		for (int hole = 1; hole <= STRATEGY_UP_CARDS; ++hole) {
+			column->_stand[v] += column->_p[hole] *
+				dealer_ev(column, v, column->_up + hole, column->_up == 1 || hole == 1, memo, known);
+		}
+	}
+
+	//the player's hands, from the highest hard sum down: a hit only leads to higher hard sums
+	for (int hard = BLACK_JACK; hard >= 2; --hard) {
+		for (int ace = 0; ace <= 1; ++ace) {
+			int value = hand_value(hard, ace);
+			double hit = 0;
+
+			if (value >= BLACK_JACK) { //not a decision: the hand is over
+				column->_ev[hard][ace] = value == BLACK_JACK ? 1.0 : -1.0;
+				continue;
+			}
+			for (int c = 1; c <= STRATEGY_UP_CARDS; ++c) {
+				int next_hard = hard + c;
+				bool next_ace = ace || c == 1;
+				int next = hand_value(next_hard, next_ace);
+
+				hit += column->_p[c] * (next > BLACK_JACK ? -1.0 : next == BLACK_JACK ? 1.0 : column->_ev[next_hard][next_ace]);
+			}
+			double stand = value >= MIN_VALUE ? column->_stand[value] : -1.0;
+			bool soft = value != hard;
+
+			column->_ev[hard][ace] = hit > stand ? hit : stand;
+			if (hit > stand) {
+				column->_hit[soft] |= 1u << value;
+			}
+		}
+	}
+}
+
+//EV of the player standing on 'stand_value' with the dealer holding (hard, ace). See dealer_draw().
+static double dealer_ev(const Strategy_column_t* column, int stand_value, int hard, bool ace, double memo[MAX_HARD][2], bool known[MAX_HARD][2]) {
+	int value = hand_value(hard, ace);
+
+	if (value > BLACK_JACK)
+		return HOUSE_DEALER_BUST_PAYS;
+	if (value > stand_value || value >= HOUSE_DEALER_STANDS) { //the dealer stops
+		if (value == BLACK_JACK || value > stand_value)
+			return -1.0;
+		return value == stand_value ? 0.0 : 1.0;
+	}
+	if (known[hard][ace])
+		return memo[hard][ace];
+
+	double ev = 0;
+	for (int c = 1; c <= STRATEGY_UP_CARDS; ++c) {
+		ev += column->_p[c] * dealer_ev(column, stand_value, hard + c, ace || c == 1, memo, known);
+	}
+	known[hard][ace] = true;
+	memo[hard][ace] = ev;
+	return ev;
+}
+
+//Next card value probabilities of a 'decks' decks shoe less the 'up' card (0: none). decks 0: infinite deck.
+static void shoe_probabilities(uint8_t decks, uint8_t up, double* p) {
+	double count[STRATEGY_UP_CARDS + 1];
+	double total = 0;
+
+	for (int c = 1; c <= STRATEGY_UP_CARDS; ++c) {
+		count[c] = (c == 10 ? 16.0 : 4.0) * (decks ? decks : 1);
+	}
+	if (decks && up) {
+		count[up] -= 1;
+	}
+	for (int c = 1; c <= STRATEGY_UP_CARDS; ++c) {
+		total += count[c];
+	}
+	p[0] = 0;
+	for (int c = 1; c <= STRATEGY_UP_CARDS; ++c) {
+		p[c] = count[c] / total;
+	}
+}
+
+int strategy_save(const Strategy_t* strategy, const char* path) {
+	FILE* file = path ? fopen(path, "w") : NULL;
+
+	if (!strategy || !file) {
+		fprintf(stderr, "Warning: function[strategy_save()]: Cannot write '%s'\n", path ? path : "(null)");
+		return FAIL;
+	}
+	fprintf(file, "# Black Jack strategy. H- hit, S- stand. Columns: dealer up card A 2 3 4 5 6 7 8 9 10\n");
+	for (int soft = 0; soft <= 1; ++soft) {
+		for (int v = soft ? SOFT_MIN : MIN_VALUE; v < BLACK_JACK; ++v) {
+			fprintf(file, "%s %2d ", soft ? "soft" : "hard", v);
+			for (int up = 0; up < STRATEGY_UP_CARDS; ++up) {
+				fputc((strategy->_hit[soft][up] >> v) & 1 ? 'H' : 'S', file);
+			}
+			fputc('\n', file);
+		}
+	}
+	return fclose(file) == 0 ? SUCCESS : FAIL;
+}
+
+int strategy_load(Strategy_t* strategy, const char* path) {
+	FILE* file = path ? fopen(path, "r") : NULL;
+	char line[CHART_LINE_LEN];
+	char kind[8], decisions[CHART_LINE_LEN];
+	int value = 0;
+	unsigned int rows = 0;
+
+	if (!strategy || !file) {
+		fprintf(stderr, "Warning: function[strategy_load()]: Cannot read '%s'\n", path ? path : "(null)");
+		return FAIL;
+	}
+	memset(strategy, 0, sizeof(Strategy_t));
+
+	while (fgets(line, sizeof(line), file)) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+
+		int soft = -1;
+		if (sscanf(line, "%7s %d %127s", kind, &value, decisions) == 3) {
+			soft = !strcmp(kind, "soft") ? 1 : !strcmp(kind, "hard") ? 0 : -1;
+		}
+		if (soft < 0 || value < (soft ? SOFT_MIN : MIN_VALUE) || value >= BLACK_JACK || strlen(decisions) != STRATEGY_UP_CARDS ||
+			strspn(decisions, "HS") != STRATEGY_UP_CARDS) {
+			fprintf(stderr, "Warning: function[strategy_load()]: Invalid line in '%s': %s", path, line);
+			fclose(file);
+			return FAIL;
+		}
+		for (int up = 0; up < STRATEGY_UP_CARDS; ++up) {
+			if (decisions[up] == 'H')
+				strategy->_hit[soft][up] |= 1u << value;
+		}
+		rows++;
+	}
+	fclose(file);
+	if (rows != (BLACK_JACK - MIN_VALUE) + (BLACK_JACK - SOFT_MIN)) {
+		fprintf(stderr, "Warning: function[strategy_load()]: '%s' has %u rows, expected %d\n", path, rows,
+			(BLACK_JACK - MIN_VALUE) + (BLACK_JACK - SOFT_MIN));
+		return FAIL;
+	}
+	return SUCCESS;
+}
+
+bool strategy_hit(const Strategy_t* strategy, uint8_t value, bool soft, uint8_t up_card) {
+	if (value >= BLACK_JACK)
+		return false;
+	return (strategy->_hit[soft][card_value[up_card] - 1] >> value) & 1;
+}
+
+char strategy_decide(Player_t* player, Player_t* dealer, void* ctx) {
+	//the dealer's up card is the one before last (see dealer_up_card())
+	uint8_t* up_card = card_list_find(&dealer->_cards, dealer->_cards._count - 1);
+	uint8_t up = up_card ? *up_card : card_codes[0];
+
+	return strategy_hit((const Strategy_t*)ctx, player->_hand._value, player->_hand._soft, up) ? 'H' : 'S';
+}
@@ -0,0 +1,39 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header of the basic strategy of this game's rules: the best Hit or Stand decision of every
+ *              (player hand value, soft/hard, dealer up card), computed by dynamic programming under the exact
+ *              dealer_draw() rule and win_lose_transactions() payouts of Black_Jack.c:
+ *                  - a natural pays 1.5, reaching 21 on a hit wins 1 at once (the dealer does not play)
+ *                  - the dealer draws while its value is <= the player's and < 17 (Aces as 11 when possible)
+ *                  - dealer bust pays 2, dealer 21 wins, equal values push, otherwise the higher value wins 1
+ *              Cards are drawn with replacement from the shoe composition less the up card.
+ * Language:  C
+*/
+#include<stdint.h>
+#include<stdbool.h>
+#include "Black_Jack.h"
+
+#define STRATEGY_UP_CARDS 10     //dealer up card values: Ace(1), 2, ..., 10
+#define STRATEGY_MAX_DECKS 8
+
+//Hit or Stand decisions, 80 bytes
+typedef struct Strategy {
+	uint32_t _hit[2][STRATEGY_UP_CARDS]; //[soft][up card value - 1]: bit v set- hit on hand value v
+}Strategy_t;
+
+//Computes the strategy for a shoe of 'decks' decks (0: infinite deck), the 10 up card columns shared
+//between 'threads' threads (0: all the online cores). 'ev' (optional) gets the player's expected return
+//per unit bet playing it. Returns: FAIL for invalid arguments, otherwise SUCCESS.
+int strategy_generate(Strategy_t* strategy, uint8_t decks, unsigned int threads, double* ev);
+
+//Writes/reads the strategy as a text chart (a row per hand: "hard <value> <10 H/S, up card A 2 ... 10>").
+//Returns: FAIL in case of fail (or an invalid chart), otherwise SUCCESS.
+int strategy_save(const Strategy_t* strategy, const char* path);
+int strategy_load(Strategy_t* strategy, const char* path);
+
+//Returns true- hit, false- stand. 'up_card' in suit_rank encoding.
+bool strategy_hit(const Strategy_t* strategy, uint8_t value, bool soft, uint8_t up_card);
+
+//hit_stand_decision playing the strategy given as 'ctx' (const Strategy_t*)
+char strategy_decide(Player_t* player, Player_t* dealer, void* ctx);
@@ -0,0 +1,138 @@
+#pragma once
+/*
+ * Author: Noga Avraham
+ * Description: Header only typed list: the SLL.h operations over values stored inline, in one contiguous block.
+ *              TYPED_LIST(Type_t, prefix, Value, INLINE) declares the list type Type_t of Value elements and its
+ *              prefix_* functions. The first INLINE values live inside the list struct itself (no allocation, no
+ *              pointer to follow), longer lists move to a heap block that doubles when full.
+ *              A zeroed Type_t is an empty list. Positions range 1-n, as in SLL.h. Callbacks get typed values.
+ *              Removing from the front or the middle moves the values after it (lists are meant to stay short).
+ *              Heap blocks are counted in typed_list_allocs and in the STATS_LIST_ALLOCS counter (see Stats.h).
+ * Language:  C
+*/
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<stddef.h>
+#include<stdbool.h>
+#include "Stats.h"
+
+#ifndef FAIL
+#define FAIL -1     //same results as Black_Jack.h
+#define SUCCESS 0
+#endif
+
+//Heap blocks allocated by all the typed lists on the calling thread (defined in Cards.c, with the card lists)
+extern __thread uint64_t typed_list_allocs;
+
+#define TYPED_LIST(Type_t, prefix, Value, INLINE)                                                               \
+typedef struct prefix##_struct {                                                                                \
+	uint32_t _count;                                                                                            \
+	uint32_t _capacity;   /*heap block size (0: the values are inline)*/                                       \
+	Value* _heap;                                                                                               \
+	Value _inline[INLINE];                                                                                      \
+}Type_t;                                                                                                        \
+                                                                                                                \
+typedef void (*prefix##_visit)(const Value* value, void* ctx);                                                  \
+                                                                                                                \
+/*the values, in positions order*/                                                                             \
+static inline Value* prefix##_data(Type_t* list) {                                                              \
+	return list->_heap ? list->_heap : list->_inline;                                                           \
+}                                                                                                               \
+static inline const Value* prefix##_cdata(const Type_t* list) {                                                 \
+	return list->_heap ? list->_heap : list->_inline;                                                           \
+}                                                                                                               \
+                                                                                                                \
+/*makes room for one more value. Returns: false- out of memory*/                                               \
+static inline bool prefix##_reserve(Type_t* list) {                                                             \
+	uint32_t capacity = list->_heap ? list->_capacity : (INLINE);                                               \
+	if (list->_count < capacity)                                                                                \
+		return true;                                                                                            \
+	Value* block = (Value*)malloc((size_t)capacity * 2 * sizeof(Value));                                        \
+	if (!block) {                                                                                               \
+		fprintf(stderr, "Warning: function[" #prefix "_reserve()]: Failed allocating memory for %u values\n", capacity * 2); \
+		return false;                                                                                           \
+	}                                                                                                           \
+	typed_list_allocs++;                                                                                        \
+	STATS_COUNT(STATS_LIST_ALLOCS, 1);                                                                          \
+	memcpy(block, prefix##_data(list), (size_t)list->_count * sizeof(Value));                                   \
+	free(list->_heap);                                                                                          \
+	list->_heap = block;                                                                                        \
+	list->_capacity = capacity * 2;                                                                             \
+	return true;                                                                                                \
+}                                                                                                               \
+                                                                                                                \
+/*List tail handlers. Returns: FAIL (out of memory / empty list), otherwise SUCCESS*/                          \
+static inline int prefix##_add_to_back(Type_t* list, Value value) {                                             \
+	if (!prefix##_reserve(list))                                                                                \
+		return FAIL;                                                                                            \
+	prefix##_data(list)[list->_count++] = value;                                                                \
+	return SUCCESS;                                                                                             \
+}                                                                                                               \
+static inline int prefix##_remove_from_back(Type_t* list, Value* value) {                                       \
+	if (!list->_count)                                                                                          \
+		return FAIL;                                                                                            \
+	--list->_count;                                                                                             \
+	if (value)                                                                                                  \
+		*value = prefix##_data(list)[list->_count];                                                             \
+	return SUCCESS;                                                                                             \
+}                                                                                                               \
+                                                                                                                \
+/*inserts the value before the given position (count + 1: at the back)*/                                       \
+static inline int prefix##_insert(Type_t* list, Value value, size_t pos) {                                      \
+	if (pos > (size_t)list->_count + 1 || !prefix##_reserve(list))                                              \
+		return FAIL;                                                                                            \
+	Value* data = prefix##_data(list);                                                                          \
+	pos = pos ? pos - 1 : 0;                                                                                    \
+	memmove(data + pos + 1, data + pos, (list->_count - pos) * sizeof(Value));                                  \
+	data[pos] = value;                                                                                          \
+	list->_count++;                                                                                             \
+	return SUCCESS;                                                                                             \
+}                                                                                                               \
+                                                                                                                \
+/*removes the value at the given position ('value' optional)*/                                                 \
+static inline int prefix##_remove_at(Type_t* list, size_t pos, Value* value) {                                  \
+	if (!pos || pos > list->_count)                                                                             \
+		return FAIL;                                                                                            \
+	Value* data = prefix##_data(list);                                                                          \
+	if (value)                                                                                                  \
+		*value = data[pos - 1];                                                                                 \
+	memmove(data + pos - 1, data + pos, (list->_count - pos) * sizeof(Value));                                  \
+	list->_count--;                                                                                             \
+	return SUCCESS;                                                                                             \
+}                                                                                                               \
+                                                                                                                \
+/*List head handlers*/                                                                                         \
+static inline int prefix##_push(Type_t* list, Value value) {                                                    \
+	return prefix##_insert(list, value, 1);                                                                     \
+}                                                                                                               \
+static inline int prefix##_pop(Type_t* list, Value* value) {                                                    \
+	return prefix##_remove_at(list, 1, value);                                                                  \
+}                                                                                                               \
+                                                                                                                \
+/*the value at the given position (NULL out of range)*/                                                        \
+static inline Value* prefix##_find(Type_t* list, size_t pos) {                                                  \
+	return pos && pos <= list->_count ? prefix##_data(list) + pos - 1 : NULL;                                   \
+}                                                                                                               \
+                                                                                                                \
+/*calls 'visit' on the values of positions start_pos - end_pos (for_each: all of them)*/                       \
+static inline void prefix##_for_range(const Type_t* list, size_t start_pos, size_t end_pos, void* ctx, prefix##_visit visit) { \
+	const Value* data = prefix##_cdata(list);                                                                   \
+	end_pos = end_pos < list->_count ? end_pos : list->_count;                                                  \
+	for (size_t pos = start_pos ? start_pos : 1; pos <= end_pos; ++pos) {                                       \
+		visit(data + pos - 1, ctx);                                                                             \
+	}                                                                                                           \
+}                                                                                                               \
+static inline void prefix##_for_each(const Type_t* list, void* ctx, prefix##_visit visit) {                     \
+	prefix##_for_range(list, 1, list->_count, ctx, visit);                                                      \
+}                                                                                                               \
+                                                                                                                \
+/*empties the list in O(1), keeping its block for reuse / frees its block*/                                    \
+static inline void prefix##_reset(Type_t* list) {                                                               \
+	list->_count = 0;                                                                                           \
+}                                                                                                               \
+static inline void prefix##_clear(Type_t* list) {                                                               \
+	free(list->_heap);                                                                                          \
+	memset(list, 0, offsetof(Type_t, _inline));                                                                 \
+}